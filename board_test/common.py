@@ -63,10 +63,9 @@ def board_assert_isinstance(obj, classinfo):
         time.sleep(WAIT_TIME)
     assert isinstance(obj, classinfo)
 
-def spinn_2_to_7(pkt, mode):
-    """Converts DVS Packet data to SpiNN encoding using given mode"""
+def spinn_map(pkt, mode):
+    """Maps DVS Packet data to the 16-bit event sent to SpiNN in given mode"""
 
-    buf = []
     data = 0x8000 + ((pkt.pol & 0x1) << 14)
 
     # Switch which mode is used
@@ -79,6 +78,29 @@ def spinn_2_to_7(pkt, mode):
     elif mode == SpiNNMode.SPINN_MODE_16:
         data += ((pkt.y & 0x78) << 1) + ((pkt.x & 0x78) >> 3)
 
+    return data
+
+def spinn_events(pkt):
+    """Returns list of 16-bit events carried by a SpiNN packet"""
+
+    nibbles = [SYMBOL_TABLE.index(x) for x in pkt.data[:-1]]
+    events = [sum(n << (4*i) for i, n in enumerate(nibbles[2:6]))]
+
+    # Payload carries two more events; empty halves have top bit clear
+    if len(nibbles) > 10:
+        for start in (10, 14):
+            event = sum(n << (4*i) for i, n in enumerate(nibbles[start:start+4]))
+            if event & 0x8000:
+                events += [event]
+
+    return events
+
+def spinn_2_to_7(pkt, mode):
+    """Converts DVS Packet data to SpiNN encoding using given mode"""
+
+    buf = []
+    data = spinn_map(pkt, mode)
+
     # Calculate parity
     xor_all = (CHIP_ADDRESS[0] ^ CHIP_ADDRESS[1] ^ CHIP_ADDRESS[2] ^
                CHIP_ADDRESS[3] ^ ((data & 0xFF00) >> 8) ^ (data & 0xFF))
@@ -102,6 +124,21 @@ def spinn_2_to_7(pkt, mode):
 
     return SpiNNPacket(buf)
 
+def key_2_to_7(key):
+    """Converts a 32-bit key to a short SpiNN packet"""
+
+    nibbles = [(key >> (4*i)) & 0xF for i in range(8)]
+
+    # Odd parity over every bit of the key
+    odd_parity = 1 ^ (bin(key).count("1") & 0x1)
+
+    # Header, key from least significant nibble, EOP
+    buf = [SYMBOL_TABLE[odd_parity], SYMBOL_TABLE[0]]
+    buf += [SYMBOL_TABLE[x] for x in nibbles]
+    buf += [SYMBOL_TABLE[-1]]
+
+    return SpiNNPacket(buf)
+
 def motor_2_to_7(speed):
     """Converts motor packet data to SpiNN encoding"""
 
@@ -8,7 +8,7 @@ import logging
 import serial
 from serial.tools import list_ports
 from dvs_packet import DVSPacket
-from spinn_packet import SPINN_PACKET_SHORT, SpiNNPacket
+from spinn_packet import SPINN_PACKET_SHORT, SPINN_PACKET_LONG, SpiNNPacket
 
 # Constant definitions
 BAUD_RATE = 500000
@@ -27,13 +27,97 @@ COMMANDS = {
     "spinn_fwd_rx": "f_rx",
     "spinn_rst_rx": "r_rx",
     "spinn_use": "u_rx",
+    "bench": "bnch",
+    "spinn_set_packing": "pspn",
+    "spinn_set_drop": "dspn",
+    "spinn_queue": "qspn",
+    "spinn_ack_timeout": "tspn",
+    "spinn_link": "lspn",
+    "route_add": "kspn",
+    "route_clear": "cspn",
+    "route_get": "hspn",
+    "pwm_config": "pwmc",
+    "pwm_state": "pwms",
+    "spinn_hist": "yspn",
+    "spinn_rx_errors": "espn",
+    "spinn_tap": "aspn",
+    "tasks": "task",
+    "wake": "wake",
+    "trace": "trce",
+    "config_save": "cfgs",
+    "config_clear": "cfgc",
+    "telemetry": "tlmy",
+    "dvs_generate": "gdvs",
+    "spinn_loopback": "lpbk",
 }
 RESPONSES = {
     "success": "000 Success",
     "bad_cmd": "001 Not recognised",
     "bad_len": "002 Wrong length",
     "bad_param": "003 Bad parameter",
+    "flash": "004 Flash write failed",
 }
+BENCHMARKS = {
+    "spinn_encode": 0,
+    "spinn_encode_ref": 1,
+    "spinn_decode": 2,
+    "signal_sem": 3,
+    "signal_notify": 4,
+    "flag_sem": 5,
+    "flag_atomic": 6,
+    "pipeline": 7,
+    "trace": 8,
+}
+BENCH_TIMEOUT = 2.0
+BARE_MARKER = b"bare"
+BARE_REPORT_WAIT = 2.5
+DROP_POLICIES = {
+    "oldest": 0,
+    "newest": 1,
+    "reject": 2,
+}
+QUEUE_STATS = ("policy", "capacity", "depth", "high_water", "overwritten",
+               "dropped", "rejected")
+LINK_STATS = ("up", "timeouts", "stalls", "recoveries", "abandoned",
+              "last_recovery_ms", "max_recovery_ms", "down_ms")
+TELEMETRY = ("uptime_ms", "pc_rx_bytes", "pc_rx_dropped", "dvs_rx_bytes",
+             "dvs_rx_dropped", "decoded", "filtered", "queued",
+             "retry_dropped", "tx_overwritten", "tx_dropped", "tx_rejected",
+             "tx_packets", "tx_abandoned", "link_timeouts", "link_stalls",
+             "rx_packets", "rx_errors", "route_misses", "dvs_rx_high_water",
+             "tx_high_water", "link_up")
+GEN_PATTERNS = {
+    "noise": 0,
+    "bar": 1,
+    "hot_block": 2,
+}
+GEN_STATS = ("generated", "lost")
+LOOP_STATS = ("packets", "events", "errors")
+RX_STATS = ("packets", "bad_length", "bad_eop", "bad_symbol", "bad_parity",
+            "overruns")
+TASK_NAMES = ("PC_Rx", "PC_Tx", "DVS_Pipe", "txSpn", "rxSpn",
+              "IDLE", "Tmr Svc")
+CORE_HZ = 48000000
+RUNTIME_HZ = CORE_HZ // 64
+HISTOGRAMS = ("tx_ack", "rx_sym")
+HIST_BUCKETS = 16
+WAKE_SOURCES = ("dvs_rx", "pc_rx", "spinn_tx_ack", "spinn_rx_edge")
+TRACE_IDS = ("isr_enter", "isr_exit", "queue_send", "queue_recv",
+             "event_decoded", "packet_queued", "symbol_acked", "drop")
+TRACE_ALL = (1 << len(TRACE_IDS)) - 1
+TRACE_QUEUES = ("dvs_rx", "spinn_tx")
+TRACE_DROPS = ("dvs_rx", "dvs_retry", "spinn_tx")
+TRACE_IRQS = {7: "EXTI4_15", 27: "USART1", 28: "USART2"}
+TRACE_RECORD_LEN = 8
+HANDLERS = {
+    "pc": 0,
+    "pwm": 1,
+    "gpio": 2,
+    "counter": 3,
+}
+ROUTE_FIELDS = ("key", "mask", "handler", "arg", "last_value", "hits")
+PWM_CHANNELS = 2
+PWM_PERIOD = 2400
 ECHO_ON = True
 
 class Controller(object):
@@ -46,6 +130,7 @@ class Controller(object):
         self.expected = 0
         self.returns = 0
         self.echo_returns = 0
+        self.spinn_pending = []
 
     def get_responding(self):
         """Checks all connected Windows COM ports for responding device"""
@@ -122,6 +207,22 @@ class Controller(object):
                 return buf[:-1]
         return ""
 
+    def _read_frame(self):
+        """Helper method to read length-prefixed binary frame"""
+        if self.ser is None:
+            return b""
+
+        raw_len = self.ser.read(2)
+        if len(raw_len) < 2:
+            return b""
+        length = struct.unpack(">H", raw_len)[0]
+
+        # Read data and the trailing carriage return
+        data = self.ser.read(length + 1)
+        self.log.debug(">>> %s%s", hexlify(raw_len), hexlify(data))
+
+        return data[:length]
+
     def open(self, port):
         """Connects to the given port at default baud rate"""
         # Open specified port
@@ -149,6 +250,38 @@ class Controller(object):
             self.log.info("Response received: " + resp_msg)
         return self._read()
 
+    def get_tasks(self):
+        """Retrieves total run time and unused RTOS RAM budget, and run time
+        and stack high-water mark in words of each task, truncated to 8
+        characters.
+        Run times are in units of 1/RUNTIME_HZ seconds"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["tasks"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) < 9:
+            return None
+        (total, free_ram, count) = struct.unpack(">IIB", frame[:9])
+        if len(frame) != 9 + 14 * count:
+            return None
+
+        tasks = {}
+        for idx in range(9, len(frame), 14):
+            name = frame[idx:idx + 8].rstrip(b"\0").decode("ascii")
+            (run_time, stack) = struct.unpack(">IH", frame[idx + 8:idx + 14])
+            tasks[name] = {"run_time": run_time, "stack": stack}
+        return {"total": total, "free_ram": free_ram, "tasks": tasks}
+
     def echo(self, msg):
         """Requests that the board echoes back the given bytes"""
 
@@ -191,6 +324,35 @@ class Controller(object):
 
         return resp_msg
 
+    def save_config(self):
+        """Saves current settings to be applied whenever the board boots.
+        Events arriving while flash is written are lost"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+        self._write(COMMANDS["config_save"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
+    def clear_config(self):
+        """Erases saved settings, so that the board boots with defaults"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+        self._write(COMMANDS["config_clear"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
     def forward_dvs(self, timeout_ms):
         """Request forwarding for timeout_ms, or 0 for permanently on"""
         if self.ser is None:
@@ -261,6 +423,7 @@ class Controller(object):
         if self.ser is None:
             self.log.error("No serial device connected!")
             return ""
+        self.spinn_pending = []
         tx_msg = COMMANDS["spinn_forward"]
         tx_msg += chr((timeout_ms & 0xFF00) >> 8)
         tx_msg += chr(timeout_ms & 0xFF)
@@ -304,19 +467,446 @@ class Controller(object):
 
         return resp_msg
 
+    def tap_spinn(self, tap):
+        """Turns mirroring of packets sent on the SpiNN link on or off"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+
+        self._write(COMMANDS["spinn_tap"] + chr(tap))
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
+    def get_spinn_batch(self):
+        """Retrieves a batch of forwarded or mirrored SpiNN packets as
+        (tick_ms, dropped, packets), where dropped counts packets lost
+        before this batch"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        frame = self._read_frame()
+        if len(frame) < 7:
+            return None
+        (count, dropped, tick) = struct.unpack(">BHI", frame[:7])
+
+        pkts = []
+        idx = 7
+        while idx < len(frame):
+            length = frame[idx]
+            data = list(frame[idx + 1:idx + 1 + length])
+            if length not in (SPINN_PACKET_SHORT, SPINN_PACKET_LONG) or \
+               len(data) != length:
+                return None
+            pkts.append(SpiNNPacket(data))
+            idx += 1 + length
+
+        if len(pkts) != count:
+            return None
+        return (tick, dropped, pkts)
+
     def get_spinn(self):
-        """Retrieve bytes and package into SpiNNaker packet"""
+        """Retrieve next forwarded SpiNNaker packet"""
         if self.ser is None:
             self.log.error("No serial device connected!")
             return ""
 
-        data = self._read()
-        if len(data) == SPINN_PACKET_SHORT:
-            pkt = [ord(x) for x in data]
-            return SpiNNPacket(pkt)
-        else:
+        if not self.spinn_pending:
+            batch = self.get_spinn_batch()
+            if batch is None:
+                return None
+            self.spinn_pending = batch[2]
+
+        return self.spinn_pending.pop(0)
+
+    def set_packing_spinn(self, events):
+        """Sets the maximum number of events sent in one SpiNNaker packet"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+
+        tx_msg = COMMANDS["spinn_set_packing"]
+        tx_msg += chr(events)
+        self._write(tx_msg)
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
+    def set_drop_spinn(self, policy):
+        """Sets what happens to events sent while the SpiNN queue is full"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+
+        tx_msg = COMMANDS["spinn_set_drop"]
+        tx_msg += chr(policy)
+        self._write(tx_msg)
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
+    def get_queue_spinn(self):
+        """Retrieves SpiNN queue depth, high-water mark and drop counters"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["spinn_queue"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 19:
+            return None
+        return dict(zip(QUEUE_STATS, struct.unpack(">BHHHIII", frame)))
+
+    def set_ack_timeout_spinn(self, timeout_ms):
+        """Sets SpiNN acknowledge timeout in ms, 0 to wait forever"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+
+        tx_msg = COMMANDS["spinn_ack_timeout"]
+        tx_msg += chr((timeout_ms & 0xFF00) >> 8)
+        tx_msg += chr(timeout_ms & 0xFF)
+        self._write(tx_msg)
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
+    def get_link_spinn(self):
+        """Retrieves SpiNN link state, stall counters and recovery times"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["spinn_link"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 29:
+            return None
+        return dict(zip(LINK_STATS, struct.unpack(">BIIIIIII", frame)))
+
+    def get_telemetry(self):
+        """Retrieves every counter on the board in one frame"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["telemetry"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 81:
+            return None
+        return dict(zip(TELEMETRY, struct.unpack(">19IHHB", frame)))
+
+    def generate_dvs(self, pattern, rate):
+        """Starts the board generating rate events/s in place of the eDVS,
+        or stops it with a rate of 0, and returns counts of the run so far"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        tx_msg = COMMANDS["dvs_generate"]
+        tx_msg += chr(pattern)
+        tx_msg += "".join(chr(x) for x in struct.pack(">I", rate))
+        self._write(tx_msg)
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 8:
+            return None
+        return dict(zip(GEN_STATS, struct.unpack(">II", frame)))
+
+    def loopback_spinn(self, loopback):
+        """Loops SpiNN packets back from the encoder to the decoder in place
+        of the link, or returns to the link, and returns counts of packets
+        looped back so far"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
             return None
 
+        self._write(COMMANDS["spinn_loopback"] + chr(1 if loopback else 0))
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 12:
+            return None
+        return dict(zip(LOOP_STATS, struct.unpack(">III", frame)))
+
+    def get_rx_stats_spinn(self, reset=False):
+        """Retrieves counts of received SpiNN packets and of those rejected,
+        optionally clearing them"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["spinn_rx_errors"] + chr(1 if reset else 0))
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 4 * len(RX_STATS):
+            return None
+        return dict(zip(RX_STATS, struct.unpack(">IIIIII", frame)))
+
+    def get_wake(self, reset=False):
+        """Retrieves interrupt to task wake latency histograms, optionally
+        clearing them. Bucket n counts latencies of 2^n to 2^(n+1)-1 core
+        cycles, only for interrupts which woke a higher priority task"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["wake"] + chr(1 if reset else 0))
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        hists = {}
+        for name in WAKE_SOURCES:
+            frame = self._read_frame()
+            if len(frame) != 4 * HIST_BUCKETS:
+                return None
+            hists[name] = list(struct.unpack(">" + "I" * HIST_BUCKETS, frame))
+        return hists
+
+    def start_trace(self, mask=TRACE_ALL):
+        """Empties the trace ring and starts recording the record types whose
+        bits are set in mask, indexed as TRACE_IDS"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["trace"] + chr(0) + chr((mask & 0xFF00) >> 8) +
+                    chr(mask & 0xFF))
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        return resp_msg
+
+    def get_trace(self):
+        """Stops tracing and retrieves the trace as a tuple of records lost
+        to overwriting and a list of records, oldest first. Each record is a
+        dict of cycle count, type name, tag and value"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["trace"] + chr(1) + chr(0) + chr(0))
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 6:
+            return None
+        (count, lost) = struct.unpack(">HI", frame)
+
+        records = []
+        while len(records) < count:
+            frame = self._read_frame()
+            if not frame or len(frame) % TRACE_RECORD_LEN:
+                return None
+            for idx in range(0, len(frame), TRACE_RECORD_LEN):
+                (cycles, rec_id, tag, value) = struct.unpack(
+                    ">IBBH", frame[idx:idx + TRACE_RECORD_LEN])
+                if rec_id >= len(TRACE_IDS):
+                    return None
+                records.append({"cycles": cycles, "id": TRACE_IDS[rec_id],
+                                "tag": tag, "value": value})
+        return (lost, records)
+
+    def get_hist_spinn(self, reset=False):
+        """Retrieves SpiNN link latency histograms, optionally clearing them.
+        Bucket n counts latencies of 2^n to 2^(n+1)-1 core cycles"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["spinn_hist"] + chr(1 if reset else 0))
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        hists = {}
+        for name in HISTOGRAMS:
+            frame = self._read_frame()
+            if len(frame) != 4 * HIST_BUCKETS:
+                return None
+            hists[name] = list(struct.unpack(">" + "I" * HIST_BUCKETS, frame))
+        return hists
+
+    def add_route_spinn(self, key, mask, handler, arg=0):
+        """Adds a route for received SpiNN packets matching key and mask"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+
+        tx_msg = COMMANDS["route_add"]
+        tx_msg += "".join(chr(x) for x in struct.pack(">IIBB", key, mask,
+                                                       handler, arg))
+        self._write(tx_msg)
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
+    def clear_routes_spinn(self):
+        """Removes all routes for received SpiNN packets"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+        self._write(COMMANDS["route_clear"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
+    def get_routes_spinn(self):
+        """Retrieves count of unrouted packets and list of routes"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["route_get"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 5:
+            return None
+        (misses, count) = struct.unpack(">IB", frame)
+
+        routes = []
+        for _ in range(count):
+            frame = self._read_frame()
+            if len(frame) != 16:
+                return None
+            routes += [dict(zip(ROUTE_FIELDS, 
+                                struct.unpack(">IIBBHI", frame)))]
+
+        return (misses, routes)
+
+    def configure_pwm(self, channel, gain=PWM_PERIOD, offset=0, minimum=0,
+                      maximum=PWM_PERIOD, slew=0):
+        """Sets scaling, limits and slew rate of a PWM channel"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return ""
+
+        tx_msg = COMMANDS["pwm_config"]
+        tx_msg += "".join(chr(x) for x in struct.pack(">BHhHHH", channel, gain,
+                                                       offset, minimum,
+                                                       maximum, slew))
+        self._write(tx_msg)
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+
+        return resp_msg
+
+    def get_pwm(self):
+        """Retrieves (target, compare) of each PWM channel"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        self._write(COMMANDS["pwm_state"])
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        frame = self._read_frame()
+        if len(frame) != 4 * PWM_CHANNELS:
+            return None
+        values = struct.unpack(">" + "H" * 2 * PWM_CHANNELS, frame)
+        return list(zip(values[0::2], values[1::2]))
+
     def set_spinn_rx_fwd(self, timeout_ms):
         """Requests that unpacked data from SpiNN is forwarded to PC"""
         if self.ser is None:
@@ -380,6 +970,55 @@ class Controller(object):
 
         return duration
 
+    def bench(self, bench_id, iterations):
+        """Runs benchmark on board and returns total cycles taken"""
+        if self.ser is None:
+            self.log.error("No serial device connected!")
+            return None
+
+        tx_msg = COMMANDS["bench"]
+        tx_msg += chr(bench_id)
+        tx_msg += chr((iterations & 0xFF00) >> 8)
+        tx_msg += chr(iterations & 0xFF)
+        self._write(tx_msg)
+
+        # Log error code
+        resp_msg = self._read()
+        if resp_msg in RESPONSES.values():
+            self.log.info("Response received: " + resp_msg)
+        if resp_msg != RESPONSES["success"]:
+            return None
+
+        # Longer benchmarks take more than the usual timeout to report
+        self.ser.timeout = BENCH_TIMEOUT
+        frame = self._read_frame()
+        self.ser.timeout = 0.1
+        if len(frame) != 4:
+            return None
+        return struct.unpack(">I", frame)[0]
+
+    def get_bare_bench(self):
+        """Finds a board running the bare-metal build, which does not take
+        commands, and returns the result of the pipeline benchmark it runs
+        at boot as a tuple of event count and cycles taken"""
+        for port in list_ports.comports()[1:]:
+            try:
+                self.open(port.device)
+            except serial.SerialException as ser_exc:
+                self.log.info("Failed to open device: %s", ser_exc)
+                continue
+
+            # The result is sent periodically, so wait for the next one
+            self.ser.timeout = BARE_REPORT_WAIT
+            frame = self._read_frame()
+            self.ser.close()
+            self.ser = None
+
+            if len(frame) == 10 and frame[:4] == BARE_MARKER:
+                self.log.debug("Bare-metal board found on port " + port.device)
+                return struct.unpack(">HI", frame[4:])
+        return None
+
     def __enter__(self):
         return self
 
@@ -13,5 +13,14 @@ py.test -vv --html=reports/test_results_mbed_single_tx.html -D mbed -k single_tx
 echo Press STM reset button
 pause
 py.test -vv --html=reports/test_results_mbed_many_tx.html -D mbed -k many_tx
+echo Flashing bare-metal build; keep MBED attached
+pushd ..\edvs_receiver
+call build_flash.bat BareMetal
+popd
+py.test -vv --html=reports/test_results_bare.html -D bare -k bare_pipeline
+echo Restoring FreeRTOS build
+pushd ..\edvs_receiver
+call build_flash.bat
+popd
 echo Test run finished
 pause
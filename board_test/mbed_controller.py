@@ -6,10 +6,11 @@ import struct
 import logging
 import serial
 from serial.tools import list_ports
-from spinn_packet import SpiNNPacket, SPINN_PACKET_SHORT
+from spinn_packet import SpiNNPacket
 
 # Constant definitions
 BAUD_RATE = 500000
+SPINN_EOP = 0x60
 MBED_ID = "MBED"
 COMMANDS = {
     "get_id": "id__",
@@ -124,16 +125,19 @@ class MBEDController(object):
         raw_count = bytes([ord(raw[0])])
         count = struct.unpack(">B", raw_count)[0]
         raw = raw[1:]
-        self.log.info("%d packets received", count/11)
+        self.log.info("%d symbols received", count)
 
-        # Package bytes into SpiNNPackets
+        # Package bytes into SpiNNPackets, which may be short or long, by
+        # splitting after each EOP
         packets = []
-        while len(raw) >= SPINN_PACKET_SHORT:
-            raw_pkt = [ord(x) for x in raw[:SPINN_PACKET_SHORT]]
-            packets += [SpiNNPacket(raw_pkt)]
-            raw = raw[SPINN_PACKET_SHORT:]
-
-        return (duration, count/SPINN_PACKET_SHORT, packets)
+        raw_pkt = []
+        for sym in [ord(x) for x in raw]:
+            raw_pkt += [sym]
+            if sym == SPINN_EOP:
+                packets += [SpiNNPacket(raw_pkt)]
+                raw_pkt = []
+
+        return (duration, len(packets), packets)
 
     def wait(self):
         """Tells MBED to wait for trigger"""
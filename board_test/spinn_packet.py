@@ -1,6 +1,7 @@
 """Module to contain SpiNNaker packet wrapper"""
 
 SPINN_PACKET_SHORT = 11
+SPINN_PACKET_LONG = 19
 
 class SpiNNPacket(object):
     """SpiNNaker packet wrapper"""
@@ -5,8 +5,9 @@ import time
 import pytest
 from fixtures import mbed, board, log
 from common import (board_assert_equal, spinn_2_to_7, SpiNNMode, 
-                    board_assert_isinstance, motor_2_to_7)
-from controller import RESPONSES
+                    board_assert_isinstance, motor_2_to_7, spinn_map,
+                    spinn_events, SYMBOL_TABLE)
+from controller import RESPONSES, BENCHMARKS, CORE_HZ, Controller
 from dvs_packet import DVSPacket
 from spinn_packet import SpiNNPacket
 
@@ -50,6 +51,12 @@ def test_many_packets(mbed, board, log, packets):
     mbed.get_spinn()
     mbed.wait()
 
+    # The MBED holds the link while waiting, so do not let it stall
+    board_assert_equal(board.set_ack_timeout_spinn(0), RESPONSES["success"])
+
+    # One event per packet so that every packet is short
+    board_assert_equal(board.set_packing_spinn(1), RESPONSES["success"])
+
     # Work out x limits for 20 packets
     x_min = 12
     x_step = 6
@@ -91,6 +98,283 @@ def test_many_packets(mbed, board, log, packets):
              % (len(exp_data), duration/1000000.0, duration/(1000000.0*packets)))
 
 
+@pytest.mark.dev("mbed")
+@pytest.mark.parametrize("events", [2, 3, 10, 20])
+def test_many_packets_payload(mbed, board, log, events):
+    """Tests that events queued behind the link share payload packets"""
+
+    # Clear the MBED and tell it to wait
+    mbed.get_spinn()
+    mbed.wait()
+
+    board_assert_equal(board.set_ack_timeout_spinn(0), RESPONSES["success"])
+    board_assert_equal(board.set_packing_spinn(3), RESPONSES["success"])
+    board_assert_equal(board.set_mode_spinn(SpiNNMode.SPINN_MODE_128.value),
+                       RESPONSES["success"])
+
+    dvs_data = [DVSPacket(12 + 4*i, 90 - 3*i, i%2) for i in range(events)]
+    exp_events = [spinn_map(x, SpiNNMode.SPINN_MODE_128) for x in dvs_data]
+
+    for dvs_pkt in dvs_data:
+        board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+
+    # Trigger the MBED to start the speed test
+    mbed.trigger()
+    time.sleep(events * 0.05)
+
+    (duration, count, rx_data) = mbed.get_spinn()
+
+    # Every event arrives once and in order, in fewer packets than events
+    rx_events = [ev for pkt in rx_data for ev in spinn_events(pkt)]
+    assert rx_events == exp_events
+    assert count < events
+
+    log.info("Test for %d events took %lfs in %d packets with %lfs per event"
+             % (events, duration/1000000.0, count,
+                duration/(1000000.0*events)))
+
+
+@pytest.mark.dev("mbed")
+def test_link_stall_recovery(mbed, board, log):
+    """Tests that a link held past the acknowledge timeout stalls, and then
+    recovers once the MBED acknowledges again"""
+
+    # Clear the MBED and tell it to hold the link
+    mbed.get_spinn()
+    mbed.wait()
+
+    board_assert_equal(board.set_ack_timeout_spinn(5), RESPONSES["success"])
+    board_assert_equal(board.set_mode_spinn(SpiNNMode.SPINN_MODE_128.value),
+                       RESPONSES["success"])
+    board_assert_equal(board.use_dvs(DVSPacket(10, 30, 1)),
+                       RESPONSES["success"])
+    time.sleep(0.1)
+
+    stats = board.get_link_spinn()
+    board_assert_equal(stats["up"], 0)
+    board_assert_equal(stats["stalls"], 1)
+
+    # Release the link, then send another packet to restart it
+    mbed.trigger()
+    mbed.get_spinn()
+    dvs_pkt = DVSPacket(20, 40, 0)
+    board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+    time.sleep(0.3)
+
+    stats = board.get_link_spinn()
+    log.info("Link state: {}".format(stats))
+    board_assert_equal(stats["up"], 1)
+    board_assert_equal(stats["recoveries"], 1)
+    board_assert_equal(stats["down_ms"], 0)
+    assert stats["last_recovery_ms"] > 0
+
+    # Packets after recovery arrive intact
+    dvs_pkt = DVSPacket(30, 50, 1)
+    board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+    time.sleep(0.1)
+    (_, _, rx_data) = mbed.get_spinn()
+    assert rx_data
+    board_assert_equal(rx_data[-1].data,
+                       spinn_2_to_7(dvs_pkt, SpiNNMode.SPINN_MODE_128).data)
+
+
+@pytest.mark.dev("mbed")
+@pytest.mark.parametrize("rounds", [1, 5])
+def test_link_tx_rx_stress(mbed, board, log, rounds):
+    """Tests that full-rate transmit and receive at the same time lose no
+    acknowledges, which would stall one direction and lose its packets"""
+
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board_assert_equal(board.set_mode_spinn(SpiNNMode.SPINN_MODE_128.value),
+                       RESPONSES["success"])
+    board_assert_equal(board.set_packing_spinn(1), RESPONSES["success"])
+    # The MBED holds the link while events are queued
+    board_assert_equal(board.set_ack_timeout_spinn(0), RESPONSES["success"])
+
+    packets = 20
+    for rnd in range(rounds):
+        mbed.get_spinn()
+        mbed.wait()
+
+        # Queue packets in both directions
+        speeds = [(rnd * packets + i) % 200 for i in range(packets)]
+        for speed in speeds:
+            mbed.send_spinn_tx_pkt(motor_2_to_7(speed))
+        dvs_data = [DVSPacket(4*i, 10 + rnd, i%2) for i in range(packets)]
+        for dvs_pkt in dvs_data:
+            board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+
+        # Release the board transmitting, then start the MBED transmitting
+        mbed.trigger()
+        duration = mbed.send_trigger_tx()
+        assert duration > 0
+        time.sleep(packets * 0.01)
+
+        # Everything sent by the MBED reached the board
+        for speed in speeds:
+            board_assert_equal(board.get_received_data(), speed)
+
+        # Everything sent by the board reached the MBED
+        (_, count, rx_data) = mbed.get_spinn()
+        board_assert_equal(count, packets)
+        for dvs_pkt, rxp in zip(dvs_data, rx_data):
+            board_assert_equal(rxp.data, 
+                spinn_2_to_7(dvs_pkt, SpiNNMode.SPINN_MODE_128).data)
+
+    log.info("%d rounds of %d packets each way with no lost acknowledges"
+             % (rounds, packets))
+
+
+@pytest.mark.dev("mbed")
+@pytest.mark.parametrize("packets", [1, 10])
+def test_link_tap(mbed, board, log, packets):
+    """Tests that packets sent on the link are mirrored to the PC in batches
+    while still reaching the MBED"""
+
+    mbed.get_spinn()
+    mbed.wait()
+
+    board_assert_equal(board.set_ack_timeout_spinn(0), RESPONSES["success"])
+    board_assert_equal(board.set_packing_spinn(1), RESPONSES["success"])
+    board_assert_equal(board.set_mode_spinn(SpiNNMode.SPINN_MODE_128.value),
+                       RESPONSES["success"])
+    board_assert_equal(board.tap_spinn(1), RESPONSES["success"])
+
+    dvs_data = [DVSPacket(4*i, 20, i%2) for i in range(packets)]
+    exp_data = [spinn_2_to_7(x, SpiNNMode.SPINN_MODE_128).data
+                for x in dvs_data]
+    for dvs_pkt in dvs_data:
+        board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+
+    mbed.trigger()
+    time.sleep(packets * 0.05)
+
+    # Mirrored packets are batched, in order, with none dropped
+    tapped = []
+    last_tick = 0
+    while len(tapped) < packets:
+        batch = board.get_spinn_batch()
+        assert batch
+        (tick, dropped, pkts) = batch
+        board_assert_equal(dropped, 0)
+        assert tick >= last_tick
+        last_tick = tick
+        tapped += [pkt.data for pkt in pkts]
+    board_assert_equal(tapped, exp_data)
+    board_assert_equal(board.tap_spinn(0), RESPONSES["success"])
+
+    (_, count, rx_data) = mbed.get_spinn()
+    board_assert_equal(count, packets)
+    board_assert_equal([pkt.data for pkt in rx_data], exp_data)
+
+
+@pytest.mark.dev("mbed")
+def test_link_latency_hist(mbed, board, log):
+    """Tests that every symbol sent and received is timed once"""
+
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board_assert_equal(board.set_mode_spinn(SpiNNMode.SPINN_MODE_128.value),
+                       RESPONSES["success"])
+    board_assert_equal(board.set_packing_spinn(1), RESPONSES["success"])
+    board.get_hist_spinn(reset=True)
+    mbed.get_spinn()
+
+    # One short packet each way
+    dvs_pkt = DVSPacket(10, 30, 1)
+    board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+    time.sleep(0.1)
+    mbed.send_spinn_tx_pkt(motor_2_to_7(100))
+    assert mbed.send_trigger_tx() > 0
+    time.sleep(0.1)
+    board_assert_equal(board.get_received_data(), 100)
+
+    hists = board.get_hist_spinn()
+    log.info("Latency histograms: {}".format(hists))
+
+    # Every symbol transmitted has its acknowledge timed
+    tx_syms = len(spinn_2_to_7(dvs_pkt, SpiNNMode.SPINN_MODE_128).data)
+    board_assert_equal(sum(hists["tx_ack"]), tx_syms)
+
+    # Every received symbol except the first of the packet follows an ack
+    rx_syms = len(motor_2_to_7(100).data)
+    board_assert_equal(sum(hists["rx_sym"]), rx_syms - 1)
+
+
+PIPELINE_EVENTS = 2000
+PIPELINE_CACHE_KEY = "edvs/pipeline_events_per_s"
+
+@pytest.mark.dev("mbed")
+def test_pipeline_bench(mbed, board, log, cache):
+    """Measures the maximum sustained event rate through the FreeRTOS build,
+    from DVS input to SpiNNaker, for comparison with the bare-metal build"""
+
+    mbed.trigger()
+    mbed.get_spinn()
+    board_assert_equal(board.set_mode_spinn(SpiNNMode.SPINN_MODE_128.value),
+                       RESPONSES["success"])
+
+    cycles = board.bench(BENCHMARKS["pipeline"], PIPELINE_EVENTS)
+    mbed.get_spinn()
+    assert cycles
+
+    rate = PIPELINE_EVENTS * CORE_HZ // cycles
+    log.info("FreeRTOS pipeline took %d cycles per event, %d events/s",
+             cycles // PIPELINE_EVENTS, rate)
+    cache.set(PIPELINE_CACHE_KEY, rate)
+
+    # Every event was queued and has been taken for sending
+    queue = board.get_queue_spinn()
+    board_assert_equal(queue["depth"], 0)
+
+# Board must be flashed with the BareMetal configuration and reset once the
+# MBED is ready, as it only runs the benchmark at boot
+@pytest.mark.dev("bare")
+def test_bare_pipeline_bench(mbed, log, cache):
+    """Compares the maximum sustained event rate of the bare-metal build with
+    that last measured for the FreeRTOS build"""
+
+    with Controller() as con:
+        result = con.get_bare_bench()
+    assert result
+    (events, cycles) = result
+    assert cycles
+
+    rate = events * CORE_HZ // cycles
+    rtos_rate = cache.get(PIPELINE_CACHE_KEY, None)
+    log.info("Bare-metal pipeline took %d cycles per event, %d events/s",
+             cycles // events, rate)
+    if rtos_rate is None:
+        pytest.skip("no FreeRTOS result to compare; run test_pipeline_bench")
+    log.info("FreeRTOS build managed %d events/s, bare-metal is %.2fx",
+             rtos_rate, rate / rtos_rate)
+
+
+@pytest.mark.dev("mbed")
+def test_link_rx_overrun_resync(mbed, board, log):
+    """Tests that packets with lost EOPs are discarded up to the next EOP and
+    that the packet after it is received intact"""
+
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board.get_rx_stats_spinn(reset=True)
+
+    # Two packets with EOP replaced fill the receive buffer, the next packet
+    # only resynchronises the link and the last is received
+    for speed in (10, 20):
+        pkt = motor_2_to_7(speed)
+        pkt.data[-1] = SYMBOL_TABLE[0]
+        mbed.send_spinn_tx_pkt(pkt)
+    mbed.send_spinn_tx_pkt(motor_2_to_7(30))
+    mbed.send_spinn_tx_pkt(motor_2_to_7(40))
+    assert mbed.send_trigger_tx() > 0
+
+    board_assert_equal(board.get_received_data(), 40)
+
+    stats = board.get_rx_stats_spinn()
+    log.info("Receive counts: {}".format(stats))
+    board_assert_equal(stats["overruns"], 1)
+    board_assert_equal(stats["packets"], 1)
+
+
 @pytest.mark.dev("mbed")
 def test_sim_single_tx(mbed, board, log):
     """Tests that a single packet is received by the STM"""
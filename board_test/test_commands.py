@@ -1,8 +1,11 @@
 """File used to test if simple PC->Board commands are working"""
 
+import time
 import pytest
 from serial.tools import list_ports
-from controller import BOARD_ID, RESPONSES
+from controller import (BOARD_ID, RESPONSES, TASK_NAMES, RUNTIME_HZ,
+                        WAKE_SOURCES, HIST_BUCKETS, DROP_POLICIES, HANDLERS,
+                        TELEMETRY, GEN_PATTERNS)
 from fixtures import board
 from common import board_assert, board_assert_equal
 
@@ -44,3 +47,121 @@ def test_reset(board):
     reset_result = board.reset()
     # If any result is retrieved, reset has failed
     board_assert(reset_result not in RESPONSES.values())
+
+def test_config_persists(board, log):
+    """Tests that saved settings are applied again after a reset, and that
+    the board boots with defaults once they are cleared"""
+    route = (0x12340000, 0xFFFF0000, HANDLERS["counter"])
+    try:
+        board_assert_equal(board.set_drop_spinn(DROP_POLICIES["reject"]),
+                           RESPONSES["success"])
+        board_assert_equal(board.clear_routes_spinn(), RESPONSES["success"])
+        board_assert_equal(board.add_route_spinn(*route),
+                           RESPONSES["success"])
+        board_assert_equal(board.save_config(), RESPONSES["success"])
+
+        board.reset()
+        # Allow board time to reset
+        time.sleep(0.1)
+        board_assert_equal(board.get_queue_spinn()["policy"],
+                           DROP_POLICIES["reject"])
+        (_, routes) = board.get_routes_spinn()
+        log.info("Routes after reset: {}".format(routes))
+        board_assert_equal([(x["key"], x["mask"], x["handler"])
+                            for x in routes], [route])
+    finally:
+        board.clear_config()
+
+    board.reset()
+    time.sleep(0.1)
+    board_assert_equal(board.get_queue_spinn()["policy"],
+                       DROP_POLICIES["oldest"])
+
+def test_tasks(board, log):
+    """Tests that every task reports its CPU time and stack use"""
+    stats = board.get_tasks()
+    log.info("Task stats: {}".format(stats))
+
+    board_assert_equal(sorted(stats["tasks"].keys()), sorted(TASK_NAMES))
+    for task in stats["tasks"].values():
+        board_assert(task["stack"] > 0)
+    board_assert(sum(x["run_time"] for x in stats["tasks"].values()) <=
+                 stats["total"])
+    board_assert(stats["free_ram"] > 0)
+
+def test_telemetry(board, log):
+    """Tests that the telemetry frame counts commands received and time"""
+    before = board.get_telemetry()
+    board_assert_equal(board.get_id(), BOARD_ID)
+    after = board.get_telemetry()
+    log.info("Telemetry: {}".format(after))
+
+    board_assert_equal(sorted(after.keys()), sorted(TELEMETRY))
+    # id__ and tlmy, each with its \r
+    board_assert(after["pc_rx_bytes"] - before["pc_rx_bytes"] >= 10)
+    board_assert_equal(after["pc_rx_dropped"], 0)
+    board_assert(after["uptime_ms"] >= before["uptime_ms"])
+
+@pytest.mark.parametrize("pattern", GEN_PATTERNS.keys())
+def test_generator(board, log, pattern):
+    """Tests that generated events are all decoded at a rate the pipeline
+    sustains, with nothing connected"""
+    before = board.get_telemetry()
+    assert board.generate_dvs(GEN_PATTERNS[pattern], 2000) is not None
+    time.sleep(0.5)
+    stats = board.generate_dvs(GEN_PATTERNS[pattern], 0)
+    after = board.get_telemetry()
+    log.info("Generated {}: {}".format(pattern, stats))
+
+    # 1000 events due in half a second, give or take the command latency
+    board_assert(800 <= stats["generated"] <= 1200)
+    board_assert_equal(stats["lost"], 0)
+    board_assert(after["decoded"] - before["decoded"] >= stats["generated"])
+
+def test_spinn_loopback(board, log):
+    """Tests that generated events round-trip through the SpiNN encoder and
+    decoder intact, with nothing connected"""
+    before = board.get_telemetry()
+    assert board.loopback_spinn(True) is not None
+    assert board.generate_dvs(GEN_PATTERNS["noise"], 2000) is not None
+    time.sleep(0.5)
+    gen = board.generate_dvs(GEN_PATTERNS["noise"], 0)
+    time.sleep(0.1)
+    stats = board.loopback_spinn(False)
+    after = board.get_telemetry()
+    log.info("Generated {}, looped back {}".format(gen, stats))
+
+    board_assert_equal(stats["errors"], 0)
+    board_assert(stats["events"] > 0)
+    board_assert(stats["events"] <= gen["generated"])
+    board_assert_equal(after["rx_packets"] - before["rx_packets"],
+                       stats["packets"])
+    board_assert_equal(after["link_timeouts"], before["link_timeouts"])
+
+def test_wake_latency(board, log):
+    """Tests that received bytes wake PC_Rx within microseconds, not at the
+    next tick"""
+    board.get_wake(reset=True)
+    for _ in range(10):
+        board_assert_equal(board.get_id(), BOARD_ID)
+    hists = board.get_wake()
+    log.info("Wake latency histograms: {}".format(hists))
+
+    board_assert_equal(sorted(hists.keys()), sorted(WAKE_SOURCES))
+    board_assert_equal(len(hists["pc_rx"]), HIST_BUCKETS)
+    # 2^11 cycles is under 43us at 48 MHz, against 1ms for a tick
+    board_assert(sum(hists["pc_rx"][:11]) > 0)
+    board_assert_equal(sum(hists["pc_rx"][11:]), 0)
+
+def test_tasks_idle(board):
+    """Tests that run time tracks real time and a quiet board is idle"""
+    before = board.get_tasks()
+    time.sleep(1)
+    after = board.get_tasks()
+
+    elapsed = after["total"] - before["total"]
+    board_assert(0.9 * RUNTIME_HZ < elapsed < 1.5 * RUNTIME_HZ)
+
+    idle = (after["tasks"]["IDLE"]["run_time"] -
+            before["tasks"]["IDLE"]["run_time"])
+    board_assert(idle > elapsed // 2)
@@ -1,13 +1,17 @@
 """Module to test SpiNNaker code with no DVS connected"""
 
+import time
 import pytest
-from common import (board_assert_equal, board_assert_ge,
+from common import (board_assert, board_assert_equal, board_assert_ge,
                     board_assert_isinstance, SpiNNMode, spinn_2_to_7,
-                    motor_2_to_7)
+                    motor_2_to_7, key_2_to_7, SYMBOL_TABLE)
 from fixtures import board
-from controller import RESPONSES
+from controller import (RESPONSES, BENCHMARKS, DROP_POLICIES, HANDLERS,
+                        PWM_PERIOD, HISTOGRAMS, HIST_BUCKETS, RX_STATS,
+                        TRACE_IDS, TRACE_ALL, COMMANDS)
 from dvs_packet import DVSPacket
 from spinn_packet import SpiNNPacket
+from trace_export import to_chrome
 from test_dvs_downscale import (JUST_ENOUGH_64, JUST_ENOUGH_32, JUST_ENOUGH_16,
                                 dvs_offset)
 
@@ -40,6 +44,31 @@ def test_spinn_fwd_received(board):
     pkt = board.get_spinn()
     board_assert_isinstance(pkt, SpiNNPacket)
 
+def test_spinn_fwd_batch(board):
+    """Tests that forwarded packets arrive as a framed batch"""
+    board_assert_equal(board.forward_spinn(0), RESPONSES["success"])
+    board_assert_equal(board.set_mode_spinn(SpiNNMode.SPINN_MODE_128.value),
+                       RESPONSES["success"])
+    dvs_pkt = DVSPacket(10, 30, 1)
+    board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+
+    (tick, dropped, pkts) = board.get_spinn_batch()
+    board_assert(tick > 0)
+    board_assert_equal(dropped, 0)
+    board_assert_equal(len(pkts), 1)
+    board_assert_equal(pkts[0].data,
+                       spinn_2_to_7(dvs_pkt, SpiNNMode.SPINN_MODE_128).data)
+
+@pytest.mark.parametrize("tap", [0, 1])
+def test_spinn_tap_correct(board, tap):
+    """Tests that mirroring can be turned on and off"""
+    board_assert_equal(board.tap_spinn(tap), RESPONSES["success"])
+
+@pytest.mark.parametrize("tap", [2, 255])
+def test_spinn_tap_incorrect(board, tap):
+    """Tests that an invalid mirroring request is rejected"""
+    board_assert_equal(board.tap_spinn(tap), RESPONSES["bad_param"])
+
 @pytest.mark.parametrize("mode", range(4))
 def test_spinn_set_mode_correct(board, mode):
     board_assert_equal(board.set_mode_spinn(mode), RESPONSES["success"])
@@ -121,6 +150,202 @@ def test_spinn_encode_downres(board, pkt_list, exp, mode, log):
     board_assert_equal(pkt.data, result.data)
 
 
+@pytest.mark.parametrize("events", [1, 2, 3])
+def test_spinn_set_packing_correct(board, events):
+    """Tests that valid numbers of events per packet are accepted"""
+    board_assert_equal(board.set_packing_spinn(events), RESPONSES["success"])
+
+@pytest.mark.parametrize("events", [0, 4, 255])
+def test_spinn_set_packing_incorrect(board, events):
+    """Tests that invalid numbers of events per packet are rejected"""
+    board_assert_equal(board.set_packing_spinn(events), RESPONSES["bad_param"])
+
+@pytest.mark.parametrize("policy", DROP_POLICIES.values())
+def test_spinn_set_drop_correct(board, policy):
+    """Tests that each drop policy is accepted and reported back"""
+    board_assert_equal(board.set_drop_spinn(policy), RESPONSES["success"])
+    stats = board.get_queue_spinn()
+    board_assert_equal(stats["policy"], policy)
+
+@pytest.mark.parametrize("policy", [len(DROP_POLICIES), 255])
+def test_spinn_set_drop_incorrect(board, policy):
+    """Tests that an unknown drop policy is rejected"""
+    board_assert_equal(board.set_drop_spinn(policy), RESPONSES["bad_param"])
+
+def test_spinn_queue_empty(board):
+    """Tests that the queue is empty and has dropped nothing after reset"""
+    stats = board.get_queue_spinn()
+    board_assert_equal(stats["depth"], 0)
+    board_assert_equal(stats["high_water"], 0)
+    board_assert_equal(stats["overwritten"] + stats["dropped"] + 
+                       stats["rejected"], 0)
+
+@pytest.mark.parametrize("policy,counter", [
+    ("oldest", None),       # Only counted once the link drains the queue
+    ("newest", "dropped"),
+    ("reject", "rejected"),
+    ])
+def test_spinn_queue_full(board, policy, counter, log):
+    """Tests queue fills and counts drops with no SpiNNaker acknowledging"""
+
+    # One event per packet, and never give up on the link, so that all but
+    # one event stay queued
+    board_assert_equal(board.set_ack_timeout_spinn(0), RESPONSES["success"])
+    board_assert_equal(board.set_packing_spinn(1), RESPONSES["success"])
+    board_assert_equal(board.set_drop_spinn(DROP_POLICIES[policy]),
+                       RESPONSES["success"])
+    capacity = board.get_queue_spinn()["capacity"]
+
+    # Distinct events, so that none are filtered as repeats
+    extra = 10
+    for i in range(capacity + 1 + extra):
+        dvs_pkt = DVSPacket(i % 128, i // 128, 1)
+        board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+
+    stats = board.get_queue_spinn()
+    log.info("Queue state: {}".format(stats))
+    board_assert_equal(stats["depth"], capacity)
+    board_assert_equal(stats["high_water"], capacity)
+    if counter is not None:
+        board_assert_ge(stats[counter], extra)
+
+    # The board must still respond with the link stalled
+    board_assert_equal(board.echo("test"), "test")
+
+def test_spinn_link_up(board):
+    """Tests that the link starts up with no stalls recorded"""
+    stats = board.get_link_spinn()
+    board_assert_equal(stats["up"], 1)
+    board_assert_equal(stats["stalls"], 0)
+    board_assert_equal(stats["timeouts"], 0)
+
+@pytest.mark.parametrize("timeout_ms", [0, 1, 10, 65535])
+def test_spinn_set_ack_timeout(board, timeout_ms):
+    """Tests that any acknowledge timeout is accepted"""
+    board_assert_equal(board.set_ack_timeout_spinn(timeout_ms),
+                       RESPONSES["success"])
+
+def test_spinn_link_stall(board, log):
+    """Tests that with no SpiNNaker acknowledging, the link stalls"""
+    board_assert_equal(board.set_ack_timeout_spinn(5), RESPONSES["success"])
+    board_assert_equal(board.use_dvs(DVSPacket(10, 30, 1)),
+                       RESPONSES["success"])
+    time.sleep(0.1)
+
+    stats = board.get_link_spinn()
+    log.info("Link state: {}".format(stats))
+    board_assert_equal(stats["up"], 0)
+    board_assert_equal(stats["stalls"], 1)
+    board_assert_equal(stats["recoveries"], 0)
+    board_assert_equal(stats["abandoned"], 1)
+    board_assert_ge(stats["down_ms"], 50)
+
+def test_spinn_link_no_timeout(board):
+    """Tests that the link never stalls with the timeout disabled"""
+    board_assert_equal(board.set_ack_timeout_spinn(0), RESPONSES["success"])
+    board_assert_equal(board.use_dvs(DVSPacket(10, 30, 1)),
+                       RESPONSES["success"])
+    time.sleep(0.1)
+
+    stats = board.get_link_spinn()
+    board_assert_equal(stats["up"], 1)
+    board_assert_equal(stats["stalls"], 0)
+
+def test_spinn_hist_reset(board):
+    """Tests that link latency histograms are cleared on request"""
+    hists = board.get_hist_spinn(reset=True)
+    board_assert_equal(sorted(hists.keys()), sorted(HISTOGRAMS))
+
+    # With nothing attached no acknowledge or symbol edges arrive
+    hists = board.get_hist_spinn()
+    for name in HISTOGRAMS:
+        board_assert_equal(hists[name], [0] * HIST_BUCKETS)
+
+def test_spinn_encode_bench(board, log):
+    """Tests that table-driven encoder is faster than the reference encoder"""
+    iterations = 1000
+    cycles = board.bench(BENCHMARKS["spinn_encode"], iterations)
+    ref_cycles = board.bench(BENCHMARKS["spinn_encode_ref"], iterations)
+
+    log.info("Encoder took %d cycles per packet, reference took %d",
+             cycles // iterations, ref_cycles // iterations)
+    board_assert(cycles > 0)
+    board_assert(cycles < ref_cycles)
+
+@pytest.mark.parametrize("old, new", [("signal_sem", "signal_notify"),
+                                      ("flag_sem", "flag_atomic")])
+def test_handoff_bench(board, log, old, new):
+    """Tests that task notifications and lock-free flags are cheaper than
+    the semaphores they replaced"""
+    iterations = 1000
+    old_cycles = board.bench(BENCHMARKS[old], iterations)
+    new_cycles = board.bench(BENCHMARKS[new], iterations)
+
+    log.info("%s took %d cycles per iteration, %s took %d",
+             new, new_cycles // iterations, old, old_cycles // iterations)
+    board_assert(new_cycles > 0)
+    board_assert(new_cycles < old_cycles)
+
+def test_trace_pipeline(board, log):
+    """Tests that a simulated event is traced through the pipeline in order
+    and converts to a Chrome trace"""
+    board_assert_equal(board.set_mode_spinn(SpiNNMode.SPINN_MODE_128.value),
+                       RESPONSES["success"])
+
+    # Leave out interrupts, as every byte of the commands would be traced
+    mask = TRACE_ALL & ~0x3
+    board_assert_equal(board.start_trace(mask), RESPONSES["success"])
+    dvs_pkt = DVSPacket(10, 30, 1)
+    board_assert_equal(board.use_dvs(dvs_pkt), RESPONSES["success"])
+    time.sleep(0.1)
+    (lost, records) = board.get_trace()
+    log.info("Trace: {}".format(records))
+
+    board_assert_equal(lost, 0)
+    ids = [x["id"] for x in records]
+    board_assert_equal(ids[:6], ["queue_send", "queue_send", "queue_recv",
+                                 "queue_recv", "event_decoded", "queue_send"])
+    board_assert("packet_queued" in ids)
+    decoded = records[ids.index("event_decoded")]
+    board_assert_equal(decoded["value"], (30 << 8) | 10)
+    board_assert_equal(decoded["tag"], 1)
+
+    # Nothing wraps in 0.1s, so time only runs forward
+    cycles = [x["cycles"] for x in records]
+    board_assert_equal(cycles, sorted(cycles))
+
+    events = to_chrome(records)
+    board_assert_equal(len([x for x in events if x["ph"] != "M"]),
+                       len(records))
+
+def test_trace_isr(board):
+    """Tests that interrupts are traced as matching entries and exits"""
+    board_assert_equal(board.start_trace(0x3), RESPONSES["success"])
+    (_, records) = board.get_trace()
+
+    # The command bytes themselves arrive by interrupt
+    board_assert(records)
+    enters = [x for x in records if x["id"] == "isr_enter"]
+    exits = [x for x in records if x["id"] == "isr_exit"]
+    board_assert(abs(len(enters) - len(exits)) <= 1)
+
+def test_trace_bench(board, log):
+    """Tests that a trace record costs only a few tens of cycles"""
+    iterations = 1000
+    cycles = board.bench(BENCHMARKS["trace"], iterations)
+    log.info("Trace record took %d cycles", cycles // iterations)
+    board_assert(0 < cycles < 50 * iterations)
+
+def test_trace_bad_op(board):
+    """Tests that an unknown trace operation is rejected"""
+    board._write(COMMANDS["trace"] + chr(2) + chr(0) + chr(0))
+    board_assert_equal(board._read(), RESPONSES["bad_param"])
+
+@pytest.mark.parametrize("bench_id", [len(BENCHMARKS), 255])
+def test_bench_bad_id(board, bench_id):
+    """Tests that an unknown benchmark is rejected"""
+    board_assert_equal(board.bench(bench_id, 1), None)
+
 def test_spinn_nocrash(board):
     """Test that sending a DVS packet with no forwarding does not crash board"""
     pkt = DVSPacket(10, 30, 1)
@@ -158,3 +383,234 @@ def test_spinn_fwd_rx_received(board):
     speed = board.get_received_data()
     assert speed > 0
     assert speed == 100
+
+@pytest.mark.parametrize("idx,sym,reason", [
+    (0, None, "bad_parity"),                # Parity flipped
+    (3, 0x33, "bad_symbol"),                # Not a 2-of-7 symbol
+    (4, SYMBOL_TABLE[-1], "bad_symbol"),    # Early EOP
+    (10, SYMBOL_TABLE[0], "bad_eop"),       # Missing EOP
+    ])
+def test_spinn_rx_invalid_dropped(board, idx, sym, reason):
+    """Tests that a received packet which fails decoding is counted and not
+    forwarded"""
+
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board.get_rx_stats_spinn(reset=True)
+    test_pkt = motor_2_to_7(100)
+    if sym is None:
+        sym = SYMBOL_TABLE[1] if test_pkt.data[idx] == SYMBOL_TABLE[0] \
+              else SYMBOL_TABLE[0]
+    test_pkt.data[idx] = sym
+    board_assert_equal(board.use_spinn(test_pkt), RESPONSES["success"])
+
+    # Nothing should be forwarded
+    board_assert_equal(board._read(), "")
+
+    # Only the reason for rejection is counted
+    stats = board.get_rx_stats_spinn()
+    for name in RX_STATS:
+        board_assert_equal(stats[name], 1 if name == reason else 0)
+
+def test_spinn_rx_stats_valid(board):
+    """Tests that valid received packets are counted, and counts clear"""
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board.get_rx_stats_spinn(reset=True)
+    for speed in (10, 20, 30):
+        board_assert_equal(board.use_spinn(motor_2_to_7(speed)),
+                           RESPONSES["success"])
+        board_assert_equal(board.get_received_data(), speed)
+
+    board_assert_equal(board.get_rx_stats_spinn(reset=True)["packets"], 3)
+    board_assert_equal(board.get_rx_stats_spinn()["packets"], 0)
+
+def test_spinn_route_default(board):
+    """Tests that by default every packet is routed to the PC"""
+    (misses, routes) = board.get_routes_spinn()
+    board_assert_equal(misses, 0)
+    board_assert_equal(len(routes), 1)
+    board_assert_equal(routes[0]["handler"], HANDLERS["pc"])
+    board_assert_equal(routes[0]["mask"], 0)
+
+@pytest.mark.parametrize("handler,arg", [
+    (HANDLERS["pc"], 0),
+    (HANDLERS["pwm"], 0),
+    (HANDLERS["pwm"], 1),
+    (HANDLERS["gpio"], 0),
+    (HANDLERS["gpio"], 5),
+    (HANDLERS["counter"], 0),
+    ])
+def test_spinn_route_add_correct(board, handler, arg):
+    """Tests that routes to each handler are accepted"""
+    board_assert_equal(board.add_route_spinn(0x02010000, 0xFFFF0000, handler,
+                                             arg), RESPONSES["success"])
+
+@pytest.mark.parametrize("handler,arg", [
+    (len(HANDLERS), 0),     # Unknown handler
+    (HANDLERS["pwm"], 2),   # Unknown PWM channel
+    (HANDLERS["gpio"], 2),  # Pin in use by PC USART
+    (HANDLERS["gpio"], 16), # Not a pin
+    ])
+def test_spinn_route_add_incorrect(board, handler, arg):
+    """Tests that routes to invalid handlers are rejected"""
+    board_assert_equal(board.add_route_spinn(0x02010000, 0xFFFF0000, handler,
+                                             arg), RESPONSES["bad_param"])
+
+def test_spinn_route_full(board):
+    """Tests that routes beyond the size of the table are rejected"""
+    board_assert_equal(board.clear_routes_spinn(), RESPONSES["success"])
+    resp = RESPONSES["success"]
+    added = 0
+    while resp == RESPONSES["success"] and added < 256:
+        resp = board.add_route_spinn(added << 16, 0x00FF0000, 
+                                     HANDLERS["counter"])
+        added += 1
+    board_assert_equal(resp, RESPONSES["bad_param"])
+    (_, routes) = board.get_routes_spinn()
+    board_assert_equal(len(routes), added - 1)
+
+def test_spinn_route_clear(board):
+    """Tests that with no routes received packets are counted and dropped"""
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board_assert_equal(board.clear_routes_spinn(), RESPONSES["success"])
+    board_assert_equal(board.use_spinn(motor_2_to_7(100)),
+                       RESPONSES["success"])
+
+    board_assert_equal(board._read(), "")
+    (misses, routes) = board.get_routes_spinn()
+    board_assert_equal(misses, 1)
+    board_assert_equal(routes, [])
+
+def test_spinn_route_counter(board):
+    """Tests that packets are routed by key, with the first route added
+    taking priority, and counted"""
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board_assert_equal(board.clear_routes_spinn(), RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0x02010000, 0xFFFF0000,
+                                             HANDLERS["counter"]),
+                       RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0, 0, HANDLERS["pc"]),
+                       RESPONSES["success"])
+
+    # Counted, not forwarded
+    for value in (5, 6, 7):
+        board_assert_equal(board.use_spinn(key_2_to_7(0x02010000 | value)),
+                           RESPONSES["success"])
+    board_assert_equal(board._read(), "")
+
+    # Falls to the PC route
+    board_assert_equal(board.use_spinn(key_2_to_7(0x02020000 | 100)),
+                       RESPONSES["success"])
+    board_assert_equal(board.get_received_data(), 100)
+
+    (misses, routes) = board.get_routes_spinn()
+    board_assert_equal(misses, 0)
+    board_assert_equal(routes[0]["hits"], 3)
+    board_assert_equal(routes[0]["last_value"], 7)
+    board_assert_equal(routes[1]["hits"], 1)
+
+def test_spinn_route_add_on_default(board):
+    """Tests that a route added on top of the default table takes priority
+    over the default route, and that a route which could never be reached
+    is refused"""
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0x02010000, 0xFFFF0000,
+                                             HANDLERS["counter"]),
+                       RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0x02010000, 0xFFFF0000,
+                                             HANDLERS["pc"]),
+                       RESPONSES["bad_param"])
+    board_assert_equal(board.use_spinn(key_2_to_7(0x02010000 | 5)),
+                       RESPONSES["success"])
+    board_assert_equal(board._read(), "")
+
+    (misses, routes) = board.get_routes_spinn()
+    board_assert_equal(misses, 0)
+    board_assert_equal(len(routes), 2)
+    board_assert_equal(routes[0]["handler"], HANDLERS["counter"])
+    board_assert_equal(routes[0]["hits"], 1)
+    board_assert_equal(routes[1]["mask"], 0)
+    board_assert_equal(routes[1]["hits"], 0)
+
+def test_spinn_route_shared_byte(board):
+    """Tests that a key sharing the route bits of a route it does not match
+    still reaches a catch-all route below it"""
+    board_assert_equal(board.set_spinn_rx_fwd(0), RESPONSES["success"])
+    board_assert_equal(board.clear_routes_spinn(), RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0x02010000, 0xFFFF0000,
+                                             HANDLERS["counter"]),
+                       RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0, 0, HANDLERS["pc"]),
+                       RESPONSES["success"])
+
+    # Same route bits as the counter route, different chip address
+    board_assert_equal(board.use_spinn(key_2_to_7(0x03010000 | 100)),
+                       RESPONSES["success"])
+    board_assert_equal(board.get_received_data(), 100)
+
+    (misses, routes) = board.get_routes_spinn()
+    board_assert_equal(misses, 0)
+    board_assert_equal(routes[0]["hits"], 0)
+    board_assert_equal(routes[1]["hits"], 1)
+
+def test_spinn_route_masked_miss(board):
+    """Tests that key bits outside the route bits are checked"""
+    board_assert_equal(board.clear_routes_spinn(), RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0x02010000, 0xFFFF0000,
+                                             HANDLERS["counter"]),
+                       RESPONSES["success"])
+    board_assert_equal(board.use_spinn(key_2_to_7(0x03010000)),
+                       RESPONSES["success"])
+
+    (misses, routes) = board.get_routes_spinn()
+    board_assert_equal(misses, 1)
+    board_assert_equal(routes[0]["hits"], 0)
+
+@pytest.mark.parametrize("channel,cfg", [
+    (2, {}),                                    # Unknown channel
+    (0, {"minimum": 100, "maximum": 50}),       # Limits reversed
+    (1, {"maximum": PWM_PERIOD + 1}),           # Beyond period
+    ])
+def test_pwm_config_incorrect(board, channel, cfg):
+    """Tests that invalid PWM channel settings are rejected"""
+    board_assert_equal(board.configure_pwm(channel, **cfg),
+                       RESPONSES["bad_param"])
+
+@pytest.mark.parametrize("channel,value,cfg,exp", [
+    (0, 0x8000, {}, PWM_PERIOD // 2),
+    (1, 0xFFFF, {}, PWM_PERIOD - 1),
+    (0, 0x8000, {"offset": 100}, PWM_PERIOD // 2 + 100),
+    (1, 0x8000, {"gain": 1000, "offset": -600}, 0),
+    (0, 0xFFFF, {"maximum": 2000}, 2000),
+    (1, 0x0000, {"minimum": 300}, 300),
+    ])
+def test_pwm_route(board, channel, value, cfg, exp):
+    """Tests that a routed packet is scaled into the compare register"""
+    board_assert_equal(board.configure_pwm(channel, **cfg),
+                       RESPONSES["success"])
+    board_assert_equal(board.clear_routes_spinn(), RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0x02000000, 0xFFFF0000,
+                                             HANDLERS["pwm"], channel),
+                       RESPONSES["success"])
+    board_assert_equal(board.use_spinn(key_2_to_7(0x02000000 | value)),
+                       RESPONSES["success"])
+
+    board_assert_equal(board.get_pwm()[channel], (exp, exp))
+
+def test_pwm_slew(board):
+    """Tests that a slew-limited channel ramps to its target"""
+    slew = 1
+    board_assert_equal(board.configure_pwm(0, slew=slew), RESPONSES["success"])
+    board_assert_equal(board.clear_routes_spinn(), RESPONSES["success"])
+    board_assert_equal(board.add_route_spinn(0x02000000, 0xFFFF0000,
+                                             HANDLERS["pwm"], 0),
+                       RESPONSES["success"])
+    board_assert_equal(board.use_spinn(key_2_to_7(0x02000000 | 0xFFFF)),
+                       RESPONSES["success"])
+
+    # At 20kHz, 1 count per period is over 100ms from 0 to full scale
+    (target, compare) = board.get_pwm()[0]
+    board_assert_equal(target, PWM_PERIOD - 1)
+    board_assert(compare < target)
+
+    time.sleep(0.2)
+    board_assert_equal(board.get_pwm()[0], (target, target))
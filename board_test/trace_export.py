@@ -0,0 +1,124 @@
+"""Converts a trace from the interface board to Chrome trace JSON, to be
+loaded into chrome://tracing or Perfetto for latency analysis"""
+
+# Import statements
+import argparse
+import json
+import logging
+from controller import (Controller, CORE_HZ, TRACE_ALL, TRACE_IDS,
+                        TRACE_QUEUES, TRACE_DROPS, TRACE_IRQS)
+
+# Constant definitions
+PROCESS_ID = 1
+LANES = {
+    "dvs_rx": 1,
+    "spinn_tx": 2,
+    "isr": 3,
+}
+
+def _unwrap(records, core_hz):
+    """Yields each record with its time in microseconds from the first
+    record, following the 32-bit cycle counter through any wraps"""
+    base = None
+    last = 0
+    wraps = 0
+    for rec in records:
+        if base is None:
+            base = rec["cycles"]
+            last = base
+        if rec["cycles"] < last:
+            wraps += 1
+        last = rec["cycles"]
+        cycles = rec["cycles"] + (wraps << 32) - base
+        yield rec, cycles * 1000000.0 / core_hz
+
+def _lane(rec):
+    """Returns the timeline lane, drawn as a thread, for a record"""
+    if rec["id"] in ("queue_send", "queue_recv"):
+        return TRACE_QUEUES[rec["tag"]]
+    if rec["id"] == "drop":
+        return "dvs_rx" if TRACE_DROPS[rec["tag"]].startswith("dvs") \
+            else "spinn_tx"
+    if rec["id"] == "event_decoded":
+        return "dvs_rx"
+    return "spinn_tx"
+
+def to_chrome(records, core_hz=CORE_HZ):
+    """Converts a list of records from Controller.get_trace to a list of
+    Chrome trace events. Interrupts become durations, symbol acknowledges
+    durations from the symbol being written, and everything else instants"""
+    events = [{"ph": "M", "pid": PROCESS_ID, "tid": tid, "name": "thread_name",
+               "args": {"name": name}} for (name, tid) in LANES.items()]
+
+    for rec, ts in _unwrap(records, core_hz):
+        event = {"pid": PROCESS_ID, "ts": ts, "cat": rec["id"]}
+
+        if rec["id"] in ("isr_enter", "isr_exit"):
+            event["ph"] = "B" if rec["id"] == "isr_enter" else "E"
+            event["tid"] = LANES["isr"]
+            event["name"] = TRACE_IRQS.get(rec["tag"],
+                                           "IRQ{}".format(rec["tag"]))
+        elif rec["id"] == "symbol_acked":
+            dur = rec["value"] * 1000000.0 / core_hz
+            event.update({"ph": "X", "ts": ts - dur, "dur": dur,
+                          "tid": LANES["spinn_tx"], "name": "symbol",
+                          "args": {"cycles": rec["value"]}})
+        else:
+            event.update({"ph": "i", "s": "t", "tid": LANES[_lane(rec)],
+                          "name": rec["id"]})
+            if rec["id"] == "event_decoded":
+                event["args"] = {"x": rec["value"] & 0xFF,
+                                 "y": rec["value"] >> 8,
+                                 "polarity": rec["tag"]}
+            elif rec["id"] == "packet_queued":
+                event["args"] = {"events": rec["tag"],
+                                 "symbols": rec["value"]}
+            elif rec["id"] == "drop":
+                event["args"] = {"where": TRACE_DROPS[rec["tag"]],
+                                 "item": rec["value"]}
+            else:
+                event["args"] = {"item": rec["value"]}
+        events.append(event)
+
+    return events
+
+def main():
+    """Starts a trace on the board, waits, then writes it as Chrome trace
+    JSON"""
+    from loggers import init_loggers
+    import time
+
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output", help="JSON file to write")
+    parser.add_argument("-t", "--time", type=float, default=1.0,
+                        help="seconds to trace for")
+    parser.add_argument("-i", "--ids", nargs="+", choices=TRACE_IDS,
+                        help="record types to trace, default all")
+    args = parser.parse_args()
+
+    init_loggers()
+    logger = logging.getLogger("Main")
+    logger.setLevel(logging.DEBUG)
+
+    mask = TRACE_ALL
+    if args.ids:
+        mask = sum(1 << TRACE_IDS.index(x) for x in args.ids)
+
+    with Controller() as con:
+        responding = con.get_responding()
+        if not responding:
+            logger.error("No responding COM port found")
+            raise Exception("No responding COM port found")
+        con.open(responding[0])
+
+        con.start_trace(mask)
+        time.sleep(args.time)
+        (lost, records) = con.get_trace()
+
+    logger.info("Got %d records, %d lost to overwriting", len(records), lost)
+    with open(args.output, "w") as out:
+        json.dump({"traceEvents": to_chrome(records),
+                   "displayTimeUnit": "ns"}, out)
+
+if __name__ == '__main__':
+    main()
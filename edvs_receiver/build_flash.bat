@@ -1,8 +1,12 @@
 @echo off
 
+REM Configuration to build, Debug (FreeRTOS) or BareMetal
+set CONFIG=%1
+if "%CONFIG%"=="" set CONFIG=Debug
+
 REM Build the project file
-IarBuild.exe EDVSReceiver.ewp Debug
+IarBuild.exe EDVSReceiver.ewp %CONFIG%
 
 REM Erase and reset the chip to start the program
-"C:\Program Files (x86)\STMicroelectronics\STM32 ST-LINK Utility\ST-LINK Utility\ST-LINK_CLI.exe" -P Debug/Exe/EDVSReceiver.bin 0x08000000 -V "after_programming"
+"C:\Program Files (x86)\STMicroelectronics\STM32 ST-LINK Utility\ST-LINK Utility\ST-LINK_CLI.exe" -P %CONFIG%/Exe/EDVSReceiver.bin 0x08000000 -V "after_programming"
 "C:\Program Files (x86)\STMicroelectronics\STM32 ST-LINK Utility\ST-LINK Utility\ST-LINK_CLI.exe" -Rst
@@ -0,0 +1,110 @@
+#ifndef _SIM_PERIPH_H
+#define _SIM_PERIPH_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Simulated core clock, as set up by the device startup code */
+#define SIM_CORE_HZ (48000000u)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+typedef struct sim_opts_s {
+    uint32_t run_ms;        /* Exit after this long; 0 runs until reset, or
+                               until a replay has finished */
+    int dvs_fd;             /* Raw eDVS output fed to USART1, or -1 */
+    int pc_fd;              /* Non-blocking connection to the PC for USART2,
+                               or -1 to dump what it is sent as hex */
+    uint8_t verbose;        /* Also dump what is sent to the eDVS */
+    uint8_t virtual_clock;  /* Run on a virtual clock rather than the host's,
+                               for repeatable runs; bare-metal build only */
+    uint16_t access_cycles; /* Core cycles the virtual clock advances for
+                               each simulated register access */
+    uint32_t ack_ns;        /* SpiNNaker acknowledge latency */
+    uint32_t dvs_rate;      /* Events per second replayed from dvs_fd, or 0
+                               to replay at the full line rate */
+    uint32_t dvs_wait_ms;   /* Time from reset before replay starts */
+    FILE* p_samples;        /* Queue occupancy samples as CSV, or NULL */
+    uint32_t sample_us;     /* Time between samples */
+    int flash_fd;           /* Keeps the saved settings page between runs,
+                               or -1 to start each run erased */
+    uint8_t loopback;       /* Loop SpiNNaker packets back from boot */
+} sim_opts_t;
+
+/* What the simulated peripherals have seen, for reports */
+typedef struct sim_counts_s {
+    uint64_t now;           /* Core cycles since reset */
+    uint64_t replay_start;  /* Core cycle the first DVS byte arrived */
+    uint64_t last_event;    /* Core cycle the last event was delivered */
+    uint32_t line_bytes;    /* DVS bytes put on the line */
+    uint32_t overruns;      /* DVS bytes lost as the USART was not read */
+    uint32_t symbols;       /* SpiNNaker symbols acknowledged */
+    uint32_t packets;       /* Valid packets received by SpiNNaker */
+    uint32_t bad_packets;   /* Packets SpiNNaker could not decode */
+    uint32_t events;        /* Events delivered in valid packets */
+} sim_counts_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Connects the simulated peripherals to the host and, in the FreeRTOS
+ * build, creates the task which raises their interrupts. Call before
+ * firmware_main
+ *
+ * INPUTS
+ * p_opts (sim_opts_t const *) : Host connections and run time
+ *
+ * RETURNS
+ * Nothing
+ */
+void sim_config(sim_opts_t const * p_opts);
+
+/**
+ * DESCRIPTION
+ * Copies what the simulated peripherals have seen so far
+ *
+ * INPUTS
+ * p_counts (sim_counts_t*) : Filled with current counts
+ *
+ * RETURNS
+ * Nothing
+ */
+void sim_get_counts(sim_counts_t* p_counts);
+
+/**
+ * DESCRIPTION
+ * The firmware's own main(), renamed by the host build
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Only returns if the firmware's main does
+ */
+int firmware_main(void);
+
+#endif /* _SIM_PERIPH_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
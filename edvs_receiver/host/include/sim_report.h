@@ -0,0 +1,78 @@
+#ifndef _SIM_REPORT_H
+#define _SIM_REPORT_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdio.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "sim_periph.h"
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Notes the pipeline counters as a replay starts, so that the final report
+ * leaves out anything before it, such as the boot benchmark
+ *
+ * INPUTS
+ * p_counts (sim_counts_t const *) : What the peripherals have seen
+ *
+ * RETURNS
+ * Nothing
+ */
+void sim_report_start(sim_counts_t const * p_counts);
+
+/**
+ * DESCRIPTION
+ * Writes a CSV row of queue depths and cumulative counts for each stage,
+ * preceded by a header row the first time
+ *
+ * INPUTS
+ * p_out (FILE*) : CSV file
+ * p_counts (sim_counts_t const *) : What the peripherals have seen
+ *
+ * RETURNS
+ * Nothing
+ */
+void sim_report_sample(FILE* p_out, sim_counts_t const * p_counts);
+
+/**
+ * DESCRIPTION
+ * Writes what went into and out of each stage of the pipeline since the
+ * replay started, and the rate events were delivered to SpiNNaker
+ *
+ * INPUTS
+ * p_out (FILE*) : Where to write
+ * p_counts (sim_counts_t const *) : What the peripherals have seen
+ *
+ * RETURNS
+ * Nothing
+ */
+void sim_report_final(FILE* p_out, sim_counts_t const * p_counts);
+
+#endif /* _SIM_REPORT_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,345 @@
+#ifndef __STM32F0XX_H
+#define __STM32F0XX_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Stands in for the CMSIS device header and Standard Peripheral Library in
+   host builds, declaring only what the firmware uses. Registers the firmware
+   reads or writes directly are plain structs, which sim_periph.c keeps up to
+   date; TIM2 and GPIOB go through a function so that the counter is current
+   and symbol writes are seen as they happen */
+
+#define __IO volatile
+
+/* Peripherals */
+#define GPIOA                       (&sim_gpioa)
+#define GPIOB                       (sim_gpiob())
+#define GPIOC                       (&sim_gpioc)
+#define TIM2                        (sim_tim2())
+#define TIM3                        (&sim_tim3)
+#define USART1                      (&sim_usart1)
+#define USART2                      (&sim_usart2)
+
+/* GPIO */
+#define GPIO_Pin_0                  ((uint16_t) 0x0001)
+#define GPIO_Pin_1                  ((uint16_t) 0x0002)
+#define GPIO_Pin_2                  ((uint16_t) 0x0004)
+#define GPIO_Pin_3                  ((uint16_t) 0x0008)
+#define GPIO_Pin_4                  ((uint16_t) 0x0010)
+#define GPIO_Pin_5                  ((uint16_t) 0x0020)
+#define GPIO_Pin_6                  ((uint16_t) 0x0040)
+#define GPIO_Pin_7                  ((uint16_t) 0x0080)
+#define GPIO_Pin_8                  ((uint16_t) 0x0100)
+#define GPIO_Pin_9                  ((uint16_t) 0x0200)
+#define GPIO_Pin_10                 ((uint16_t) 0x0400)
+#define GPIO_Pin_11                 ((uint16_t) 0x0800)
+#define GPIO_Pin_12                 ((uint16_t) 0x1000)
+#define GPIO_Pin_13                 ((uint16_t) 0x2000)
+#define GPIO_Pin_14                 ((uint16_t) 0x4000)
+#define GPIO_Pin_15                 ((uint16_t) 0x8000)
+
+#define GPIO_PinSource2             ((uint8_t) 2)
+#define GPIO_PinSource3             ((uint8_t) 3)
+#define GPIO_PinSource6             ((uint8_t) 6)
+#define GPIO_PinSource7             ((uint8_t) 7)
+#define GPIO_PinSource9             ((uint8_t) 9)
+#define GPIO_PinSource10            ((uint8_t) 10)
+
+#define GPIO_AF_1                   ((uint8_t) 1)
+
+/* RCC */
+#define RCC_AHBPeriph_GPIOA         ((uint32_t) 0x00020000)
+#define RCC_AHBPeriph_GPIOB         ((uint32_t) 0x00040000)
+#define RCC_AHBPeriph_GPIOC         ((uint32_t) 0x00080000)
+#define RCC_APB1Periph_TIM2         ((uint32_t) 0x00000001)
+#define RCC_APB1Periph_TIM3         ((uint32_t) 0x00000002)
+#define RCC_APB1Periph_USART2       ((uint32_t) 0x00020000)
+#define RCC_APB2Periph_SYSCFG       ((uint32_t) 0x00000001)
+#define RCC_APB2Periph_USART1       ((uint32_t) 0x00004000)
+
+/* USART; only the receive interrupt is modelled */
+#define USART_WordLength_8b         ((uint32_t) 0x00000000)
+#define USART_StopBits_1            ((uint32_t) 0x00000000)
+#define USART_Parity_No             ((uint32_t) 0x00000000)
+#define USART_Mode_Rx               ((uint32_t) 0x00000004)
+#define USART_Mode_Tx               ((uint32_t) 0x00000008)
+#define USART_HardwareFlowControl_None ((uint32_t) 0x00000000)
+
+#define USART_IT_RXNE               ((uint32_t) 0x00050105)
+#define USART_FLAG_RXNE             ((uint32_t) 0x00000020)
+#define USART_FLAG_TXE              ((uint32_t) 0x00000080)
+
+/* EXTI */
+#define EXTI_Line7                  ((uint32_t) 0x00000080)
+#define EXTI_Line8                  ((uint32_t) 0x00000100)
+#define EXTI_Line9                  ((uint32_t) 0x00000200)
+#define EXTI_Line10                 ((uint32_t) 0x00000400)
+#define EXTI_Line11                 ((uint32_t) 0x00000800)
+#define EXTI_Line12                 ((uint32_t) 0x00001000)
+#define EXTI_Line13                 ((uint32_t) 0x00002000)
+#define EXTI_Line14                 ((uint32_t) 0x00004000)
+
+#define EXTI_PortSourceGPIOB        ((uint8_t) 0x01)
+#define EXTI_PinSource7             ((uint8_t) 0x07)
+#define EXTI_PinSource8             ((uint8_t) 0x08)
+#define EXTI_PinSource9             ((uint8_t) 0x09)
+#define EXTI_PinSource10            ((uint8_t) 0x0A)
+#define EXTI_PinSource11            ((uint8_t) 0x0B)
+#define EXTI_PinSource12            ((uint8_t) 0x0C)
+#define EXTI_PinSource13            ((uint8_t) 0x0D)
+#define EXTI_PinSource14            ((uint8_t) 0x0E)
+
+/* TIM */
+#define TIM_CounterMode_Up          ((uint16_t) 0x0000)
+#define TIM_CKD_DIV1                ((uint16_t) 0x0000)
+#define TIM_IT_Update               ((uint16_t) 0x0001)
+#define TIM_SR_UIF                  ((uint16_t) 0x0001)
+#define TIM_DIER_UIE                ((uint16_t) 0x0001)
+#define TIM_OCMode_PWM1             ((uint16_t) 0x0060)
+#define TIM_OutputState_Enable      ((uint16_t) 0x0001)
+#define TIM_OCPolarity_High         ((uint16_t) 0x0000)
+#define TIM_OCPreload_Enable        ((uint16_t) 0x0008)
+
+/* IWDG */
+#define IWDG_WriteAccess_Enable     ((uint16_t) 0x5555)
+#define IWDG_Prescaler_16           ((uint8_t) 0x02)
+
+/* FLASH */
+#define FLASH_FLAG_PGERR            ((uint32_t) 0x00000004)
+#define FLASH_FLAG_WRPERR           ((uint32_t) 0x00000010)
+#define FLASH_FLAG_EOP              ((uint32_t) 0x00000020)
+
+/* Core */
+#define __disable_irq()             sim_disable_irq()
+#define __enable_irq()              sim_enable_irq()
+#define __get_PRIMASK()             sim_get_primask()
+#define __WFI()                     sim_wfi()
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+typedef enum {Bit_RESET = 0, Bit_SET} BitAction;
+
+typedef enum {
+    FLASH_BUSY = 1,
+    FLASH_ERROR_WRP,
+    FLASH_ERROR_PROGRAM,
+    FLASH_COMPLETE,
+    FLASH_TIMEOUT,
+} FLASH_Status;
+
+/* Interrupt numbers match the device, as traces record them */
+typedef enum IRQn {
+    SysTick_IRQn    = -1,
+    EXTI4_15_IRQn   = 7,
+    TIM2_IRQn       = 15,
+    TIM3_IRQn       = 16,
+    USART1_IRQn     = 27,
+    USART2_IRQn     = 28,
+} IRQn_Type;
+
+typedef struct {
+    __IO uint32_t MODER;
+    __IO uint32_t OTYPER;
+    __IO uint32_t OSPEEDR;
+    __IO uint32_t PUPDR;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t LCKR;
+    __IO uint32_t AFR[2];
+    __IO uint32_t BRR;
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+} TIM_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t BRR;
+    __IO uint32_t ISR;
+    __IO uint32_t RDR;
+    __IO uint32_t TDR;
+} USART_TypeDef;
+
+typedef enum {
+    GPIO_Mode_IN = 0x00,
+    GPIO_Mode_OUT = 0x01,
+    GPIO_Mode_AF = 0x02,
+    GPIO_Mode_AN = 0x03,
+} GPIOMode_TypeDef;
+
+typedef enum {GPIO_OType_PP = 0x00, GPIO_OType_OD = 0x01} GPIOOType_TypeDef;
+
+typedef enum {
+    GPIO_Speed_Level_1 = 0x01,
+    GPIO_Speed_Level_2 = 0x02,
+    GPIO_Speed_Level_3 = 0x03,
+} GPIOSpeed_TypeDef;
+
+#define GPIO_Speed_2MHz             GPIO_Speed_Level_1
+#define GPIO_Speed_50MHz            GPIO_Speed_Level_3
+
+typedef enum {
+    GPIO_PuPd_NOPULL = 0x00,
+    GPIO_PuPd_UP = 0x01,
+    GPIO_PuPd_DOWN = 0x02,
+} GPIOPuPd_TypeDef;
+
+typedef struct {
+    uint32_t GPIO_Pin;
+    GPIOMode_TypeDef GPIO_Mode;
+    GPIOSpeed_TypeDef GPIO_Speed;
+    GPIOOType_TypeDef GPIO_OType;
+    GPIOPuPd_TypeDef GPIO_PuPd;
+} GPIO_InitTypeDef;
+
+typedef struct {
+    uint32_t USART_BaudRate;
+    uint32_t USART_WordLength;
+    uint32_t USART_StopBits;
+    uint32_t USART_Parity;
+    uint32_t USART_Mode;
+    uint32_t USART_HardwareFlowControl;
+} USART_InitTypeDef;
+
+typedef struct {
+    uint8_t NVIC_IRQChannel;
+    uint8_t NVIC_IRQChannelPriority;
+    FunctionalState NVIC_IRQChannelCmd;
+} NVIC_InitTypeDef;
+
+typedef enum {EXTI_Mode_Interrupt = 0x00, EXTI_Mode_Event = 0x04} EXTIMode_TypeDef;
+
+typedef enum {
+    EXTI_Trigger_Rising = 0x08,
+    EXTI_Trigger_Falling = 0x0C,
+    EXTI_Trigger_Rising_Falling = 0x10,
+} EXTITrigger_TypeDef;
+
+typedef struct {
+    uint32_t EXTI_Line;
+    EXTIMode_TypeDef EXTI_Mode;
+    EXTITrigger_TypeDef EXTI_Trigger;
+    FunctionalState EXTI_LineCmd;
+} EXTI_InitTypeDef;
+
+typedef struct {
+    uint16_t TIM_Prescaler;
+    uint16_t TIM_CounterMode;
+    uint32_t TIM_Period;
+    uint16_t TIM_ClockDivision;
+    uint8_t TIM_RepetitionCounter;
+} TIM_TimeBaseInitTypeDef;
+
+typedef struct {
+    uint16_t TIM_OCMode;
+    uint16_t TIM_OutputState;
+    uint16_t TIM_OutputNState;
+    uint32_t TIM_Pulse;
+    uint16_t TIM_OCPolarity;
+    uint16_t TIM_OCNPolarity;
+    uint16_t TIM_OCIdleState;
+    uint16_t TIM_OCNIdleState;
+} TIM_OCInitTypeDef;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+extern uint32_t SystemCoreClock;
+
+extern GPIO_TypeDef sim_gpioa;
+extern GPIO_TypeDef sim_gpioc;
+extern TIM_TypeDef sim_tim3;
+extern USART_TypeDef sim_usart1;
+extern USART_TypeDef sim_usart2;
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+/* Register access and core intrinsics, in sim_periph.c */
+GPIO_TypeDef* sim_gpiob(void);
+TIM_TypeDef* sim_tim2(void);
+void sim_disable_irq(void);
+void sim_enable_irq(void);
+uint32_t sim_get_primask(void);
+void sim_wfi(void);
+
+/* Standard Peripheral Library subset */
+void RCC_AHBPeriphClockCmd(uint32_t periph, FunctionalState state);
+void RCC_APB1PeriphClockCmd(uint32_t periph, FunctionalState state);
+void RCC_APB2PeriphClockCmd(uint32_t periph, FunctionalState state);
+
+void GPIO_Init(GPIO_TypeDef* gpio, GPIO_InitTypeDef* init);
+void GPIO_PinAFConfig(GPIO_TypeDef* gpio, uint16_t source, uint8_t af);
+void GPIO_WriteBit(GPIO_TypeDef* gpio, uint16_t pin, BitAction val);
+
+void USART_Init(USART_TypeDef* usart, USART_InitTypeDef* init);
+void USART_Cmd(USART_TypeDef* usart, FunctionalState state);
+void USART_OverSampling8Cmd(USART_TypeDef* usart, FunctionalState state);
+void USART_ITConfig(USART_TypeDef* usart, uint32_t it, FunctionalState state);
+ITStatus USART_GetITStatus(USART_TypeDef* usart, uint32_t it);
+void USART_ClearITPendingBit(USART_TypeDef* usart, uint32_t it);
+FlagStatus USART_GetFlagStatus(USART_TypeDef* usart, uint32_t flag);
+uint16_t USART_ReceiveData(USART_TypeDef* usart);
+void USART_SendData(USART_TypeDef* usart, uint16_t data);
+
+void NVIC_Init(NVIC_InitTypeDef* init);
+void NVIC_SystemReset(void);
+uint32_t SysTick_Config(uint32_t ticks);
+
+void SYSCFG_EXTILineConfig(uint8_t port, uint8_t pin);
+void EXTI_Init(EXTI_InitTypeDef* init);
+ITStatus EXTI_GetITStatus(uint32_t line);
+void EXTI_ClearITPendingBit(uint32_t line);
+
+void TIM_TimeBaseStructInit(TIM_TimeBaseInitTypeDef* init);
+void TIM_TimeBaseInit(TIM_TypeDef* tim, TIM_TimeBaseInitTypeDef* init);
+void TIM_Cmd(TIM_TypeDef* tim, FunctionalState state);
+void TIM_ITConfig(TIM_TypeDef* tim, uint16_t it, FunctionalState state);
+void TIM_ClearITPendingBit(TIM_TypeDef* tim, uint16_t it);
+void TIM_ARRPreloadConfig(TIM_TypeDef* tim, FunctionalState state);
+void TIM_OCStructInit(TIM_OCInitTypeDef* init);
+void TIM_OC1Init(TIM_TypeDef* tim, TIM_OCInitTypeDef* init);
+void TIM_OC2Init(TIM_TypeDef* tim, TIM_OCInitTypeDef* init);
+void TIM_OC1PreloadConfig(TIM_TypeDef* tim, uint16_t preload);
+void TIM_OC2PreloadConfig(TIM_TypeDef* tim, uint16_t preload);
+
+void IWDG_WriteAccessCmd(uint16_t access);
+void IWDG_SetPrescaler(uint8_t prescaler);
+void IWDG_SetReload(uint16_t reload);
+void IWDG_ReloadCounter(void);
+void IWDG_Enable(void);
+
+void FLASH_Unlock(void);
+void FLASH_Lock(void);
+void FLASH_ClearFlag(uint32_t flags);
+FLASH_Status FLASH_ErasePage(uint32_t addr);
+FLASH_Status FLASH_ProgramWord(uint32_t addr, uint32_t data);
+
+#endif /* __STM32F0XX_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,224 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "sim_periph.h"
+#include "dvs_gen.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+#define SIM_USAGE \
+    "usage: %s [-t ms] [-d dvs_file] [-p] [-v] [-c] [-s cycles] [-a ns]\n"  \
+    "          [-r rate] [-w ms] [-o csv_file] [-i us] [-f cfg_file]\n"     \
+    "          [-g pattern,rate] [-l]\n"                                    \
+    "  -t ms        exit after ms of run time\n"                            \
+    "  -d dvs_file  feed raw eDVS output from a file to the DVS USART\n"    \
+    "  -p           connect the PC USART to a pseudo-terminal\n"            \
+    "  -v           dump bytes sent to the eDVS\n"                          \
+    "  -c           run on a virtual clock, for repeatable runs\n"          \
+    "  -s cycles    virtual cycles per register access (default 16)\n"      \
+    "  -a ns        SpiNNaker acknowledge latency (default 0)\n"            \
+    "  -r rate      replay dvs_file at rate events/s, not the line rate\n"  \
+    "  -w ms        time from reset before the replay starts (default 0)\n" \
+    "  -o csv_file  sample queue occupancy to a CSV file\n"                 \
+    "  -i us        time between samples (default 1000)\n"                  \
+    "  -f cfg_file  keep settings saved to flash in a file between runs\n"  \
+    "  -g pattern,rate\n"                                                   \
+    "               generate rate events/s from boot, with the pattern\n"   \
+    "               0 noise, 1 moving bar or 2 hot block\n"                 \
+    "  -l           loop SpiNNaker packets back to the decoder\n"
+
+/* Virtual clock cost of a register access, as a rough stand-in for the
+   code run between accesses */
+#define SIM_ACCESS_CYCLES (16)
+#define SIM_SAMPLE_US     (1000)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static int pty_open(void);
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+int main(int argc, char** argv)
+{
+    sim_opts_t opts = {
+        .dvs_fd = -1,
+        .pc_fd = -1,
+        .flash_fd = -1,
+        .access_cycles = SIM_ACCESS_CYCLES,
+        .sample_us = SIM_SAMPLE_US,
+    };
+    unsigned long gen_pattern = 0, gen_rate = 0;
+    char* p_end;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:d:pvcs:a:r:w:o:i:f:g:l")) != -1)
+    {
+        switch (opt)
+        {
+            case 't':
+                opts.run_ms = strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                opts.dvs_fd = open(optarg, O_RDONLY);
+                if (opts.dvs_fd < 0)
+                {
+                    perror(optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'p':
+                opts.pc_fd = pty_open();
+                break;
+            case 'v':
+                opts.verbose = 1;
+                break;
+            case 'c':
+                opts.virtual_clock = 1;
+                break;
+            case 's':
+                opts.access_cycles = strtoul(optarg, NULL, 0);
+                break;
+            case 'a':
+                opts.ack_ns = strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                opts.dvs_rate = strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                opts.dvs_wait_ms = strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                opts.p_samples = fopen(optarg, "w");
+                if (opts.p_samples == NULL)
+                {
+                    perror(optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'i':
+                opts.sample_us = strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                opts.flash_fd = open(optarg, O_RDWR | O_CREAT, 0644);
+                if (opts.flash_fd < 0)
+                {
+                    perror(optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'g':
+                gen_pattern = strtoul(optarg, &p_end, 0);
+                if (*p_end != ',' || gen_pattern >= DVS_GEN_NUM)
+                {
+                    fprintf(stderr, SIM_USAGE, argv[0]);
+                    return EXIT_FAILURE;
+                }
+                gen_rate = strtoul(p_end + 1, NULL, 0);
+                break;
+            case 'l':
+                opts.loopback = 1;
+                break;
+            default:
+                fprintf(stderr, SIM_USAGE, argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+#ifndef BARE_METAL
+    /* The kernel's POSIX port switches tasks on the host's clock */
+    if (opts.virtual_clock)
+    {
+        fprintf(stderr, "%s: -c needs the bare-metal build\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    /* The generator's timer only exists once the firmware has set it up;
+       use the gdvs command instead */
+    if (gen_rate)
+    {
+        fprintf(stderr, "%s: -g needs the bare-metal build\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+#endif
+    if (!opts.sample_us)
+    {
+        fprintf(stderr, SIM_USAGE, argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    sim_config(&opts);
+    dvs_gen_start((dvs_gen_pattern_t) gen_pattern, gen_rate);
+    return firmware_main();
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Opens a raw pseudo-terminal for the PC USART and prints its name, for
+ * board_test to connect to in place of the board's COM port
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Non-blocking file descriptor of the master side
+ */
+static int pty_open(void)
+{
+    struct termios tio;
+    char const * name;
+    int master, slave;
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0 ||
+        (name = ptsname(master)) == NULL)
+    {
+        perror("pty");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Hold the slave open, raw, so that the master never sees a hang-up
+       while no client is connected */
+    slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave < 0 || tcgetattr(slave, &tio) < 0)
+    {
+        perror(name);
+        exit(EXIT_FAILURE);
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    fprintf(stderr, "sim: PC USART on %s\n", name);
+    return master;
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
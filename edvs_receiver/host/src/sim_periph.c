@@ -0,0 +1,1545 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stm32f0xx.h"
+
+#ifndef BARE_METAL
+#include <pthread.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "sim_periph.h"
+#include "sim_report.h"
+#include "spinn_codec.h"
+#include "spinn_channel.h"
+#include "boot_config.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* SpiNNaker link wiring on GPIOB, as in spinn_link.c */
+#define SIM_TX_PINS       (0x007F)
+#define SIM_TX_ACK_PIN    (GPIO_Pin_7)
+#define SIM_TX_ACK_LINE   (EXTI_Line7)
+
+/* EXTI lines served by EXTI4_15_IRQHandler */
+#define SIM_EXTI4_15      (0xFFF0)
+
+/* USART status and control bits */
+#define SIM_USART_RXNE    (0x0020)
+#define SIM_USART_RXNEIE  (0x0020)
+
+/* Watchdog clock; the IWDG runs from the 40 kHz LSI */
+#define SIM_LSI_HZ        (40000u)
+
+/* How often host connections are read for more input, in core cycles */
+#define SIM_POLL_CYCLES   (SIM_CORE_HZ / 1000)
+
+/* How long a replay may be quiet, once the trace has been sent, before the
+   run ends */
+#define SIM_IDLE_CYCLES   (SIM_CORE_HZ / 10)
+
+/* A DVS byte with its top bit set starts an event unless it ends one, as
+   the decoder assumes */
+#define SIM_DVS_FIRST     (0x80)
+
+/* How long the core sleeps per check in __WFI */
+#define SIM_WFI_SLEEP_NS  (50000)
+
+/* Value of erased flash */
+#define SIM_FLASH_ERASED  (0xFF)
+
+/* Bytes read from a host connection at once */
+#define SIM_UART_BUF_LEN  (64)
+
+#ifndef BARE_METAL
+#define SIM_TASK_NAME     "Sim"
+#define SIM_STACK_WORDS   (configMINIMAL_STACK_SIZE)
+#endif
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* Interrupts the simulator raises, with the handler the vector table would
+   point to */
+typedef struct sim_irq_s {
+    IRQn_Type irqn;
+    void (*handler)(void);
+    uint8_t enabled;
+    uint8_t priority;
+} sim_irq_t;
+
+typedef struct sim_tim_s {
+    TIM_TypeDef* p_regs;
+    uint8_t enabled;
+    uint64_t start;         /* Core cycle the counter was enabled */
+    uint64_t updates;       /* Update events raised so far */
+} sim_tim_t;
+
+typedef struct sim_uart_s {
+    USART_TypeDef* p_regs;
+    char const * name;
+    int in_fd;              /* Bytes to receive, or -1 */
+    int out_fd;             /* Where sent bytes go, or -1 to dump as hex */
+    uint8_t dump;           /* Dump sent bytes if not written to out_fd */
+    uint8_t line_start;     /* Next dumped byte starts a line */
+    uint8_t eof;            /* in_fd has nothing more to send */
+    uint8_t mid_event;      /* Last byte received started a DVS event */
+    uint32_t baud;
+    uint64_t rx_due;        /* Core cycle the next byte may arrive */
+    uint64_t poll_due;      /* Core cycle in_fd is next read */
+    uint64_t event_due;     /* Core cycle the next paced event may start */
+    uint64_t tx_done;       /* Core cycle the last sent byte leaves */
+    uint8_t buf[SIM_UART_BUF_LEN];
+    uint16_t buf_len;
+    uint16_t buf_pos;
+    uint32_t rx_count;
+    uint32_t tx_count;
+} sim_uart_t;
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+uint32_t SystemCoreClock = SIM_CORE_HZ;
+
+GPIO_TypeDef sim_gpioa;
+GPIO_TypeDef sim_gpioc;
+TIM_TypeDef sim_tim3;
+USART_TypeDef sim_usart1;
+USART_TypeDef sim_usart2;
+
+static GPIO_TypeDef gpiob;
+static TIM_TypeDef tim2;
+
+/* Interrupt handlers, weak here so that a build without the module which
+   provides one still links */
+void SysTick_Handler(void) __attribute__((weak));
+void EXTI4_15_IRQHandler(void) __attribute__((weak));
+void TIM2_IRQHandler(void) __attribute__((weak));
+void TIM3_IRQHandler(void) __attribute__((weak));
+void USART1_IRQHandler(void) __attribute__((weak));
+void USART2_IRQHandler(void) __attribute__((weak));
+
+/* In order of service when pending at the same priority */
+static sim_irq_t sim_irqs[] = {
+    {SysTick_IRQn,  SysTick_Handler,     0, 3},
+    {EXTI4_15_IRQn, EXTI4_15_IRQHandler, 0, 0},
+    {TIM2_IRQn,     TIM2_IRQHandler,     0, 0},
+    {TIM3_IRQn,     TIM3_IRQHandler,     0, 0},
+    {USART1_IRQn,   USART1_IRQHandler,   0, 0},
+    {USART2_IRQn,   USART2_IRQHandler,   0, 0},
+};
+#define SIM_IRQ_NUM (sizeof(sim_irqs) / sizeof(sim_irqs[0]))
+
+static sim_tim_t sim_tims[] = {
+    {&tim2,     0, 0, 0},
+    {&sim_tim3, 0, 0, 0},
+};
+#define SIM_TIM_NUM (sizeof(sim_tims) / sizeof(sim_tims[0]))
+
+static sim_uart_t sim_uarts[] = {
+    {.p_regs = &sim_usart1, .name = "dvs", .in_fd = -1, .out_fd = -1,
+     .line_start = 1},
+    {.p_regs = &sim_usart2, .name = "pc", .in_fd = -1, .out_fd = -1,
+     .line_start = 1},
+};
+#define SIM_UART_NUM (sizeof(sim_uarts) / sizeof(sim_uarts[0]))
+
+static struct timespec sim_epoch;
+static uint64_t sim_run_cycles;
+
+/* Virtual clock, advanced by register accesses and by sleeping */
+static uint8_t sim_virtual;
+static uint64_t sim_vclock;
+static uint16_t sim_access_cycles;
+
+/* DVS replay */
+static uint64_t sim_event_cycles;
+static uint8_t sim_replaying;
+
+/* Queue occupancy samples */
+static FILE* sim_samples;
+static uint64_t sim_sample_cycles;
+static uint64_t sim_sample_due;
+
+static sim_counts_t sim_counts;
+
+/* Interrupt masking, and whether a handler is running */
+static volatile uint8_t sim_primask;
+static volatile uint8_t sim_in_isr;
+
+/* EXTI */
+static uint32_t exti_imr;
+static uint32_t exti_pr;
+
+/* SysTick */
+static uint32_t systick_period;
+static uint64_t systick_due;
+static uint8_t systick_pending;
+
+/* IWDG */
+static uint8_t iwdg_enabled;
+static uint32_t iwdg_divider = 4;
+static uint32_t iwdg_reload = 0xFFF;
+static uint64_t iwdg_kicked;
+
+/* Saved settings page, mapped at its device address, and the file which
+   keeps it between runs */
+static uint8_t* flash_page;
+static int flash_fd = -1;
+static uint8_t flash_locked = 1;
+
+/* SpiNNaker peer, and the packet it is receiving */
+static uint8_t link_tx_seen;
+static uint64_t link_ack_cycles;
+static uint64_t link_ack_due;
+static uint8_t link_ack_waiting;
+static uint64_t link_last_sym;
+static uint8_t link_syms[SPINN_LONG_SYMS];
+static uint8_t link_len;
+
+#ifndef BARE_METAL
+static StaticTask_t sim_tcb;
+static StackType_t sim_stack[SIM_STACK_WORDS];
+#endif
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static uint64_t sim_now(void);
+static void sim_update(void);
+static void sim_service(void);
+static int sim_irq_next(void);
+static sim_irq_t* sim_irq_find(uint8_t irqn);
+static sim_uart_t* sim_uart_find(USART_TypeDef* usart);
+static void gpio_flush(GPIO_TypeDef* gpio);
+static uint64_t sim_next_due(uint64_t now);
+static uint64_t sim_min(uint64_t a, uint64_t b);
+static void link_update(uint64_t now);
+static void link_receive(uint8_t sym, uint64_t now);
+static void tim_update(sim_tim_t* p_tim, uint64_t now);
+static uint64_t tim_next_update(sim_tim_t* p_tim);
+static void uart_update(sim_uart_t* p_uart, uint64_t now);
+static uint64_t uart_byte_cycles(sim_uart_t* p_uart);
+static uint8_t uart_rx_pending(USART_TypeDef* usart);
+static void uart_dump(sim_uart_t* p_uart, uint8_t data);
+static void flash_map(int fd);
+static void flash_store(void);
+static void sim_exit(int status, char const * reason);
+#ifndef BARE_METAL
+static void sim_task(void* pvParameters);
+#endif
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+void sim_config(sim_opts_t const * p_opts)
+{
+    clock_gettime(CLOCK_MONOTONIC, &sim_epoch);
+    sim_run_cycles = (uint64_t) p_opts->run_ms * (SIM_CORE_HZ / 1000);
+
+    sim_virtual = p_opts->virtual_clock;
+    sim_access_cycles = p_opts->access_cycles;
+    link_ack_cycles = (uint64_t) p_opts->ack_ns * (SIM_CORE_HZ / 1000000) /
+                      1000;
+
+    sim_samples = p_opts->p_samples;
+    sim_sample_cycles = (uint64_t) p_opts->sample_us *
+                        (SIM_CORE_HZ / 1000000);
+    sim_sample_due = sim_sample_cycles;
+
+    sim_uarts[0].in_fd = p_opts->dvs_fd;
+    sim_uarts[0].dump = p_opts->verbose;
+    sim_uarts[0].rx_due = (uint64_t) p_opts->dvs_wait_ms *
+                          (SIM_CORE_HZ / 1000);
+    if (p_opts->dvs_rate)
+    {
+        sim_event_cycles = SIM_CORE_HZ / p_opts->dvs_rate;
+    }
+
+    /* Without a connection, what the PC would be sent is dumped */
+    sim_uarts[1].in_fd = p_opts->pc_fd;
+    sim_uarts[1].out_fd = p_opts->pc_fd;
+    sim_uarts[1].dump = 1;
+
+    flash_map(p_opts->flash_fd);
+
+    /* Before the firmware starts, which leaves the setting alone */
+    spinn_set_loopback(p_opts->loopback);
+
+#ifndef BARE_METAL
+    /* Above every firmware task, as interrupts are */
+    xTaskCreateStatic(sim_task, SIM_TASK_NAME, SIM_STACK_WORDS, NULL,
+                      configMAX_PRIORITIES - 1, sim_stack, &sim_tcb);
+#endif
+}
+
+void sim_get_counts(sim_counts_t* p_counts)
+{
+    *p_counts = sim_counts;
+    p_counts->now = sim_now();
+}
+
+GPIO_TypeDef* sim_gpiob(void)
+{
+    sim_service();
+    return &gpiob;
+}
+
+TIM_TypeDef* sim_tim2(void)
+{
+    sim_service();
+    return &tim2;
+}
+
+#ifdef BARE_METAL
+
+void sim_disable_irq(void)
+{
+    sim_primask = 1;
+}
+
+void sim_enable_irq(void)
+{
+    sim_primask = 0;
+    sim_service();
+}
+
+uint32_t sim_get_primask(void)
+{
+    return sim_primask;
+}
+
+#else
+
+/* Interrupts are masked by blocking the signals the POSIX port switches
+   tasks with, so that masking also holds off the tick as on the device */
+void sim_disable_irq(void)
+{
+    portDISABLE_INTERRUPTS();
+    sim_primask = 1;
+}
+
+void sim_enable_irq(void)
+{
+    sim_primask = 0;
+    portENABLE_INTERRUPTS();
+}
+
+uint32_t sim_get_primask(void)
+{
+    sigset_t mask;
+
+    /* Critical sections mask the tick too, as cpsid does on the device */
+    pthread_sigmask(SIG_BLOCK, NULL, &mask);
+    return sim_primask || sigismember(&mask, SIGALRM);
+}
+
+#endif /* BARE_METAL */
+
+void sim_wfi(void)
+{
+    struct timespec nap = {0, SIM_WFI_SLEEP_NS};
+
+    /* Wakes on a pending interrupt even while masked */
+    for (;;)
+    {
+        sim_update();
+        if (sim_irq_next() >= 0)
+        {
+            return;
+        }
+
+        /* Nothing happens on the virtual clock until something is due, so
+           skip straight to it */
+        if (sim_virtual)
+        {
+            sim_vclock = sim_next_due(sim_vclock);
+        }
+        else
+        {
+            nanosleep(&nap, NULL);
+        }
+    }
+}
+
+void RCC_AHBPeriphClockCmd(uint32_t periph, FunctionalState state)
+{
+    (void) periph;
+    (void) state;
+}
+
+void RCC_APB1PeriphClockCmd(uint32_t periph, FunctionalState state)
+{
+    (void) periph;
+    (void) state;
+}
+
+void RCC_APB2PeriphClockCmd(uint32_t periph, FunctionalState state)
+{
+    (void) periph;
+    (void) state;
+}
+
+void GPIO_Init(GPIO_TypeDef* gpio, GPIO_InitTypeDef* init)
+{
+    (void) gpio;
+    (void) init;
+}
+
+void GPIO_PinAFConfig(GPIO_TypeDef* gpio, uint16_t source, uint8_t af)
+{
+    (void) gpio;
+    (void) source;
+    (void) af;
+}
+
+void GPIO_WriteBit(GPIO_TypeDef* gpio, uint16_t pin, BitAction val)
+{
+    if (val == Bit_SET)
+    {
+        gpio->BSRR = pin;
+    }
+    else
+    {
+        gpio->BRR = pin;
+    }
+    sim_update();
+}
+
+void USART_Init(USART_TypeDef* usart, USART_InitTypeDef* init)
+{
+    sim_uart_t* p_uart = sim_uart_find(usart);
+
+    p_uart->baud = init->USART_BaudRate;
+    usart->BRR = SystemCoreClock / init->USART_BaudRate;
+}
+
+void USART_Cmd(USART_TypeDef* usart, FunctionalState state)
+{
+    (void) usart;
+    (void) state;
+}
+
+void USART_OverSampling8Cmd(USART_TypeDef* usart, FunctionalState state)
+{
+    (void) usart;
+    (void) state;
+}
+
+void USART_ITConfig(USART_TypeDef* usart, uint32_t it, FunctionalState state)
+{
+    if (it != USART_IT_RXNE)
+    {
+        return;
+    }
+
+    if (state == ENABLE)
+    {
+        usart->CR1 |= SIM_USART_RXNEIE;
+    }
+    else
+    {
+        usart->CR1 &= ~SIM_USART_RXNEIE;
+    }
+}
+
+ITStatus USART_GetITStatus(USART_TypeDef* usart, uint32_t it)
+{
+    sim_service();
+    return (it == USART_IT_RXNE && uart_rx_pending(usart)) ? SET : RESET;
+}
+
+void USART_ClearITPendingBit(USART_TypeDef* usart, uint32_t it)
+{
+    /* Receive is only cleared by reading */
+    (void) usart;
+    (void) it;
+}
+
+FlagStatus USART_GetFlagStatus(USART_TypeDef* usart, uint32_t flag)
+{
+    sim_uart_t* p_uart = sim_uart_find(usart);
+
+    sim_service();
+
+    /* Transmit is empty once the byte ahead of the last one written has
+       left, freeing the shift register for it */
+    if (flag == USART_FLAG_TXE)
+    {
+        return p_uart->tx_done <= sim_now() + uart_byte_cycles(p_uart) ?
+               SET : RESET;
+    }
+    return (usart->ISR & flag) ? SET : RESET;
+}
+
+uint16_t USART_ReceiveData(USART_TypeDef* usart)
+{
+    sim_service();
+    usart->ISR &= ~SIM_USART_RXNE;
+    return usart->RDR;
+}
+
+void USART_SendData(USART_TypeDef* usart, uint16_t data)
+{
+    sim_uart_t* p_uart = sim_uart_find(usart);
+    uint8_t byte = data & 0xFF;
+    uint64_t now;
+
+    sim_service();
+    now = sim_now();
+
+    usart->TDR = byte;
+    p_uart->tx_count++;
+    p_uart->tx_done = (p_uart->tx_done > now ? p_uart->tx_done : now) +
+                      uart_byte_cycles(p_uart);
+
+    if (p_uart->out_fd >= 0)
+    {
+        if (write(p_uart->out_fd, &byte, 1) < 0 && errno != EAGAIN)
+        {
+            sim_exit(EXIT_FAILURE, "PC connection lost");
+        }
+    }
+    else if (p_uart->dump)
+    {
+        uart_dump(p_uart, byte);
+    }
+}
+
+void NVIC_Init(NVIC_InitTypeDef* init)
+{
+    sim_irq_t* p_irq = sim_irq_find(init->NVIC_IRQChannel);
+
+    if (p_irq)
+    {
+        p_irq->priority = init->NVIC_IRQChannelPriority;
+        p_irq->enabled = (init->NVIC_IRQChannelCmd == ENABLE);
+    }
+}
+
+void NVIC_SystemReset(void)
+{
+    sim_exit(EXIT_SUCCESS, "system reset");
+}
+
+uint32_t SysTick_Config(uint32_t ticks)
+{
+    systick_period = ticks;
+    systick_due = sim_now() + ticks;
+
+    /* SysTick_Config gives it the lowest priority */
+    sim_irqs[0].enabled = 1;
+    sim_irqs[0].priority = 3;
+    return 0;
+}
+
+void SYSCFG_EXTILineConfig(uint8_t port, uint8_t pin)
+{
+    (void) port;
+    (void) pin;
+}
+
+void EXTI_Init(EXTI_InitTypeDef* init)
+{
+    if (init->EXTI_LineCmd == ENABLE)
+    {
+        exti_imr |= init->EXTI_Line;
+    }
+    else
+    {
+        exti_imr &= ~init->EXTI_Line;
+    }
+}
+
+ITStatus EXTI_GetITStatus(uint32_t line)
+{
+    return (exti_pr & exti_imr & line) ? SET : RESET;
+}
+
+void EXTI_ClearITPendingBit(uint32_t line)
+{
+    exti_pr &= ~line;
+}
+
+void TIM_TimeBaseStructInit(TIM_TimeBaseInitTypeDef* init)
+{
+    init->TIM_Period = 0xFFFFFFFF;
+    init->TIM_Prescaler = 0;
+    init->TIM_ClockDivision = TIM_CKD_DIV1;
+    init->TIM_CounterMode = TIM_CounterMode_Up;
+    init->TIM_RepetitionCounter = 0;
+}
+
+void TIM_TimeBaseInit(TIM_TypeDef* tim, TIM_TimeBaseInitTypeDef* init)
+{
+    tim->PSC = init->TIM_Prescaler;
+    tim->ARR = init->TIM_Period;
+}
+
+void TIM_Cmd(TIM_TypeDef* tim, FunctionalState state)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_TIM_NUM; i++)
+    {
+        if (sim_tims[i].p_regs == tim)
+        {
+            sim_tims[i].enabled = (state == ENABLE);
+            sim_tims[i].start = sim_now();
+            sim_tims[i].updates = 0;
+        }
+    }
+}
+
+void TIM_ITConfig(TIM_TypeDef* tim, uint16_t it, FunctionalState state)
+{
+    if (state == ENABLE)
+    {
+        tim->DIER |= it;
+    }
+    else
+    {
+        tim->DIER &= ~it;
+    }
+}
+
+void TIM_ClearITPendingBit(TIM_TypeDef* tim, uint16_t it)
+{
+    tim->SR &= ~it;
+}
+
+void TIM_ARRPreloadConfig(TIM_TypeDef* tim, FunctionalState state)
+{
+    (void) tim;
+    (void) state;
+}
+
+void TIM_OCStructInit(TIM_OCInitTypeDef* init)
+{
+    memset(init, 0, sizeof(*init));
+}
+
+void TIM_OC1Init(TIM_TypeDef* tim, TIM_OCInitTypeDef* init)
+{
+    tim->CCR1 = init->TIM_Pulse;
+}
+
+void TIM_OC2Init(TIM_TypeDef* tim, TIM_OCInitTypeDef* init)
+{
+    tim->CCR2 = init->TIM_Pulse;
+}
+
+void TIM_OC1PreloadConfig(TIM_TypeDef* tim, uint16_t preload)
+{
+    (void) tim;
+    (void) preload;
+}
+
+void TIM_OC2PreloadConfig(TIM_TypeDef* tim, uint16_t preload)
+{
+    (void) tim;
+    (void) preload;
+}
+
+void IWDG_WriteAccessCmd(uint16_t access)
+{
+    (void) access;
+}
+
+void IWDG_SetPrescaler(uint8_t prescaler)
+{
+    iwdg_divider = 4u << prescaler;
+}
+
+void IWDG_SetReload(uint16_t reload)
+{
+    iwdg_reload = reload;
+}
+
+void IWDG_ReloadCounter(void)
+{
+    iwdg_kicked = sim_now();
+}
+
+void IWDG_Enable(void)
+{
+    iwdg_enabled = 1;
+    iwdg_kicked = sim_now();
+}
+
+void FLASH_Unlock(void)
+{
+    flash_locked = 0;
+}
+
+void FLASH_Lock(void)
+{
+    flash_locked = 1;
+}
+
+void FLASH_ClearFlag(uint32_t flags)
+{
+    (void) flags;
+}
+
+FLASH_Status FLASH_ErasePage(uint32_t addr)
+{
+    /* Only the settings page exists; the rest of flash holds no code */
+    if (flash_locked || addr != BOOT_CONFIG_ADDR)
+    {
+        return FLASH_ERROR_WRP;
+    }
+
+    memset(flash_page, SIM_FLASH_ERASED, BOOT_CONFIG_PAGE_LEN);
+    flash_store();
+    return FLASH_COMPLETE;
+}
+
+FLASH_Status FLASH_ProgramWord(uint32_t addr, uint32_t data)
+{
+    uint32_t offset = addr - BOOT_CONFIG_ADDR;
+    uint32_t word;
+
+    if (flash_locked || addr < BOOT_CONFIG_ADDR || offset % 4 ||
+        offset >= BOOT_CONFIG_PAGE_LEN)
+    {
+        return FLASH_ERROR_WRP;
+    }
+
+    /* As on the device, a word must be erased before it is programmed */
+    memcpy(&word, &flash_page[offset], sizeof(word));
+    if (word != 0xFFFFFFFFu)
+    {
+        return FLASH_ERROR_PROGRAM;
+    }
+
+    memcpy(&flash_page[offset], &data, sizeof(data));
+    flash_store();
+    return FLASH_COMPLETE;
+}
+
+#ifndef BARE_METAL
+void vAssertCalled(const char* pcFile, unsigned long ulLine)
+{
+    fprintf(stderr, "sim: assertion failed at %s:%lu\n", pcFile, ulLine);
+    sim_exit(EXIT_FAILURE, "assertion");
+}
+#endif
+
+/* Weak default handlers */
+void SysTick_Handler(void) {}
+void EXTI4_15_IRQHandler(void) {}
+void TIM2_IRQHandler(void) {}
+void TIM3_IRQHandler(void) {}
+void USART1_IRQHandler(void) {}
+void USART2_IRQHandler(void) {}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Reads the simulated core clock, which follows either the host's or the
+ * virtual clock
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Core cycles since sim_config
+ */
+static uint64_t sim_now(void)
+{
+    struct timespec now;
+    uint64_t ns;
+
+    if (sim_virtual)
+    {
+        return sim_vclock;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ns = (uint64_t) (now.tv_sec - sim_epoch.tv_sec) * 1000000000u +
+         now.tv_nsec - sim_epoch.tv_nsec;
+    return ns * (SIM_CORE_HZ / 1000000) / 1000;
+}
+
+/**
+ * DESCRIPTION
+ * Brings every peripheral up to the current time, setting the pending flags
+ * of anything which has happened since. Raises no interrupts itself
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void sim_update(void)
+{
+#ifndef BARE_METAL
+    sigset_t all, old;
+#endif
+    sim_counts_t counts;
+    uint64_t now;
+    uint8_t i;
+
+#ifndef BARE_METAL
+    /* Any task may get here, so keep the tick from switching mid-update */
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+#endif
+
+    now = sim_now();
+
+    gpio_flush(&sim_gpioa);
+    gpio_flush(&gpiob);
+    gpio_flush(&sim_gpioc);
+    link_update(now);
+
+    for (i = 0; i < SIM_TIM_NUM; i++)
+    {
+        tim_update(&sim_tims[i], now);
+    }
+
+    for (i = 0; i < SIM_UART_NUM; i++)
+    {
+        uart_update(&sim_uarts[i], now);
+    }
+
+    if (systick_period && now >= systick_due)
+    {
+        systick_pending = 1;
+        systick_due = now + systick_period;
+    }
+
+    if (sim_samples && now >= sim_sample_due)
+    {
+        sim_get_counts(&counts);
+        sim_report_sample(sim_samples, &counts);
+        while (sim_sample_due <= now)
+        {
+            sim_sample_due += sim_sample_cycles;
+        }
+    }
+
+#ifndef BARE_METAL
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+#endif
+
+    if (iwdg_enabled && (now - iwdg_kicked) * SIM_LSI_HZ >
+        (uint64_t) iwdg_reload * iwdg_divider * SIM_CORE_HZ)
+    {
+        sim_exit(EXIT_FAILURE, "watchdog reset");
+    }
+
+    if (sim_run_cycles && now >= sim_run_cycles)
+    {
+        sim_exit(EXIT_SUCCESS, "run time reached");
+    }
+
+    /* Without a run time, a replay ends once the trace has been sent and
+       the link has gone quiet */
+    if (!sim_run_cycles && sim_uarts[0].eof &&
+        now >= (sim_uarts[0].rx_due > link_last_sym ?
+                sim_uarts[0].rx_due : link_last_sym) + SIM_IDLE_CYCLES)
+    {
+        sim_exit(EXIT_SUCCESS, "replay finished");
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Updates the peripherals then runs the handler of each pending interrupt,
+ * highest priority first, as the NVIC would. In the bare-metal build this
+ * happens whenever the firmware touches a simulated register or unmasks
+ * interrupts, so that interrupts preempt it; in the FreeRTOS build only the
+ * simulator task does it. Each call is also a register access, which costs
+ * time on the virtual clock
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void sim_service(void)
+{
+    int idx;
+#ifndef BARE_METAL
+    sigset_t all, old;
+#endif
+
+    if (sim_virtual)
+    {
+        sim_vclock += sim_access_cycles;
+    }
+    sim_update();
+
+    /* Handlers touch registers too, but are not preempted here */
+    if (sim_in_isr)
+    {
+        return;
+    }
+
+#ifdef BARE_METAL
+    if (sim_primask)
+    {
+        return;
+    }
+#else
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ||
+        xTaskGetCurrentTaskHandle() != (TaskHandle_t) &sim_tcb)
+    {
+        return;
+    }
+#endif
+
+    while ((idx = sim_irq_next()) >= 0)
+    {
+#ifndef BARE_METAL
+        /* Handlers run with the tick held off, as on the device */
+        sigfillset(&all);
+        pthread_sigmask(SIG_BLOCK, &all, &old);
+#endif
+        sim_in_isr = 1;
+        sim_irqs[idx].handler();
+        sim_in_isr = 0;
+        if (sim_irqs[idx].irqn == SysTick_IRQn)
+        {
+            systick_pending = 0;
+        }
+#ifndef BARE_METAL
+        pthread_sigmask(SIG_SETMASK, &old, NULL);
+#endif
+        sim_update();
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Finds the enabled, pending interrupt to run next
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Index into sim_irqs, or -1 if nothing is pending
+ */
+static int sim_irq_next(void)
+{
+    int best = -1;
+    uint8_t pending;
+    uint8_t i;
+
+    for (i = 0; i < SIM_IRQ_NUM; i++)
+    {
+        switch (sim_irqs[i].irqn)
+        {
+            case SysTick_IRQn:
+                pending = systick_pending;
+                break;
+            case EXTI4_15_IRQn:
+                pending = (exti_pr & exti_imr & SIM_EXTI4_15) != 0;
+                break;
+            case TIM2_IRQn:
+                pending = (tim2.SR & tim2.DIER & TIM_SR_UIF) != 0;
+                break;
+            case TIM3_IRQn:
+                pending = (sim_tim3.SR & sim_tim3.DIER & TIM_SR_UIF) != 0;
+                break;
+            case USART1_IRQn:
+                pending = uart_rx_pending(&sim_usart1);
+                break;
+            case USART2_IRQn:
+                pending = uart_rx_pending(&sim_usart2);
+                break;
+            default:
+                pending = 0;
+                break;
+        }
+
+        if (pending && sim_irqs[i].enabled &&
+            (best < 0 || sim_irqs[i].priority < sim_irqs[best].priority))
+        {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * DESCRIPTION
+ * Looks up an interrupt by device number
+ *
+ * INPUTS
+ * irqn (uint8_t) : Device interrupt number
+ *
+ * RETURNS
+ * The interrupt, or NULL if it is not simulated
+ */
+static sim_irq_t* sim_irq_find(uint8_t irqn)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_IRQ_NUM; i++)
+    {
+        if (sim_irqs[i].irqn == (IRQn_Type) irqn)
+        {
+            return &sim_irqs[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * DESCRIPTION
+ * Looks up the simulation of a USART
+ *
+ * INPUTS
+ * usart (USART_TypeDef*) : USART registers
+ *
+ * RETURNS
+ * The simulated USART
+ */
+static sim_uart_t* sim_uart_find(USART_TypeDef* usart)
+{
+    return usart == USART1 ? &sim_uarts[0] : &sim_uarts[1];
+}
+
+/**
+ * DESCRIPTION
+ * Finds when the next thing happens that could wake the core, for the
+ * virtual clock to skip to while it sleeps
+ *
+ * INPUTS
+ * now (uint64_t) : Current core cycle
+ *
+ * RETURNS
+ * Core cycle of the next event, at least one cycle after now
+ */
+static uint64_t sim_next_due(uint64_t now)
+{
+    uint64_t due = now + SIM_POLL_CYCLES;
+    uint64_t t;
+    sim_uart_t* p_uart;
+    uint8_t i;
+
+    for (i = 0; i < SIM_UART_NUM; i++)
+    {
+        p_uart = &sim_uarts[i];
+        if (p_uart->in_fd >= 0 && p_uart->baud && !p_uart->eof)
+        {
+            /* An empty buffer waits for the host connection too */
+            t = p_uart->rx_due;
+            if (p_uart->buf_pos == p_uart->buf_len && p_uart->poll_due > t)
+            {
+                t = p_uart->poll_due;
+            }
+            due = sim_min(due, t);
+        }
+    }
+    for (i = 0; i < SIM_TIM_NUM; i++)
+    {
+        due = sim_min(due, tim_next_update(&sim_tims[i]));
+    }
+    if (link_ack_waiting)
+    {
+        due = sim_min(due, link_ack_due);
+    }
+    if (systick_period)
+    {
+        due = sim_min(due, systick_due);
+    }
+    if (sim_samples)
+    {
+        due = sim_min(due, sim_sample_due);
+    }
+    if (sim_run_cycles)
+    {
+        due = sim_min(due, sim_run_cycles);
+    }
+
+    return due > now ? due : now + 1;
+}
+
+/**
+ * DESCRIPTION
+ * Picks the earlier of two core cycles
+ *
+ * INPUTS
+ * a (uint64_t) : Core cycle
+ * b (uint64_t) : Core cycle
+ *
+ * RETURNS
+ * The earlier
+ */
+static uint64_t sim_min(uint64_t a, uint64_t b)
+{
+    return a < b ? a : b;
+}
+
+/**
+ * DESCRIPTION
+ * Applies writes to the set and reset registers of a port to its output
+ *
+ * INPUTS
+ * gpio (GPIO_TypeDef*) : Port registers
+ *
+ * RETURNS
+ * Nothing
+ */
+static void gpio_flush(GPIO_TypeDef* gpio)
+{
+    if (gpio->BSRR || gpio->BRR)
+    {
+        /* Set wins over reset for a pin written both ways */
+        gpio->ODR = (gpio->ODR & ~((gpio->BSRR >> 16) | gpio->BRR)) |
+                    (gpio->BSRR & 0xFFFF);
+        gpio->BSRR = 0;
+        gpio->BRR = 0;
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Plays the SpiNNaker end of the link, acknowledging each symbol the board
+ * sends by toggling the acknowledge pin once the configured latency has
+ * passed
+ *
+ * INPUTS
+ * now (uint64_t) : Current core cycle
+ *
+ * RETURNS
+ * Nothing
+ */
+static void link_update(uint64_t now)
+{
+    uint8_t tx = gpiob.ODR & SIM_TX_PINS;
+
+    if (tx != link_tx_seen)
+    {
+        link_receive(tx ^ link_tx_seen, now);
+        link_tx_seen = tx;
+
+        link_ack_waiting = 1;
+        link_ack_due = now + link_ack_cycles;
+    }
+
+    if (link_ack_waiting && now >= link_ack_due)
+    {
+        link_ack_waiting = 0;
+        gpiob.IDR ^= SIM_TX_ACK_PIN;
+        exti_pr |= SIM_TX_ACK_LINE & exti_imr;
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Collects a symbol into the packet SpiNNaker is receiving, decoding the
+ * packet at its EOP and counting the events it carries
+ *
+ * INPUTS
+ * sym (uint8_t) : Symbol, as the pins which changed
+ * now (uint64_t) : Current core cycle
+ *
+ * RETURNS
+ * Nothing
+ */
+static void link_receive(uint8_t sym, uint64_t now)
+{
+    spinn_packet_t pkt;
+
+    sim_counts.symbols++;
+    link_last_sym = now;
+
+    /* Anything longer than a packet fails decoding on its length */
+    if (link_len < SPINN_LONG_SYMS)
+    {
+        link_syms[link_len] = sym;
+    }
+    if (link_len < 0xFF)
+    {
+        link_len++;
+    }
+
+    if (sym != SPINN_SYM_EOP)
+    {
+        return;
+    }
+
+    if (spinn_codec_decode(link_syms, link_len, &pkt) == SPINN_DECODE_OK)
+    {
+        sim_counts.packets++;
+        sim_counts.events++;
+        if (pkt.has_payload)
+        {
+            sim_counts.events += ((pkt.payload >> 16) & SPINN_EVENT_VALID) ?
+                                 1 : 0;
+            sim_counts.events += (pkt.payload & SPINN_EVENT_VALID) ? 1 : 0;
+        }
+        sim_counts.last_event = now;
+    }
+    else
+    {
+        sim_counts.bad_packets++;
+    }
+    link_len = 0;
+}
+
+/**
+ * DESCRIPTION
+ * Brings a timer's counter up to date, flagging an update event each time
+ * it has wrapped
+ *
+ * INPUTS
+ * p_tim (sim_tim_t*) : Timer
+ * now (uint64_t) : Current core cycle
+ *
+ * RETURNS
+ * Nothing
+ */
+static void tim_update(sim_tim_t* p_tim, uint64_t now)
+{
+    uint64_t ticks, period, updates;
+
+    if (!p_tim->enabled)
+    {
+        return;
+    }
+
+    ticks = (now - p_tim->start) / ((uint64_t) p_tim->p_regs->PSC + 1);
+    period = (uint64_t) p_tim->p_regs->ARR + 1;
+    updates = ticks / period;
+
+    p_tim->p_regs->CNT = (uint32_t) (ticks % period);
+    if (updates != p_tim->updates)
+    {
+        p_tim->updates = updates;
+        p_tim->p_regs->SR |= TIM_SR_UIF;
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Works out when a timer next raises an update event
+ *
+ * INPUTS
+ * p_tim (sim_tim_t*) : Timer
+ *
+ * RETURNS
+ * Core cycle of the next update, or UINT64_MAX if it is stopped
+ */
+static uint64_t tim_next_update(sim_tim_t* p_tim)
+{
+    if (!p_tim->enabled)
+    {
+        return UINT64_MAX;
+    }
+
+    return p_tim->start + (p_tim->updates + 1) *
+           ((uint64_t) p_tim->p_regs->ARR + 1) *
+           ((uint64_t) p_tim->p_regs->PSC + 1);
+}
+
+/**
+ * DESCRIPTION
+ * Moves the next byte from a USART's host connection into its receive
+ * register once it would have arrived at the configured baud rate. DVS
+ * bytes may be held back further so that events start at the replay rate.
+ * On the virtual clock a byte arriving before the last was read overruns
+ * and is lost, as on the device; on the host's clock it waits, as the host
+ * may simply have been slow to run the firmware
+ *
+ * INPUTS
+ * p_uart (sim_uart_t*) : USART
+ * now (uint64_t) : Current core cycle
+ *
+ * RETURNS
+ * Nothing
+ */
+static void uart_update(sim_uart_t* p_uart, uint64_t now)
+{
+    uint8_t is_dvs = (p_uart->p_regs == USART1);
+    uint64_t byte_cycles = uart_byte_cycles(p_uart);
+    uint64_t arrive;
+    uint8_t data, starts;
+    ssize_t n;
+
+    if (p_uart->in_fd < 0 || !p_uart->baud || p_uart->eof ||
+        now < p_uart->rx_due ||
+        (!sim_virtual && (p_uart->p_regs->ISR & SIM_USART_RXNE)))
+    {
+        return;
+    }
+
+    if (p_uart->buf_pos == p_uart->buf_len)
+    {
+        if (now < p_uart->poll_due)
+        {
+            return;
+        }
+
+        n = read(p_uart->in_fd, p_uart->buf, sizeof(p_uart->buf));
+        if (n == 0)
+        {
+            p_uart->eof = 1;
+            return;
+        }
+        if (n < 0)
+        {
+            p_uart->poll_due = now + SIM_POLL_CYCLES;
+            return;
+        }
+        p_uart->buf_len = n;
+        p_uart->buf_pos = 0;
+    }
+
+    /* Keep to the line rate unless the byte was held up for longer than it
+       takes to send one */
+    arrive = (now - p_uart->rx_due < byte_cycles) ? p_uart->rx_due : now;
+    data = p_uart->buf[p_uart->buf_pos];
+    starts = is_dvs && !p_uart->mid_event && (data & SIM_DVS_FIRST);
+
+    if (starts && sim_event_cycles)
+    {
+        if (arrive < p_uart->event_due)
+        {
+            p_uart->rx_due = p_uart->event_due;
+            return;
+        }
+        p_uart->event_due = arrive + sim_event_cycles;
+    }
+
+    p_uart->buf_pos++;
+    p_uart->mid_event = starts;
+
+    /* Start bit, 8 data bits and a stop bit */
+    p_uart->rx_due = arrive + byte_cycles;
+
+    if (is_dvs)
+    {
+        if (!sim_replaying)
+        {
+            sim_replaying = 1;
+            sim_counts.replay_start = arrive;
+            sim_report_start(&sim_counts);
+        }
+        sim_counts.line_bytes++;
+    }
+
+    if (p_uart->p_regs->ISR & SIM_USART_RXNE)
+    {
+        sim_counts.overruns++;
+        return;
+    }
+
+    p_uart->p_regs->RDR = data;
+    p_uart->p_regs->ISR |= SIM_USART_RXNE;
+    p_uart->rx_count++;
+}
+
+/**
+ * DESCRIPTION
+ * Works out how long a USART takes to move a byte
+ *
+ * INPUTS
+ * p_uart (sim_uart_t*) : USART
+ *
+ * RETURNS
+ * Core cycles per byte, or 0 if it has not been set up
+ */
+static uint64_t uart_byte_cycles(sim_uart_t* p_uart)
+{
+    /* Start bit, 8 data bits and a stop bit */
+    return p_uart->baud ? (uint64_t) SIM_CORE_HZ * 10 / p_uart->baud : 0;
+}
+
+/**
+ * DESCRIPTION
+ * Checks whether a USART's receive interrupt is pending, without counting
+ * as a register access
+ *
+ * INPUTS
+ * usart (USART_TypeDef*) : USART registers
+ *
+ * RETURNS
+ * Non-zero if pending
+ */
+static uint8_t uart_rx_pending(USART_TypeDef* usart)
+{
+    return (usart->CR1 & SIM_USART_RXNEIE) && (usart->ISR & SIM_USART_RXNE);
+}
+
+/**
+ * DESCRIPTION
+ * Prints a sent byte as hex, starting a new line after each carriage
+ * return, which ends every frame to the PC
+ *
+ * INPUTS
+ * p_uart (sim_uart_t*) : USART which sent it
+ * data (uint8_t) : Byte sent
+ *
+ * RETURNS
+ * Nothing
+ */
+static void uart_dump(sim_uart_t* p_uart, uint8_t data)
+{
+    FILE* out = p_uart->p_regs == USART2 ? stdout : stderr;
+
+    if (p_uart->line_start)
+    {
+        fprintf(out, "%s<", p_uart->name);
+        p_uart->line_start = 0;
+    }
+    fprintf(out, " %02x", data);
+    if (data == '\r')
+    {
+        fputc('\n', out);
+        fflush(out);
+        p_uart->line_start = 1;
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Maps the saved settings page at its device address, so that firmware
+ * reads it through a pointer as on the device. It starts erased, then takes
+ * whatever the file holds
+ *
+ * INPUTS
+ * fd (int) : File keeping the page between runs, or -1
+ *
+ * RETURNS
+ * Nothing
+ */
+static void flash_map(int fd)
+{
+    uintptr_t host_page = sysconf(_SC_PAGESIZE);
+    uintptr_t base = BOOT_CONFIG_ADDR & ~(host_page - 1);
+    size_t len = (BOOT_CONFIG_ADDR + BOOT_CONFIG_PAGE_LEN - base +
+                  host_page - 1) & ~(host_page - 1);
+    void* p_map;
+
+    /* Only a hint, as a fixed mapping would replace whatever is there */
+    p_map = mmap((void*) base, len, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p_map != (void*) base)
+    {
+        fprintf(stderr, "sim: cannot map flash at 0x%08x\n",
+                BOOT_CONFIG_ADDR);
+        exit(EXIT_FAILURE);
+    }
+
+    flash_page = (uint8_t*) (uintptr_t) BOOT_CONFIG_ADDR;
+    memset(flash_page, SIM_FLASH_ERASED, BOOT_CONFIG_PAGE_LEN);
+
+    flash_fd = fd;
+    if (flash_fd >= 0 &&
+        pread(flash_fd, flash_page, BOOT_CONFIG_PAGE_LEN, 0) < 0)
+    {
+        perror("sim: flash file");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Writes the settings page back to its file, if it has one
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void flash_store(void)
+{
+    if (flash_fd >= 0 &&
+        pwrite(flash_fd, flash_page, BOOT_CONFIG_PAGE_LEN, 0) < 0)
+    {
+        sim_exit(EXIT_FAILURE, "flash file lost");
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Ends the simulation, reporting why and what went through each connection
+ *
+ * INPUTS
+ * status (int) : Process exit status
+ * reason (char const *) : What ended it
+ *
+ * RETURNS
+ * Does not return
+ */
+static void sim_exit(int status, char const * reason)
+{
+    sim_counts_t counts;
+    uint8_t i;
+
+    fflush(stdout);
+    fprintf(stderr, "\nsim: %s after %llu ms\n", reason,
+            (unsigned long long) (sim_now() / (SIM_CORE_HZ / 1000)));
+    for (i = 0; i < SIM_UART_NUM; i++)
+    {
+        fprintf(stderr, "sim: %s USART received %u, sent %u bytes\n",
+                sim_uarts[i].name, sim_uarts[i].rx_count,
+                sim_uarts[i].tx_count);
+    }
+    fprintf(stderr, "sim: %u SpiNNaker symbols acknowledged\n",
+            sim_counts.symbols);
+
+    sim_get_counts(&counts);
+    sim_report_final(stderr, &counts);
+    if (sim_samples)
+    {
+        fclose(sim_samples);
+    }
+
+    exit(status);
+}
+
+#ifndef BARE_METAL
+/**
+ * DESCRIPTION
+ * Raises simulated interrupts once per tick, standing in for the NVIC
+ *
+ * INPUTS
+ * pvParameters (void*) : Unused
+ *
+ * RETURNS
+ * Never returns
+ */
+static void sim_task(void* pvParameters)
+{
+    (void) pvParameters;
+
+    for (;;)
+    {
+        sim_service();
+        vTaskDelay(1);
+    }
+}
+#endif
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
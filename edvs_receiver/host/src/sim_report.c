@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdio.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "sim_report.h"
+#include "dvs_usart.h"
+#include "spinn_channel.h"
+#include "dvs_gen.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+#define REPORT_CYCLES_PER_US (SIM_CORE_HZ / 1000000)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Firmware counters when the replay started */
+static dvs_stats_t report_dvs_base;
+static spinn_ring_stats_t report_ring_base;
+static sim_counts_t report_sim_base;
+
+static uint8_t report_header_done = 0;
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+void sim_report_start(sim_counts_t const * p_counts)
+{
+    report_sim_base = *p_counts;
+    dvs_get_stats(&report_dvs_base);
+    spinn_get_ring_stats(&report_ring_base);
+}
+
+void sim_report_sample(FILE* p_out, sim_counts_t const * p_counts)
+{
+    dvs_stats_t dvs;
+    spinn_ring_stats_t ring;
+
+    dvs_get_stats(&dvs);
+    spinn_get_ring_stats(&ring);
+
+    if (!report_header_done)
+    {
+        fprintf(p_out, "time_us,dvs_rx_depth,spinn_tx_depth,line_bytes,"
+                       "overruns,rx_dropped,decoded,sent,retry_dropped,"
+                       "spinn_dropped,spinn_overwritten,delivered\n");
+        report_header_done = 1;
+    }
+
+    fprintf(p_out, "%llu,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+            (unsigned long long) (p_counts->now / REPORT_CYCLES_PER_US),
+            dvs.rx_depth, ring.depth, p_counts->line_bytes,
+            p_counts->overruns, dvs.rx_dropped, dvs.decoded, dvs.sent,
+            dvs.retry_dropped, ring.dropped, ring.overwritten,
+            p_counts->events);
+}
+
+void sim_report_final(FILE* p_out, sim_counts_t const * p_counts)
+{
+    dvs_stats_t dvs;
+    spinn_ring_stats_t ring;
+    dvs_gen_stats_t gen;
+    spinn_loop_stats_t loop;
+    uint64_t start = p_counts->replay_start;
+    uint32_t events = p_counts->events - report_sim_base.events;
+    uint64_t span;
+
+    dvs_get_stats(&dvs);
+    spinn_get_ring_stats(&ring);
+    dvs_gen_get_stats(&gen);
+    spinn_get_loop_stats(&loop);
+
+    if (gen.generated || gen.lost)
+    {
+        fprintf(p_out, "report: generator %u events, %u lost\n",
+                gen.generated, gen.lost);
+    }
+    fprintf(p_out, "report: line      %u bytes, %u lost to USART overrun\n",
+            p_counts->line_bytes, p_counts->overruns);
+    fprintf(p_out, "report: dvs_rx    %u bytes, %u dropped, high water %u\n",
+            dvs.rx_bytes - report_dvs_base.rx_bytes,
+            dvs.rx_dropped - report_dvs_base.rx_dropped,
+            dvs.rx_high_water);
+    fprintf(p_out, "report: decode    %u events, %u passed filter\n",
+            dvs.decoded - report_dvs_base.decoded,
+            (dvs.sent + dvs.retry_dropped) -
+            (report_dvs_base.sent + report_dvs_base.retry_dropped));
+    fprintf(p_out, "report: retry     %u dropped\n",
+            dvs.retry_dropped - report_dvs_base.retry_dropped);
+    fprintf(p_out, "report: spinn_tx  %u queued, %u dropped, "
+                   "%u overwritten, high water %u\n",
+            dvs.sent - report_dvs_base.sent,
+            ring.dropped - report_ring_base.dropped,
+            ring.overwritten - report_ring_base.overwritten,
+            ring.high_water);
+    fprintf(p_out, "report: link      %u events in %u packets, %u bad, "
+                   "%u symbols\n",
+            events, p_counts->packets - report_sim_base.packets,
+            p_counts->bad_packets - report_sim_base.bad_packets,
+            p_counts->symbols - report_sim_base.symbols);
+
+    if (loop.packets || loop.errors)
+    {
+        fprintf(p_out, "report: loopback  %u events in %u packets, "
+                       "%u errors\n",
+                loop.events, loop.packets, loop.errors);
+    }
+
+    /* Rate over the replay, or over the whole run without one */
+    span = (start && p_counts->last_event > start) ?
+           p_counts->last_event - start : p_counts->now;
+    if (span)
+    {
+        fprintf(p_out, "report: rate      %.1f events/s over %.3f ms\n",
+                (double) events * SIM_CORE_HZ / span,
+                (double) span / (SIM_CORE_HZ / 1000));
+    }
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
@@ -0,0 +1,20 @@
+# Runs edvs_sim_bare twice on the virtual clock and checks that both runs
+# print exactly the same, timings included.
+#
+#   cmake -DSIM=<edvs_sim_bare> -P repeatable.cmake
+
+foreach(run 1 2)
+    execute_process(COMMAND ${SIM} -c -t 1500
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE out_${run}
+        ERROR_VARIABLE err_${run})
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "run ${run} failed (${result}):\n${err_${run}}")
+    endif()
+endforeach()
+
+if(NOT out_1 STREQUAL out_2 OR NOT err_1 STREQUAL err_2)
+    message(FATAL_ERROR "runs differ:\n${out_1}${err_1}\n--\n${out_2}${err_2}")
+endif()
+
+message("${out_1}${err_1}")
@@ -0,0 +1,47 @@
+# Replays a synthetic eDVS trace through edvs_sim_bare on the virtual clock
+# and checks the report accounts for every event.
+#
+#   cmake -DSIM=<edvs_sim_bare> -DWORK_DIR=<dir> -P replay.cmake
+
+set(EVENTS 1000)
+set(TRACE "${WORK_DIR}/replay_trace.bin")
+set(SAMPLES "${WORK_DIR}/replay_samples.csv")
+
+# Events sweep across the array so that none repeat a pixel; the second
+# byte is never zero, which CMake strings cannot hold
+set(trace "")
+math(EXPR last "${EVENTS} - 1")
+foreach(i RANGE ${last})
+    math(EXPR first "128 + (${i} / 127) % 128")
+    math(EXPR second "1 + ${i} % 127 + 128 * (${i} % 2)")
+    string(ASCII ${first} ${second} event)
+    string(APPEND trace "${event}")
+endforeach()
+file(WRITE "${TRACE}" "${trace}")
+
+# Start after the boot benchmark; ends once the trace has been sent
+execute_process(COMMAND ${SIM} -c -w 1500 -r 5000 -d ${TRACE} -o ${SAMPLES}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE out
+    ERROR_VARIABLE err)
+message("${err}")
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "simulator failed (${result})")
+endif()
+
+foreach(expect
+        "replay finished"
+        "report: line      2000 bytes, 0 lost"
+        "report: decode    ${EVENTS} events"
+        "report: link      ${EVENTS} events")
+    string(FIND "${err}" "${expect}" found)
+    if(found EQUAL -1)
+        message(FATAL_ERROR "report lacks \"${expect}\"")
+    endif()
+endforeach()
+
+file(STRINGS "${SAMPLES}" rows)
+list(LENGTH rows count)
+if(count LESS 100)
+    message(FATAL_ERROR "only ${count} rows sampled")
+endif()
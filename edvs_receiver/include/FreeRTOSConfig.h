@@ -87,6 +87,7 @@
 #ifdef __ICCARM__
 	#include <stdint.h>
 	extern uint32_t SystemCoreClock;
+	extern uint32_t cycle_get_runtime(void);
 #endif
 
 #define configUSE_PREEMPTION			1
@@ -96,7 +97,6 @@
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES			( 7 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 60 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 5000 ) )
 #define configMAX_TASK_NAME_LEN			( 16 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
@@ -105,10 +105,20 @@
 #define configQUEUE_REGISTRY_SIZE		8
 #define configCHECK_FOR_STACK_OVERFLOW	2
 #define configUSE_RECURSIVE_MUTEXES		1
-#define configUSE_MALLOC_FAILED_HOOK	1
+#define configUSE_MALLOC_FAILED_HOOK	0
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configUSE_COUNTING_SEMAPHORES	1
-#define configGENERATE_RUN_TIME_STATS	0
+#define configGENERATE_RUN_TIME_STATS	1
+
+/* Every RTOS object is statically allocated, sized in task_config.h, so
+   there is no heap */
+#define configSUPPORT_STATIC_ALLOCATION		1
+#define configSUPPORT_DYNAMIC_ALLOCATION	0
+
+/* Run-time stats count TIM2 cycles extended by its wraps, divided by 64.
+   TIM2 is started by cycle_config() before the scheduler */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()	cycle_get_runtime()
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 			0
@@ -132,6 +142,10 @@ to exclude the API function. */
 #define INCLUDE_xQueueGetMutexHolder    1
 #define INCLUDE_xTaskGetSchedulerState  1
 #define INCLUDE_eTaskGetState           1
+#define INCLUDE_xTaskGetHandle          1
+#define INCLUDE_xTaskGetIdleTaskHandle  1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle 1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
 
 
 /* Cortex-M specific definitions. */
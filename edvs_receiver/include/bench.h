@@ -0,0 +1,62 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Code paths which can be timed by bench_run */
+typedef enum bench_id_e {
+    BENCH_SPINN_ENCODE = 0,     /* Table-driven map and encode of an event */
+    BENCH_SPINN_ENCODE_REF = 1, /* Bit-by-bit reference encoder */
+    BENCH_SPINN_DECODE = 2,     /* Table-driven decode of a short packet */
+    BENCH_SIGNAL_SEM = 3,       /* Give from ISR and take of a semaphore */
+    BENCH_SIGNAL_NOTIFY = 4,    /* Same handoff as a direct task notification */
+    BENCH_FLAG_SEM = 5,         /* Read of a flag guarded by a semaphore */
+    BENCH_FLAG_ATOMIC = 6,      /* Read of a single-byte flag with no lock */
+    BENCH_PIPELINE = 7,         /* Events from DVS input to SpiNNaker link */
+    BENCH_TRACE = 8,            /* One trace record; clears the trace */
+    BENCH_NUM
+} bench_id_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Runs a code path repeatedly and measures the time taken
+ * 
+ * INPUTS
+ * id (bench_id_t) : Code path to run
+ * iterations (uint16_t) : Number of times to run the code path
+ *
+ * RETURNS
+ * Total core clock cycles taken for all iterations (uint32_t)
+ */
+uint32_t bench_run(bench_id_t id, uint16_t iterations);
+
+#endif /* _BENCH_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
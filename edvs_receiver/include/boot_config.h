@@ -0,0 +1,121 @@
+#ifndef _BOOT_CONFIG_H
+#define _BOOT_CONFIG_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "pwm.h"
+#include "spinn_route.h"
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Last 1 KB page of the 64 KB flash, kept clear of code by the linker
+   configuration */
+#define BOOT_CONFIG_ADDR      (0x0800FC00u)
+#define BOOT_CONFIG_PAGE_LEN  (0x400u)
+
+/* Identifies a programmed page, and the layout of what follows. Change the
+   version whenever boot_config_t or its members change, so that a page
+   saved by older firmware is ignored rather than misread */
+#define BOOT_CONFIG_MAGIC     (0x43535645u) /* "EVSC" */
+#define BOOT_CONFIG_VERSION   (1)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Settings restored at boot. Each member is a whole number of words, as the
+   page is programmed a word at a time */
+typedef struct boot_settings_s {
+    uint8_t dvs_res;            /* dvs_res_t */
+    uint8_t dvs_fwd_pc;
+    uint8_t spinn_fwd_pc;
+    uint8_t spinn_tap_pc;
+    uint8_t spinn_fwd_rx_pc;
+    uint8_t pkt_events;
+    uint8_t policy;             /* spinn_drop_t */
+    uint8_t route_count;
+    uint16_t ack_timeout_ms;
+    uint16_t reserved;
+} boot_settings_t;
+
+typedef struct boot_pwm_s {
+    pwm_cfg_t cfg;
+    uint16_t reserved;
+} boot_pwm_t;
+
+typedef struct boot_route_s {
+    uint32_t key;
+    uint32_t mask;
+    uint8_t handler;            /* spinn_handler_t */
+    uint8_t arg;
+    uint16_t reserved;
+} boot_route_t;
+
+typedef struct boot_config_s {
+    boot_settings_t settings;
+    boot_pwm_t pwm[PWM_CHANNELS];
+    boot_route_t routes[SPINN_ROUTE_ENTRIES];
+} boot_config_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Applies saved settings, if a valid page has been saved. Call once every
+ * module has been configured and before the scheduler starts, so that the
+ * board streams as it was saved straight after any reset. Forwarding saved
+ * as on is restored without a timeout
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * true if settings were applied, false if defaults are left in place
+ */
+uint8_t boot_config_apply(void);
+
+/**
+ * DESCRIPTION
+ * Saves current resolution, forwarding, SpiNNaker link, PWM and routing
+ * settings to flash. Erasing and programming stalls the core, interrupts
+ * included, for up to 40 ms, so DVS bytes arriving meanwhile are lost
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * true if saved and read back intact, false otherwise
+ */
+uint8_t boot_config_save(void);
+
+/**
+ * DESCRIPTION
+ * Erases saved settings, so that the next boot uses defaults. Stalls the
+ * core as boot_config_save does
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * true if erased, false otherwise
+ */
+uint8_t boot_config_erase(void);
+
+#endif /* _BOOT_CONFIG_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
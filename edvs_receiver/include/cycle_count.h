@@ -0,0 +1,91 @@
+#ifndef _CYCLE_COUNT_H
+#define _CYCLE_COUNT_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Run-time counter ticks every 2^CYCLE_RUNTIME_SHIFT core cycles */
+#define CYCLE_RUNTIME_SHIFT (6)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Start TIM2 as a free-running 32-bit counter at the core clock rate
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void cycle_config(void);
+
+/**
+ * DESCRIPTION
+ * Read the free-running cycle counter. Differences between two readings are
+ * valid across a single wrap of the counter
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Current counter value in core clock cycles (uint32_t)
+ */
+uint32_t cycle_get(void);
+
+/**
+ * DESCRIPTION
+ * Read the cycle counter extended by its count of wraps, divided down by
+ * 2^CYCLE_RUNTIME_SHIFT so that it runs for 95 minutes before wrapping. Backs
+ * the FreeRTOS run-time stats, so is safe with interrupts masked
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Current counter value in units of 2^CYCLE_RUNTIME_SHIFT cycles (uint32_t)
+ */
+uint32_t cycle_get_runtime(void);
+
+/**
+ * DESCRIPTION
+ * Finds the log2 bucket of a latency for a histogram, so that bucket n holds
+ * 2^n to 2^(n+1)-1 cycles. The M0 has no count leading zeros instruction, so
+ * the bucket is found by binary search
+ * 
+ * INPUTS
+ * cycles (uint32_t) : Latency in core cycles
+ *
+ * RETURNS
+ * Index of the highest set bit, or 0 for no cycles (uint8_t)
+ */
+uint8_t cycle_log2(uint32_t cycles);
+
+#endif /* _CYCLE_COUNT_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,119 @@
+#ifndef _DVS_GEN_H
+#define _DVS_GEN_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Corner and size of the block DVS_GEN_HOT_BLOCK fires in, in pixels */
+#define DVS_GEN_BLOCK_X     (60)
+#define DVS_GEN_BLOCK_Y     (60)
+#define DVS_GEN_BLOCK_SIZE  (8)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Spread of generated events across the sensor */
+typedef enum dvs_gen_pattern_e {
+    DVS_GEN_NOISE = 0,      /* Any pixel and polarity, uniformly */
+    DVS_GEN_BAR,            /* A bar sweeping across, one column at a time */
+    DVS_GEN_HOT_BLOCK,      /* Any pixel of one small block */
+    DVS_GEN_NUM,
+} dvs_gen_pattern_t;
+
+/* Outcome of the current or last run */
+typedef struct dvs_gen_stats_s {
+    uint32_t generated;     /* events put into the DVS receive ring */
+    uint32_t lost;          /* events due while the ring was full */
+} dvs_gen_stats_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Sets up the timer which runs the generator in the FreeRTOS build. The
+ * BARE_METAL super-loop calls dvs_gen_poll itself
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void dvs_gen_config(void);
+
+/**
+ * DESCRIPTION
+ * Starts generating events into the DVS receive ring, where they are
+ * decoded as if received from the eDVS, or stops. Counts are cleared on
+ * starting. Meant for use with the eDVS disconnected, as its bytes could
+ * land between the two of a generated event
+ *
+ * INPUTS
+ * pattern (dvs_gen_pattern_t) : Pixels to generate events for
+ * rate (uint32_t) : Events per second, or 0 to stop
+ *
+ * RETURNS
+ * Nothing
+ */
+void dvs_gen_start(dvs_gen_pattern_t pattern, uint32_t rate);
+
+/**
+ * DESCRIPTION
+ * Generates the events which have fallen due since the last call. Events
+ * due while the receive ring is full are counted as lost, as bytes are by
+ * a USART overrun, so that a rate the pipeline cannot sustain shows
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void dvs_gen_poll(void);
+
+/**
+ * DESCRIPTION
+ * Retrieves whether the generator is running
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * true if running, false otherwise
+ */
+uint8_t dvs_gen_active(void);
+
+/**
+ * DESCRIPTION
+ * Retrieves counts of the current run, or of the last if stopped
+ *
+ * INPUTS
+ * p_stats (dvs_gen_stats_t*) : Filled with current counts
+ *
+ * RETURNS
+ * Nothing
+ */
+void dvs_gen_get_stats(dvs_gen_stats_t* p_stats);
+
+#endif /* _DVS_GEN_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
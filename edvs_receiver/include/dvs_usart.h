@@ -17,7 +17,18 @@
 /*******************************************************************************
  * Global Processor Definitions
  ******************************************************************************/
-/* None */
+/* Received byte ring; 5 ms of events at the full baud rate */
+#define DVS_RX_BUF_LEN      (256)
+
+/* Slots of the event store used when downscaling, and bytes of its bitmap
+   of filled slots */
+#define DVS_BUFFER_LENGTH   (350)
+#define DVS_FILLED_BYTES    ((DVS_BUFFER_LENGTH + 7) / 8)
+
+/* Static RAM of the pipeline's buffers, for the budget in task_config.h */
+#define DVS_RAM_BYTES       (DVS_RX_BUF_LEN +                             \
+                             DVS_BUFFER_LENGTH * sizeof(dvs_data_t) +     \
+                             DVS_FILLED_BYTES)
 
 /*******************************************************************************
  * Enum and Type definitions
@@ -43,6 +54,19 @@ typedef enum dvs_res_e {
     DVS_RES_16 = 3,
 } dvs_res_t;
 
+/* Counts through each stage of the pipeline. Each counter has one writer
+   and is read on its own, so a snapshot may be mid-update between them */
+typedef struct dvs_stats_s {
+    uint32_t rx_bytes;          /* bytes stored in the receive ring */
+    uint32_t rx_dropped;        /* bytes lost to a full receive ring */
+    uint32_t decoded;           /* events decoded from received bytes */
+    uint32_t filtered;          /* events removed by downscaling */
+    uint32_t sent;              /* events taken by the SpiNNaker queue */
+    uint32_t retry_dropped;     /* events dropped after retrying SpiNNaker */
+    uint16_t rx_depth;          /* bytes waiting in the receive ring */
+    uint16_t rx_high_water;     /* most bytes ever waiting */
+} dvs_stats_t;
+
 /*******************************************************************************
  * External Variable Definitions
  ******************************************************************************/
@@ -79,6 +103,18 @@ void dvs_config(void);
  */
 void dvs_forward_pc(uint8_t forward, uint16_t timeout_ms);
 
+/**
+ * DESCRIPTION
+ * Retrieves whether DVS packets are being forwarded to PC
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * true if forwarding, false otherwise
+ */
+uint8_t dvs_get_forward_pc(void);
+
 /**
  * DESCRIPTION
  * Place a simulated packet into the queue to be treated as a normal packet
@@ -91,6 +127,45 @@ void dvs_forward_pc(uint8_t forward, uint16_t timeout_ms);
  */
 void dvs_put_sim(dvs_data_t data);
 
+/**
+ * DESCRIPTION
+ * Place a simulated packet into the queue if there is room for it now
+ * 
+ * INPUTS
+ * data (dvs_data_t) : struct containing simulated data
+ *
+ * RETURNS
+ * true if queued, false if the queue was full
+ */
+uint8_t dvs_try_put_sim(dvs_data_t data);
+
+/**
+ * DESCRIPTION
+ * Runs every received event through the pipeline: decode, filter and
+ * downscale, then forward to the PC or queue for SpiNNaker. Called by the
+ * pipeline task, or by the super-loop in the BARE_METAL build, where it
+ * returns early rather than wait on a full SpiNNaker queue
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void dvs_pipe_poll(void);
+
+/**
+ * DESCRIPTION
+ * Checks whether every received byte has been through the pipeline
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * true if nothing is waiting, false otherwise
+ */
+uint8_t dvs_pipe_idle(void);
+
 /**
  * DESCRIPTION
  * Sets DVS resolution for downscaling
@@ -103,6 +178,30 @@ void dvs_put_sim(dvs_data_t data);
  */
 void dvs_set_mode(dvs_res_t res);
 
+/**
+ * DESCRIPTION
+ * Retrieves DVS resolution used for downscaling
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Current resolution mode
+ */
+dvs_res_t dvs_get_mode(void);
+
+/**
+ * DESCRIPTION
+ * Retrieves pipeline counters, without holding off the interrupt
+ * 
+ * INPUTS
+ * p_stats (dvs_stats_t*) : Filled with current counters
+ *
+ * RETURNS
+ * Nothing
+ */
+void dvs_get_stats(dvs_stats_t* p_stats);
+
 
 #endif /* _DVS_USART_H */
 
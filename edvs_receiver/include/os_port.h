@@ -0,0 +1,103 @@
+#ifndef _OS_PORT_H
+#define _OS_PORT_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+#ifdef BARE_METAL
+#include "stm32f0xx.h"
+#else
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* The few scheduler services used by code shared between the FreeRTOS build
+   and the BARE_METAL build, which runs everything from a super-loop in
+   main_bare.c and the interrupts it services */
+#ifdef BARE_METAL
+
+#define OS_FALSE                    (0)
+#define OS_TRUE                     (1)
+
+/* Nothing nests critical sections, so masking interrupts is enough */
+#define os_enter_critical()         __disable_irq()
+#define os_exit_critical()          __enable_irq()
+
+/* Interrupts always return to the super-loop */
+#define os_yield_from_isr(woken)    ((void) (woken))
+
+#else
+
+#define OS_FALSE                    pdFALSE
+#define OS_TRUE                     pdTRUE
+
+#define os_enter_critical()         taskENTER_CRITICAL()
+#define os_exit_critical()          taskEXIT_CRITICAL()
+#define os_yield_from_isr(woken)    portEND_SWITCHING_ISR(woken)
+#define os_yield()                  taskYIELD()
+#define os_delay_ms(ms)             vTaskDelay((ms) / portTICK_PERIOD_MS)
+
+#endif /* BARE_METAL */
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+#ifdef BARE_METAL
+typedef long os_base_t;
+#else
+typedef BaseType_t os_base_t;
+#endif
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+#ifdef BARE_METAL
+
+/**
+ * DESCRIPTION
+ * Runs one pass of the super-loop's polling, so that code waiting on the
+ * pipeline can let it make progress. Must not be called from the pipeline
+ *
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void os_yield(void);
+
+/**
+ * DESCRIPTION
+ * Waits by counting core cycles; interrupts, including SpiNNaker transmit,
+ * keep running
+ *
+ * INPUTS
+ * ms (uint16_t) : Time to wait in ms
+ *
+ * RETURNS
+ * Nothing
+ */
+void os_delay_ms(uint16_t ms);
+
+#endif /* BARE_METAL */
+
+#endif /* _OS_PORT_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
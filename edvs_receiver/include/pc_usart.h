@@ -20,7 +20,11 @@
 /*******************************************************************************
  * Enum and Type definitions
  ******************************************************************************/
-/* None */
+/* Bytes received from the PC, each counter written only by the interrupt */
+typedef struct pc_stats_s {
+    uint32_t rx_bytes;          /* bytes queued for the command task */
+    uint32_t rx_dropped;        /* bytes lost to a full receive queue */
+} pc_stats_t;
 
 /*******************************************************************************
  * External Variable Definitions
@@ -67,6 +71,47 @@ void pc_send_byte(uint8_t data);
  */
 void pc_send_string(char * str);
 
+/**
+ * DESCRIPTION
+ * Transmit binary frame to PC as a 2-byte big-endian length, the data, and
+ * PC_EOL, so that the PC can read data which may contain PC_EOL
+ * 
+ * INPUTS
+ * buf (uint8_t *) : Data to transmit
+ * len (uint16_t) : Number of bytes of data
+ *
+ * RETURNS
+ * Nothing
+ */
+void pc_send_frame(uint8_t * buf, uint16_t len);
+
+/**
+ * DESCRIPTION
+ * Transmit binary frame as pc_send_frame, but only if the whole frame fits
+ * in the transmit queue now. Never blocks, and the frame is queued without
+ * bytes from other tasks in between
+ * 
+ * INPUTS
+ * buf (uint8_t *) : Data to transmit
+ * len (uint16_t) : Number of bytes of data
+ *
+ * RETURNS
+ * true if frame was queued, false if there was no room
+ */
+uint8_t pc_send_frame_nb(uint8_t * buf, uint16_t len);
+
+/**
+ * DESCRIPTION
+ * Retrieves receive counters, without holding off the interrupt
+ * 
+ * INPUTS
+ * p_stats (pc_stats_t*) : Filled with current counters
+ *
+ * RETURNS
+ * Nothing
+ */
+void pc_get_stats(pc_stats_t* p_stats);
+
 #endif /* _PC_USART_H */
 
 /*******************************************************************************
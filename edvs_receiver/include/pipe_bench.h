@@ -0,0 +1,55 @@
+#ifndef _PIPE_BENCH_H
+#define _PIPE_BENCH_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Time allowed for SpiNNaker to take the last queued events before the run
+   is abandoned */
+#define PIPE_BENCH_DRAIN_MS (100)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Feeds simulated events into the DVS pipeline as fast as it takes them and
+ * times them through to the SpiNNaker link. The transmit queue rejects rather
+ * than drops events for the run, so every event is sent. Shared by the
+ * FreeRTOS and BARE_METAL builds, so that both are measured the same way
+ * 
+ * INPUTS
+ * events (uint16_t) : Number of events to send
+ *
+ * RETURNS
+ * Core clock cycles from the first event queued to the last taken for
+ * sending, or 0 if SpiNNaker stopped taking events (uint32_t)
+ */
+uint32_t pipe_bench_run(uint16_t events);
+
+#endif /* _PIPE_BENCH_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
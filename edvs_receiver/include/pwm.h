@@ -0,0 +1,118 @@
+#ifndef _PWM_H
+#define _PWM_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Channels on TIM3: channel 0 on PA6, channel 1 on PA7 */
+#define PWM_CHANNELS (2)
+
+/* Timer counts per PWM period; 20 kHz from the 48 MHz core clock */
+#define PWM_PERIOD   (2400)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Mapping of 16-bit values to compare values for a channel. The compare
+   value is offset + value * gain / 65536, clamped to min and max. When slew
+   is non-zero, the output moves towards the compare value by at most slew
+   counts per PWM period */
+typedef struct pwm_cfg_s {
+    uint16_t gain;
+    int16_t offset;
+    uint16_t min;
+    uint16_t max;
+    uint16_t slew;
+} pwm_cfg_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Configure TIM3 to output PWM on PA6 and PA7, initially off, with each
+ * channel mapping values across the full period without slew limits
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void pwm_config(void);
+
+/**
+ * DESCRIPTION
+ * Sets mapping of values for a channel. Takes effect from the next value set
+ * 
+ * INPUTS
+ * channel (uint8_t) : Channel to configure
+ * p_cfg (pwm_cfg_t*) : Scaling, limits and slew rate to use
+ *
+ * RETURNS
+ * 1 if set, 0 if channel is invalid or limits are outside the period
+ */
+uint8_t pwm_set_config(uint8_t channel, pwm_cfg_t* p_cfg);
+
+/**
+ * DESCRIPTION
+ * Retrieves mapping of values for a channel
+ * 
+ * INPUTS
+ * channel (uint8_t) : Channel to read, less than PWM_CHANNELS
+ * p_cfg (pwm_cfg_t*) : Filled with scaling, limits and slew rate
+ *
+ * RETURNS
+ * Nothing
+ */
+void pwm_get_config(uint8_t channel, pwm_cfg_t* p_cfg);
+
+/**
+ * DESCRIPTION
+ * Scales a value and writes it to the channel's compare register, or starts
+ * slewing towards it. Safe to call from any task
+ * 
+ * INPUTS
+ * channel (uint8_t) : Channel to set
+ * value (uint16_t) : Value to scale
+ *
+ * RETURNS
+ * Nothing
+ */
+void pwm_set(uint8_t channel, uint16_t value);
+
+/**
+ * DESCRIPTION
+ * Retrieves target and current compare values of a channel
+ * 
+ * INPUTS
+ * channel (uint8_t) : Channel to read
+ * p_target (uint16_t*) : Filled with compare value being moved towards
+ * p_compare (uint16_t*) : Filled with compare value being output
+ *
+ * RETURNS
+ * Nothing
+ */
+void pwm_get(uint8_t channel, uint16_t* p_target, uint16_t* p_compare);
+
+#endif /* _PWM_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,49 @@
+#ifndef _RAM_CODE_H
+#define _RAM_CODE_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Marks a function definition to run from SRAM, free of the flash wait
+   state, for code run on every symbol or received byte. The linker places
+   it in the RAMCODE block, which Reset_Handler copies from flash.
+
+   Only the bare-metal profile has the RAM to spare; the FreeRTOS build
+   already fills its share (see task_config.h), so there, on the host, and
+   with RAM_CODE_IN_FLASH defined to compare timings, it runs from flash */
+#if defined(__ICCARM__) && defined(BARE_METAL) && !defined(RAM_CODE_IN_FLASH)
+#define RAM_CODE                    _Pragma("location=\".ramcode\"")
+#else
+#define RAM_CODE
+#endif
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+/* None */
+
+#endif /* _RAM_CODE_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
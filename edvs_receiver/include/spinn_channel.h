@@ -5,29 +5,73 @@
 /*******************************************************************************
  * Global Includes
  ******************************************************************************/
-#include "FreeRTOS.h"
-#include "semphr.h"
+#include "os_port.h"
 
 /*******************************************************************************
  * Local Includes
  ******************************************************************************/
 #include "dvs_usart.h"
+#include "spinn_ring.h"
 
 /*******************************************************************************
  * Global Processor Definitions
  ******************************************************************************/
 #define SPIN_NUM_MODES (4)
 
+/* Bytes of packets mirrored to the PC batched into one frame */
+#define SPINN_TAP_BUF_LEN    (64)
+
+/* Static RAM of the transmit ring and tap frame, for the budget in
+   task_config.h */
+#define SPINN_CHANNEL_RAM_BYTES (sizeof(spinn_ring_t) + SPINN_TAP_BUF_LEN)
+
 /*******************************************************************************
  * Enum and Type definitions
  ******************************************************************************/
-/* None */
+/* State of the transmit link and its acknowledge timeouts */
+typedef struct spinn_link_stats_s {
+    uint8_t up;                 /* false while SpiNNaker is not acknowledging */
+    uint32_t packets;           /* packets sent in full */
+    uint32_t timeouts;          /* acknowledges not received in time */
+    uint32_t stalls;            /* times link has gone from up to stalled */
+    uint32_t recoveries;        /* times a stalled link has come back */
+    uint32_t abandoned;         /* packets not finished due to a stall */
+    uint32_t last_recovery_ms;  /* duration of most recent stall */
+    uint32_t max_recovery_ms;   /* duration of longest recovered stall */
+    uint32_t down_ms;           /* duration of current stall, if any */
+} spinn_link_stats_t;
+
+/* Outcome of packets received on the link */
+typedef struct spinn_rx_stats_s {
+    uint32_t packets;           /* packets decoded and routed */
+    uint32_t bad_length;        /* packets neither short nor long */
+    uint32_t bad_eop;           /* packets not ending in EOP */
+    uint32_t bad_symbol;        /* packets with a symbol not 2-of-7 */
+    uint32_t bad_parity;        /* packets failing the parity check */
+    uint32_t overruns;          /* packets with no EOP in time, discarded */
+} spinn_rx_stats_t;
+
+/* Outcome of packets looped back from the encoder to the decoder */
+typedef struct spinn_loop_stats_s {
+    uint32_t packets;           /* packets decoded as they were encoded */
+    uint32_t events;            /* events carried by those packets */
+    uint32_t errors;            /* packets failing to decode or to match */
+} spinn_loop_stats_t;
+
+/* Settings changed from the PC, other than routes and resolution */
+typedef struct spinn_settings_s {
+    uint8_t fwd_pc;             /* DVS packets sent are forwarded to PC */
+    uint8_t tap_pc;             /* Packets are copied to PC as they are sent */
+    uint8_t fwd_rx_pc;          /* Packets received are forwarded to PC */
+    uint8_t pkt_events;         /* Events which may share a packet */
+    spinn_drop_t policy;        /* Behaviour of a full transmit queue */
+    uint16_t ack_timeout_ms;    /* Acknowledge timeout, 0 for none */
+} spinn_settings_t;
 
 /*******************************************************************************
  * External Variable Definitions
  ******************************************************************************/
-extern xSemaphoreHandle xSpinnTxSemaphore;
-extern xSemaphoreHandle xSpinnRxSemaphore;
+/* None */
 
 /*******************************************************************************
  * Public Function Declarations
@@ -47,7 +91,9 @@ void spinn_config(void);
 
 /**
  * DESCRIPTION
- * Request forwarding of SpiNNaker packets to PC; replaces SpiNNaker GPIO link
+ * Request forwarding of SpiNNaker packets to PC; replaces SpiNNaker GPIO link.
+ * Packets are sent in batched frames as for spinn_tap_pc, waiting for the PC
+ * rather than dropping any
  * 
  * INPUTS
  * forward (uint8_t) : true or false of whether to forward. Resets any existing
@@ -62,15 +108,34 @@ void spinn_forward_pc(uint8_t forward, uint16_t timeout_ms);
 
 /**
  * DESCRIPTION
- * Queues DVS packet to be sent to the SpiNNaker
+ * Request mirroring of packets sent on the SpiNNaker link to PC. Packets are
+ * batched into frames of a header of packet count, packets dropped since the
+ * last frame (2 bytes) and tick of the first packet (4 bytes), then a length
+ * byte and the symbols of each packet. A batch is sent once the transmit
+ * queue empties or the batch is full, and is dropped rather than delay the
+ * link if the PC cannot take it
  * 
  * INPUTS
- * p_data (dvs_data_t*) : Pointer to struct containing data to be sent
+ * tap (uint8_t) : true or false of whether to mirror packets
  *
  * RETURNS
  * Nothing
  */
-void spinn_send_dvs(dvs_data_t* p_data);
+void spinn_tap_pc(uint8_t tap);
+
+/**
+ * DESCRIPTION
+ * Queues DVS packet to be sent to the SpiNNaker. Must only be called from a
+ * single task, as the queue has a single producer
+ * 
+ * INPUTS
+ * p_data (dvs_data_t*) : Pointer to struct containing data to be sent
+ *
+ * RETURNS
+ * false if the queue is full and rejected the packet, which the caller may
+ * offer again later, otherwise true
+ */
+uint8_t spinn_send_dvs(dvs_data_t* p_data);
 
 /**
  * DESCRIPTION
@@ -84,6 +149,97 @@ void spinn_send_dvs(dvs_data_t* p_data);
  */
 void spinn_set_mode(dvs_res_t res);
 
+/**
+ * DESCRIPTION
+ * Sets the maximum number of queued events carried by one packet. With more
+ * than one, events queued behind a busy link are sent in payload packets
+ * 
+ * INPUTS
+ * events (uint8_t) : Events per packet, 1 to SPINN_MAX_PKT_EVENTS
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_set_packing(uint8_t events);
+
+/**
+ * DESCRIPTION
+ * Sets what happens to a DVS packet sent while the transmit queue is full
+ * 
+ * INPUTS
+ * policy (spinn_drop_t) : Drop oldest, drop newest or reject
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_set_drop_policy(spinn_drop_t policy);
+
+/**
+ * DESCRIPTION
+ * Retrieves transmit queue depth, high-water mark and drop counters
+ * 
+ * INPUTS
+ * p_stats (spinn_ring_stats_t*) : Filled with current queue state
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_get_ring_stats(spinn_ring_stats_t* p_stats);
+
+/**
+ * DESCRIPTION
+ * Sets how long to wait for SpiNNaker to acknowledge a symbol before the
+ * packet is abandoned and the link treated as stalled
+ * 
+ * INPUTS
+ * timeout_ms (uint16_t) : Timeout in ms, or 0 to wait forever
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_set_ack_timeout(uint16_t timeout_ms);
+
+/**
+ * DESCRIPTION
+ * Retrieves forwarding flags, packing, drop policy and acknowledge timeout,
+ * as set by the functions above
+ * 
+ * INPUTS
+ * p_settings (spinn_settings_t*) : Filled with current settings
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_get_settings(spinn_settings_t* p_settings);
+
+/**
+ * DESCRIPTION
+ * Retrieves transmit link state, stall counters and recovery times, which
+ * tell a slow SpiNNaker (short, frequent stalls) from a dead one (a stall
+ * which does not recover)
+ * 
+ * INPUTS
+ * p_stats (spinn_link_stats_t*) : Filled with current link state
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_get_link_stats(spinn_link_stats_t* p_stats);
+
+/**
+ * DESCRIPTION
+ * Retrieves counts of received packets and of those rejected, by reason,
+ * optionally clearing them in the same step
+ * 
+ * INPUTS
+ * p_stats (spinn_rx_stats_t*) : Filled with current counts
+ * reset (uint8_t) : Clear counts after copying if true
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_get_rx_stats(spinn_rx_stats_t* p_stats, uint8_t reset);
+
 /**
  * DESCRIPTION
  * Request forwarding of received data from PC
@@ -101,17 +257,89 @@ void spinn_forward_rx_pc(uint8_t forward, uint16_t timeout_ms);
 
 /**
  * DESCRIPTION
- * Given a pointer to a buffer containing a SpiNNaker packet, either forwards
- * data over UART or sets motor PWM signal period
+ * Given a pointer to a buffer containing a SpiNNaker packet, looks up the
+ * route for its key and applies its value, either forwarding it over UART or
+ * driving an output. Packets which fail decoding are counted by reason and
+ * dropped, as are packets which match no route
  * 
  * INPUTS
  * buf (uint8_t*) : Buffer containing SpiNNaker packet data
+ * len (uint8_t) : Number of symbols in buffer, including EOP
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_use_data(uint8_t *buf, uint8_t len);
+
+/**
+ * DESCRIPTION
+ * Sets whether packets are looped back in place of being sent on the link.
+ * Each packet is decoded straight after encoding, checked against the
+ * events it was encoded from and, in the FreeRTOS build, routed as if
+ * received, so that the codec can be exercised and timed with nothing
+ * connected. Counts are cleared on enabling
+ * 
+ * INPUTS
+ * loopback (uint8_t) : true to loop packets back, false to use the link
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_set_loopback(uint8_t loopback);
+
+/**
+ * DESCRIPTION
+ * Retrieves counts of packets looped back since loopback was enabled
+ * 
+ * INPUTS
+ * p_stats (spinn_loop_stats_t*) : Filled with current counts
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_get_loop_stats(spinn_loop_stats_t* p_stats);
+
+/**
+ * DESCRIPTION
+ * Signals the transmit task that SpiNNaker has acknowledged the last symbol.
+ * Interrupt context only
+ * 
+ * INPUTS
+ * p_woken (os_base_t*) : Set to OS_TRUE if a context switch is required
  *
  * RETURNS
  * Nothing
  */
-void spinn_use_data(uint8_t *buf);
+void spinn_tx_ack_from_isr(os_base_t* p_woken);
 
+/**
+ * DESCRIPTION
+ * Signals the receive task that a data pin has changed. Interrupt context
+ * only
+ * 
+ * INPUTS
+ * p_woken (os_base_t*) : Set to OS_TRUE if a context switch is required
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_rx_edge_from_isr(os_base_t* p_woken);
+
+#ifdef BARE_METAL
+/**
+ * DESCRIPTION
+ * Starts sending queued packets if the link is idle, and abandons a packet
+ * which SpiNNaker has stopped acknowledging. Called from the super-loop in
+ * place of the transmit task
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_poll(void);
+#endif
 
 #endif /* _SPINN_CHANNEL_H */
 
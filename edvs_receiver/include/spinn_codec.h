@@ -0,0 +1,175 @@
+#ifndef _SPINN_CODEC_H
+#define _SPINN_CODEC_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "dvs_usart.h"
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Number of symbols in short (no payload) and long (payload) packets */
+#define SPINN_SHORT_SYMS (11)
+#define SPINN_LONG_SYMS  (19)
+
+/* Number of entries in 2-of-7 symbol table; last entry is end of packet */
+#define SPINN_NUM_SYMS   (17)
+#define SPINN_EOP_IDX    (16)
+#define SPINN_SYM_EOP    (0x60)
+
+/* Control bit in first header symbol marking a packet with payload */
+#define SPINN_CTRL_PAYLOAD (0x02)
+
+/* Events carried by a payload packet: one in the key, two in the payload */
+#define SPINN_MAX_PKT_EVENTS (3)
+
+/* Mapped events always have the top bit set, so an empty payload slot can
+   be told apart from an event */
+#define SPINN_EVENT_VALID  (0x8000)
+
+/* Virtual chip address used as upper half of every routing key */
+#define SPINN_CHIP_ADDRESS (0x0200)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Result of decoding a received packet */
+typedef enum spinn_decode_e {
+    SPINN_DECODE_OK = 0,
+    SPINN_DECODE_BAD_LENGTH,
+    SPINN_DECODE_BAD_EOP,
+    SPINN_DECODE_BAD_SYMBOL,
+    SPINN_DECODE_BAD_PARITY,
+} spinn_decode_t;
+
+/* Contents of a decoded packet */
+typedef struct spinn_packet_s {
+    uint32_t key;
+    uint32_t payload;
+    uint8_t has_payload;
+} spinn_packet_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* Symbol encoding table for 2-of-7 format, indexed by nibble value */
+extern const uint8_t spinn_codec_symbols[SPINN_NUM_SYMS];
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Sets the chip address placed in every packet, precomputing the packet tail
+ * symbols and the address contribution to packet parity
+ *
+ * INPUTS
+ * address (uint16_t) : Virtual chip address, upper 16 bits of the key
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_codec_set_address(uint16_t address);
+
+/**
+ * DESCRIPTION
+ * Sets resolution used when mapping DVS events to keys
+ *
+ * INPUTS
+ * res (dvs_res_t) : Resolution to map events into
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_codec_set_mode(dvs_res_t res);
+
+/**
+ * DESCRIPTION
+ * Maps a DVS event to the lower 16 bits of a routing key at the current
+ * resolution
+ *
+ * INPUTS
+ * p_data (dvs_data_t*) : Event to be mapped
+ *
+ * RETURNS
+ * Mapped event (uint16_t)
+ */
+uint16_t spinn_codec_map_event(dvs_data_t* p_data);
+
+/**
+ * DESCRIPTION
+ * Encodes a mapped event as a short packet of 2-of-7 symbols using the
+ * precomputed header and tail
+ *
+ * INPUTS
+ * event (uint16_t) : Mapped event from spinn_codec_map_event
+ * p_pkt (uint8_t*) : Buffer of at least SPINN_SHORT_SYMS bytes to fill
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_codec_encode_event(uint16_t event, uint8_t* p_pkt);
+
+/**
+ * DESCRIPTION
+ * Encodes between 1 and SPINN_MAX_PKT_EVENTS mapped events as one packet. A
+ * single event gives a short packet; otherwise the first event is placed in
+ * the key and the rest in the payload, lower half first, so that routing on
+ * the key is unchanged and unused payload halves are zero
+ *
+ * INPUTS
+ * p_events (uint16_t*) : Mapped events from spinn_codec_map_event
+ * count (uint8_t) : Number of events to encode
+ * p_pkt (uint8_t*) : Buffer of at least SPINN_LONG_SYMS bytes to fill
+ *
+ * RETURNS
+ * Number of symbols in encoded packet (uint8_t)
+ */
+uint8_t spinn_codec_encode_events(uint16_t* p_events, uint8_t count,
+                                  uint8_t* p_pkt);
+
+/**
+ * DESCRIPTION
+ * Decodes and validates a whole packet of 2-of-7 symbols in a single pass,
+ * checking length, EOP, symbol validity, payload flag and odd parity
+ *
+ * INPUTS
+ * p_syms (uint8_t*) : Received symbols, including EOP
+ * len (uint8_t) : Number of symbols received
+ * p_pkt (spinn_packet_t*) : Filled with key and payload if packet is valid
+ *
+ * RETURNS
+ * SPINN_DECODE_OK if packet is valid, otherwise reason for rejection
+ */
+spinn_decode_t spinn_codec_decode(uint8_t* p_syms, uint8_t len,
+                                  spinn_packet_t* p_pkt);
+
+/**
+ * DESCRIPTION
+ * Checks a decoded packet carries exactly the events it was encoded from,
+ * at the current chip address, for validating an encode and decode round
+ * trip
+ *
+ * INPUTS
+ * p_pkt (spinn_packet_t const *) : Packet decoded by spinn_codec_decode
+ * p_events (uint16_t const *) : Events given to spinn_codec_encode_events
+ * count (uint8_t) : Number of events
+ *
+ * RETURNS
+ * true if the packet matches, false otherwise
+ */
+uint8_t spinn_codec_matches(spinn_packet_t const * p_pkt,
+                            uint16_t const * p_events, uint8_t count);
+
+#endif /* _SPINN_CODEC_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,185 @@
+#ifndef _SPINN_LINK_H
+#define _SPINN_LINK_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Histogram bucket n counts latencies of 2^n to 2^(n+1)-1 core cycles, with
+   the last bucket also counting anything longer */
+#define SPINN_HIST_BUCKETS (16)
+
+/* Static RAM of the histograms, for the budget in task_config.h */
+#define SPINN_LINK_RAM_BYTES (SPINN_HIST_NUM * SPINN_HIST_BUCKETS *       \
+                              sizeof(uint32_t))
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Latency histograms kept by the link */
+typedef enum spinn_hist_e {
+    SPINN_HIST_TX_ACK = 0,  /* TX symbol written to its acknowledge edge */
+    SPINN_HIST_RX_SYM,      /* RX acknowledge written to next symbol edge */
+    SPINN_HIST_NUM,
+} spinn_hist_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Configure GPIOB pins and external interrupts for the SpiNNaker link. TX
+ * data is on pins 0-6 with its acknowledge in on pin 7, RX data is on pins
+ * 8-14 with its acknowledge out on pin 15
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_config(void);
+
+/**
+ * DESCRIPTION
+ * Transmits a symbol by toggling the TX data pins it selects. Only TX data
+ * pins are written, in a single BSRR store, so this cannot disturb the RX
+ * acknowledge. TX side only
+ * 
+ * INPUTS
+ * sym (uint8_t) : 2-of-7 symbol to transmit
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_tx_sym(uint8_t sym);
+
+/**
+ * DESCRIPTION
+ * Takes the TX data pin output state as the reference for the next symbol.
+ * TX side only
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_tx_resync(void);
+
+/**
+ * DESCRIPTION
+ * Reads the RX data pins and returns which have changed since the last read
+ * or resync. RX side only
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Received symbol (uint8_t)
+ */
+uint8_t spinn_link_rx_sym(void);
+
+/**
+ * DESCRIPTION
+ * Takes the current RX data pin state as the reference for the next symbol.
+ * RX side only
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_rx_resync(void);
+
+/**
+ * DESCRIPTION
+ * Acknowledges a received symbol by toggling the RX acknowledge pin in a
+ * single BSRR or BRR store, so this cannot disturb the TX data pins. RX side
+ * only
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_rx_ack(void);
+
+/**
+ * DESCRIPTION
+ * Marks the RX side idle after an end of packet, so that the wait for the
+ * next packet is not counted as symbol spacing. RX side only
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_rx_idle(void);
+
+/**
+ * DESCRIPTION
+ * Records the TX acknowledge latency of the last symbol written. Called from
+ * the TX acknowledge interrupt
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_tx_ack_isr(void);
+
+/**
+ * DESCRIPTION
+ * Records the time from the last RX acknowledge to the first edge of the
+ * next symbol. Called from the RX data interrupts; later edges of the same
+ * symbol are ignored
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_rx_edge_isr(void);
+
+/**
+ * DESCRIPTION
+ * Copies a latency histogram, optionally clearing it in the same step so
+ * that no sample is lost or counted twice
+ * 
+ * INPUTS
+ * hist (spinn_hist_t) : Histogram to copy
+ * p_counts (uint32_t*) : Filled with SPINN_HIST_BUCKETS counts
+ * reset (uint8_t) : Clear histogram after copying if true
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_link_get_hist(spinn_hist_t hist, uint32_t* p_counts, 
+                         uint8_t reset);
+
+#endif /* _SPINN_LINK_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
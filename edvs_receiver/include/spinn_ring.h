@@ -0,0 +1,163 @@
+#ifndef _SPINN_RING_H
+#define _SPINN_RING_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Number of slots in the ring; must be a power of two. One slot is kept as a
+   guard so that at most SPINN_RING_CAPACITY events are ever queued */
+#define SPINN_RING_SIZE     (128)
+#define SPINN_RING_MASK     (SPINN_RING_SIZE - 1)
+#define SPINN_RING_CAPACITY (SPINN_RING_SIZE - 1)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Behaviour when an event is pushed into a full ring */
+typedef enum spinn_drop_e {
+    SPINN_DROP_OLDEST = 0,  /* Overwrite oldest unsent event */
+    SPINN_DROP_NEWEST,      /* Discard the event being pushed */
+    SPINN_DROP_REJECT,      /* Refuse the event and hand it back to caller */
+    SPINN_DROP_NUM,
+} spinn_drop_t;
+
+/* Result of pushing an event */
+typedef enum spinn_push_e {
+    SPINN_PUSH_OK = 0,
+    SPINN_PUSH_DROPPED,
+    SPINN_PUSH_REJECTED,
+} spinn_push_t;
+
+/* Single-producer/single-consumer ring of mapped events. Each index and
+   counter has exactly one writer and is a single aligned store, so the ring
+   needs no locks or critical sections: head, high_water, dropped and rejected
+   are written by the producer, tail and overwritten by the consumer. Indices
+   run freely and are only masked on access, so they are 32 bits wide to keep
+   the distance between them exact however far the producer runs ahead */
+typedef struct spinn_ring_s {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint16_t buf[SPINN_RING_SIZE];
+    volatile uint16_t high_water;
+    volatile uint32_t overwritten;
+    volatile uint32_t dropped;
+    volatile uint32_t rejected;
+    volatile spinn_drop_t policy;
+} spinn_ring_t;
+
+/* Snapshot of ring state for reporting */
+typedef struct spinn_ring_stats_s {
+    spinn_drop_t policy;
+    uint16_t depth;
+    uint16_t high_water;
+    uint32_t overwritten;
+    uint32_t dropped;
+    uint32_t rejected;
+} spinn_ring_stats_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Empties ring and clears its counters. Must not be called while either the
+ * producer or the consumer may be using the ring
+ *
+ * INPUTS
+ * p_ring (spinn_ring_t*) : Ring to initialise
+ * policy (spinn_drop_t) : Behaviour when ring is full
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_ring_init(spinn_ring_t* p_ring, spinn_drop_t policy);
+
+/**
+ * DESCRIPTION
+ * Changes behaviour when ring is full; takes effect from the next push
+ *
+ * INPUTS
+ * p_ring (spinn_ring_t*) : Ring to modify
+ * policy (spinn_drop_t) : Behaviour when ring is full
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_ring_set_policy(spinn_ring_t* p_ring, spinn_drop_t policy);
+
+/**
+ * DESCRIPTION
+ * Adds an event to the ring. Producer side only
+ *
+ * INPUTS
+ * p_ring (spinn_ring_t*) : Ring to add to
+ * event (uint16_t) : Event to add
+ *
+ * RETURNS
+ * SPINN_PUSH_OK if queued, possibly over the oldest event, SPINN_PUSH_DROPPED
+ * if discarded, or SPINN_PUSH_REJECTED if the caller still owns the event
+ */
+spinn_push_t spinn_ring_push(spinn_ring_t* p_ring, uint16_t event);
+
+/**
+ * DESCRIPTION
+ * Copies the oldest event out of the ring and removes it. Consumer side only.
+ * Events overwritten by the producer before or while being copied are
+ * skipped and counted, so a returned event is never partially overwritten
+ *
+ * INPUTS
+ * p_ring (spinn_ring_t*) : Ring to take from
+ * p_event (uint16_t*) : Filled with event if one was available
+ *
+ * RETURNS
+ * 1 if an event was returned, 0 if ring was empty
+ */
+uint8_t spinn_ring_pop(spinn_ring_t* p_ring, uint16_t* p_event);
+
+/**
+ * DESCRIPTION
+ * Checks whether the ring holds any events. Consumer side only, as the
+ * producer may add an event at any time
+ *
+ * INPUTS
+ * p_ring (spinn_ring_t*) : Ring to check
+ *
+ * RETURNS
+ * 1 if ring is empty, otherwise 0
+ */
+uint8_t spinn_ring_empty(spinn_ring_t* p_ring);
+
+/**
+ * DESCRIPTION
+ * Takes a snapshot of ring depth and counters; safe from any task
+ *
+ * INPUTS
+ * p_ring (spinn_ring_t*) : Ring to report on
+ * p_stats (spinn_ring_stats_t*) : Filled with current state
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_ring_get_stats(spinn_ring_t* p_ring, spinn_ring_stats_t* p_stats);
+
+#endif /* _SPINN_RING_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,153 @@
+#ifndef _SPINN_ROUTE_H
+#define _SPINN_ROUTE_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Maximum number of routes */
+#define SPINN_ROUTE_ENTRIES   (8)
+
+/* Routes are looked up by these bits of the key, the low 4 bits of the chip
+   address; the rest of the key is then checked against the route. With at
+   most 8 routes, a wider table would narrow the search little for its RAM */
+#define SPINN_ROUTE_SHIFT     (16)
+#define SPINN_ROUTE_LUT_SIZE  (16)
+
+/* Static RAM of the route table and its lookup of one byte per entry, for
+   the budget in task_config.h */
+#define SPINN_ROUTE_RAM_BYTES (SPINN_ROUTE_ENTRIES * sizeof(spinn_route_t) + \
+                               SPINN_ROUTE_LUT_SIZE)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Action taken on a packet matching a route */
+typedef enum spinn_handler_e {
+    SPINN_HANDLER_PC = 0,   /* Forward value to PC if enabled */
+    SPINN_HANDLER_PWM,      /* Set PWM channel arg to value */
+    SPINN_HANDLER_GPIO,     /* Set GPIOA pin arg high if value is non-zero */
+    SPINN_HANDLER_COUNTER,  /* Only count matching packets */
+    SPINN_HANDLER_NUM,
+} spinn_handler_t;
+
+/* A route matches keys where (key & mask) == key of route. The value of a
+   packet is the lower half of its key */
+typedef struct spinn_route_s {
+    uint32_t key;
+    uint32_t mask;
+    spinn_handler_t handler;
+    uint8_t arg;
+    uint16_t last_value;
+    uint32_t hits;
+} spinn_route_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Configure GPIO route outputs and install the default route, which
+ * forwards every packet to the PC
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_route_config(void);
+
+/**
+ * DESCRIPTION
+ * Adds a route below any existing routes, other than catch-all routes with a
+ * mask of 0, which stay below every other route. Where routes overlap, the
+ * first in the table matches. A route which a route above would match in
+ * every case can never be reached, so is refused
+ * 
+ * INPUTS
+ * key (uint32_t) : Key to match after masking
+ * mask (uint32_t) : Bits of key to match
+ * handler (spinn_handler_t) : Action for matching packets
+ * arg (uint8_t) : PWM channel or GPIOA pin number; ignored otherwise
+ *
+ * RETURNS
+ * 1 if added, 0 if table is full, handler or arg is invalid, or the route
+ * could never be reached
+ */
+uint8_t spinn_route_add(uint32_t key, uint32_t mask, spinn_handler_t handler,
+                        uint8_t arg);
+
+/**
+ * DESCRIPTION
+ * Removes all routes, so that received packets are dropped
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+void spinn_route_clear(void);
+
+/**
+ * DESCRIPTION
+ * Finds the first route matching a key, records the packet against it and
+ * applies its value for PWM, GPIO and counter routes. PC routes are only
+ * recorded, forwarding is left to the caller. Packets matching no route are
+ * counted. Tasks only, as routes may be changed meanwhile by other tasks
+ * 
+ * INPUTS
+ * key (uint32_t) : Key of received packet
+ * p_handler (spinn_handler_t*) : Set to the handler of the matching route
+ *
+ * RETURNS
+ * 1 if a route matched, otherwise 0
+ */
+uint8_t spinn_route_dispatch(uint32_t key, spinn_handler_t* p_handler);
+
+/**
+ * DESCRIPTION
+ * Retrieves a route and its counters by position in the table
+ * 
+ * INPUTS
+ * idx (uint8_t) : Position of route
+ * p_route (spinn_route_t*) : Filled with route if it exists
+ *
+ * RETURNS
+ * 1 if route exists, otherwise 0
+ */
+uint8_t spinn_route_get(uint8_t idx, spinn_route_t* p_route);
+
+/**
+ * DESCRIPTION
+ * Retrieves number of received packets matching no route
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Count of unrouted packets (uint32_t)
+ */
+uint32_t spinn_route_misses(void);
+
+#endif /* _SPINN_ROUTE_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,118 @@
+#ifndef _TASK_CONFIG_H
+#define _TASK_CONFIG_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "FreeRTOS.h"
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* Modules owning the largest buffers, for their RAM sizes */
+#include "dvs_usart.h"
+#include "spinn_channel.h"
+#include "spinn_route.h"
+#include "spinn_link.h"
+#include "trace.h"
+#include "wake_stats.h"
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Every RTOS object is statically allocated by the module which uses it,
+   sized from here so that the whole allocation can be checked against the
+   RAM budget at compile time */
+
+/* Task names */
+#define PC_TX_TASK_NAME          "PC_Tx"
+#define PC_RX_TASK_NAME          "PC_Rx"
+#define DVS_PIPE_TASK_NAME       "DVS_Pipe"
+#define SPINN_TX_TASK_NAME       "txSpn"
+#define SPINN_RX_TASK_NAME       "rxSpn"
+
+/* Task stack depths in words */
+#define PC_TX_STACK_WORDS        (configMINIMAL_STACK_SIZE)
+/* PC_Rx builds response frames on its stack, the telemetry frame being the
+   deepest */
+#define PC_RX_STACK_WORDS        (configMINIMAL_STACK_SIZE + 64)
+#define DVS_PIPE_STACK_WORDS     (configMINIMAL_STACK_SIZE + 40)
+/* txSpn routes looped back packets one call deeper than rxSpn routes
+   received ones */
+#define SPINN_TX_STACK_WORDS     (configMINIMAL_STACK_SIZE + 8)
+#define SPINN_RX_STACK_WORDS     (configMINIMAL_STACK_SIZE)
+#define IDLE_STACK_WORDS         (configMINIMAL_STACK_SIZE)
+#define TIMER_STACK_WORDS        (configTIMER_TASK_STACK_DEPTH)
+
+#define TASK_STACK_WORDS         (PC_TX_STACK_WORDS + PC_RX_STACK_WORDS + \
+                                  DVS_PIPE_STACK_WORDS +                  \
+                                  SPINN_TX_STACK_WORDS +                  \
+                                  SPINN_RX_STACK_WORDS +                  \
+                                  IDLE_STACK_WORDS + TIMER_STACK_WORDS)
+
+/* Queue lengths in items */
+#define PC_TXQ_LENGTH            (96)   /* Bytes; room for a whole tap frame */
+#define PC_RXQ_LENGTH            (40)   /* Bytes */
+
+/* Bytes of queue storage, including the timer command queue, of which each
+   item is a 4-byte command and up to 12 bytes of parameters */
+#define TIMER_CMD_BYTES          (16)
+#define QUEUE_STORAGE_BYTES      (PC_TXQ_LENGTH + PC_RXQ_LENGTH +         \
+                                  configTIMER_QUEUE_LENGTH * TIMER_CMD_BYTES)
+
+/* Object counts; tasks include idle and timer, queues include semaphores,
+   one of which is only used by benchmarks, and the timer command queue */
+#define TASK_COUNT               (7)
+#define QUEUE_COUNT              (5)
+#define TIMER_COUNT              (5)
+
+/* RAM budget: the main stack, used before the scheduler starts and by
+   interrupts, must match __ICFEDIT_size_cstack__ in the linker file. The
+   application share is summed from the sizes of the buffers themselves,
+   each given by its module: the DVS receive ring and event store, the
+   SpiNNaker transmit ring and tap frame, the route table, the link and
+   wake histograms and the trace ring. Counters, flags and other small
+   statics of every module, 303 bytes when last measured, come out of a
+   fixed allowance */
+#define RAM_SIZE_BYTES           (8192)
+#define RAM_CSTACK_BYTES         (0x400)
+#define RAM_APP_OTHER_BYTES      (320)
+#define RAM_APP_BYTES            (DVS_RAM_BYTES + SPINN_CHANNEL_RAM_BYTES +  \
+                                  SPINN_ROUTE_RAM_BYTES +                   \
+                                  SPINN_LINK_RAM_BYTES + WAKE_RAM_BYTES +   \
+                                  TRACE_RAM_BYTES + RAM_APP_OTHER_BYTES)
+#define RAM_RTOS_BUDGET_BYTES    (RAM_SIZE_BYTES - RAM_CSTACK_BYTES - \
+                                  RAM_APP_BYTES)
+
+/* Kernel variables of tasks.c, queue.c and timers.c, such as the ready
+   lists and queue registry, for this configuration of FreeRTOS V9 */
+#define RTOS_KERNEL_BYTES        (464)
+
+/* RAM taken by RTOS objects; not usable in #if as it depends on sizeof */
+#define RAM_RTOS_BYTES           (TASK_STACK_WORDS * sizeof(StackType_t) +  \
+                                  TASK_COUNT * sizeof(StaticTask_t) +       \
+                                  QUEUE_COUNT * sizeof(StaticQueue_t) +     \
+                                  QUEUE_STORAGE_BYTES +                     \
+                                  TIMER_COUNT * sizeof(StaticTimer_t) +     \
+                                  RTOS_KERNEL_BYTES)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+/* None */
+
+#endif /* _TASK_CONFIG_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,77 @@
+#ifndef _TELEMETRY_H
+#define _TELEMETRY_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Health of the whole board in one place, in pipeline order. Every count is
+   cumulative from boot, except the receive packet counts which the PC can
+   clear with espn */
+typedef struct telemetry_s {
+    uint32_t uptime_ms;
+    uint32_t pc_rx_bytes;       /* bytes received from the PC */
+    uint32_t pc_rx_dropped;     /* PC bytes lost to a full queue */
+    uint32_t dvs_rx_bytes;      /* bytes received from the eDVS */
+    uint32_t dvs_rx_dropped;    /* eDVS bytes lost to a full ring */
+    uint32_t decoded;           /* events decoded */
+    uint32_t filtered;          /* events removed by downscaling */
+    uint32_t queued;            /* events taken by the SpiNNaker queue */
+    uint32_t retry_dropped;     /* events the SpiNNaker queue never took */
+    uint32_t tx_overwritten;    /* queued events overwritten when full */
+    uint32_t tx_dropped;        /* events dropped by a full queue */
+    uint32_t tx_rejected;       /* events refused by a full queue */
+    uint32_t tx_packets;        /* packets sent in full */
+    uint32_t tx_abandoned;      /* packets cut short by a stall */
+    uint32_t link_timeouts;     /* acknowledges not received in time */
+    uint32_t link_stalls;       /* times the link has stalled */
+    uint32_t rx_packets;        /* packets received and routed */
+    uint32_t rx_errors;         /* packets received and discarded */
+    uint32_t route_misses;      /* packets matching no route */
+    uint16_t dvs_rx_high_water; /* most eDVS bytes ever waiting */
+    uint16_t tx_high_water;     /* most events ever queued for SpiNNaker */
+    uint8_t link_up;            /* false while SpiNNaker is not acknowledging */
+} telemetry_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Collects every module's counters into one block. Counters are read as
+ * their single writers update them, without holding off interrupts, so the
+ * block may be mid-update between counters
+ *
+ * INPUTS
+ * p_telem (telemetry_t*) : Filled with current counters
+ *
+ * RETURNS
+ * Nothing
+ */
+void telemetry_get(telemetry_t* p_telem);
+
+#endif /* _TELEMETRY_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,136 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Records held; must be a power of two. Once full, the oldest records are
+   overwritten, so the ring always holds the run up to when it was stopped */
+#define TRACE_RECORDS     (32)
+#define TRACE_MASK        (TRACE_RECORDS - 1)
+
+/* Bytes per record as sent to the PC */
+#define TRACE_RECORD_LEN  (8)
+
+/* Static RAM of the ring, for the budget in task_config.h */
+#define TRACE_RAM_BYTES   (TRACE_RECORDS * sizeof(trace_rec_t))
+
+/* Mask of every record type, for trace_start */
+#define TRACE_ALL         ((1u << TRACE_NUM) - 1)
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Types of record, with what their tag and value hold */
+typedef enum trace_id_e {
+    TRACE_ISR_ENTER = 0,    /* tag: IRQ number */
+    TRACE_ISR_EXIT,         /* tag: IRQ number */
+    TRACE_QUEUE_SEND,       /* tag: trace_queue_t, value: item queued */
+    TRACE_QUEUE_RECV,       /* tag: trace_queue_t, value: item taken */
+    TRACE_EVENT_DECODED,    /* tag: polarity, value: y << 8 | x */
+    TRACE_PACKET_QUEUED,    /* tag: events carried, value: symbols; packet
+                               handed to the link */
+    TRACE_SYMBOL_ACKED,     /* value: cycles from symbol to acknowledge,
+                               saturated at 0xFFFF */
+    TRACE_DROP,             /* tag: trace_drop_t, value: item lost */
+    TRACE_NUM,
+} trace_id_t;
+
+/* Queues traced by TRACE_QUEUE_SEND and TRACE_QUEUE_RECV */
+typedef enum trace_queue_e {
+    TRACE_Q_DVS_RX = 0,     /* Bytes from the eDVS */
+    TRACE_Q_SPINN_TX,       /* Mapped events for SpiNNaker */
+} trace_queue_t;
+
+/* Where a TRACE_DROP record was lost */
+typedef enum trace_drop_e {
+    TRACE_DROP_DVS_RX = 0,  /* DVS receive ring full */
+    TRACE_DROP_DVS_RETRY,   /* SpiNNaker queue refused the event too often */
+    TRACE_DROP_SPINN_TX,    /* SpiNNaker queue full, dropping newest */
+} trace_drop_t;
+
+/* One record, time-stamped in core cycles */
+typedef struct trace_rec_s {
+    uint32_t cycles;
+    uint8_t id;
+    uint8_t tag;
+    uint16_t value;
+} trace_rec_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Empties the ring and starts recording the selected types of record
+ * 
+ * INPUTS
+ * mask (uint16_t) : Bit n set to record trace_id_t n, or TRACE_ALL
+ *
+ * RETURNS
+ * Nothing
+ */
+void trace_start(uint16_t mask);
+
+/**
+ * DESCRIPTION
+ * Stops recording, so that the ring can be read
+ * 
+ * INPUTS
+ * p_lost (uint32_t*) : Filled with records overwritten since the start
+ *
+ * RETURNS
+ * Number of records held (uint16_t)
+ */
+uint16_t trace_stop(uint32_t* p_lost);
+
+/**
+ * DESCRIPTION
+ * Adds a record if its type is being recorded. Safe from any context,
+ * including with interrupts masked
+ * 
+ * INPUTS
+ * id (trace_id_t) : Type of record
+ * tag (uint8_t) : Record detail, as listed for its type
+ * value (uint16_t) : Record value, as listed for its type
+ *
+ * RETURNS
+ * Nothing
+ */
+void trace_rec(trace_id_t id, uint8_t tag, uint16_t value);
+
+/**
+ * DESCRIPTION
+ * Copies a record out of a stopped ring
+ * 
+ * INPUTS
+ * idx (uint16_t) : Record to copy, oldest first, below the count from
+ *                  trace_stop
+ * p_rec (trace_rec_t*) : Filled with the record
+ *
+ * RETURNS
+ * Nothing
+ */
+void trace_get(uint16_t idx, trace_rec_t* p_rec);
+
+#endif /* _TRACE_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
@@ -0,0 +1,94 @@
+#ifndef _WAKE_STATS_H
+#define _WAKE_STATS_H
+
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+#include "os_port.h"
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Processor Definitions
+ ******************************************************************************/
+/* Histogram bucket n counts latencies of 2^n to 2^(n+1)-1 core cycles, with
+   the last bucket also counting anything longer. At 48 MHz the last bucket
+   starts at 0.68 ms, so a wake left for the next tick lands in it */
+#define WAKE_HIST_BUCKETS (16)
+
+/* Static RAM of the histograms, for the budget in task_config.h */
+#define WAKE_RAM_BYTES    (WAKE_NUM * WAKE_HIST_BUCKETS * sizeof(uint32_t))
+
+/*******************************************************************************
+ * Enum and Type definitions
+ ******************************************************************************/
+/* Interrupts which wake a task, each timed from the interrupt to the task */
+typedef enum wake_src_e {
+    WAKE_DVS_RX = 0,        /* DVS USART byte to DVS_Pipe */
+    WAKE_PC_RX,             /* PC USART byte to PC_Rx */
+    WAKE_SPINN_TX_ACK,      /* SpiNNaker acknowledge edge to txSpn */
+    WAKE_SPINN_RX_EDGE,     /* SpiNNaker data edge to rxSpn */
+    WAKE_NUM,
+} wake_src_t;
+
+/*******************************************************************************
+ * External Variable Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Declarations
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Stamps an interrupt which has unblocked a task, to be timed when that task
+ * next calls wake_task_record. Interrupt context only
+ *
+ * INPUTS
+ * src (wake_src_t) : Interrupt source
+ * woken (os_base_t)  : Result of the FromISR call; nothing is stamped unless
+ *                      it woke a higher priority task
+ *
+ * RETURNS
+ * Nothing
+ */
+void wake_isr_stamp(wake_src_t src, os_base_t woken);
+
+/**
+ * DESCRIPTION
+ * Counts the time since the interrupt which woke the calling task, if it was
+ * stamped. Call straight after the blocking call returns
+ *
+ * INPUTS
+ * src (wake_src_t) : Interrupt source
+ *
+ * RETURNS
+ * Nothing
+ */
+void wake_task_record(wake_src_t src);
+
+/**
+ * DESCRIPTION
+ * Copies a wake latency histogram, optionally clearing it in the same step
+ *
+ * INPUTS
+ * src (wake_src_t) : Histogram to copy
+ * p_counts (uint32_t*) : Filled with WAKE_HIST_BUCKETS counts
+ * reset (uint8_t) : Clear histogram after copying if true
+ *
+ * RETURNS
+ * Nothing
+ */
+void wake_get_hist(wake_src_t src, uint32_t* p_counts, uint8_t reset);
+
+#endif /* _WAKE_STATS_H */
+
+/*******************************************************************************
+ * End of File
+ ******************************************************************************/
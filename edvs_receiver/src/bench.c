@@ -0,0 +1,334 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "bench.h"
+#include "cycle_count.h"
+#include "spinn_codec.h"
+#include "dvs_usart.h"
+#include "pipe_bench.h"
+#include "trace.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Output of benchmarked code, kept so that it is not optimised away */
+static volatile uint8_t bench_sink[SPINN_LONG_SYMS];
+
+/* Flag read by the flag benchmarks, and semaphore used by the benchmarks of
+   the semaphore-based signalling and locking which has been replaced */
+static volatile uint8_t bench_flag = 0;
+static StaticSemaphore_t bench_sem_obj;
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static void bench_encode(uint16_t iterations);
+static void bench_encode_ref(uint16_t iterations);
+static void bench_decode(uint16_t iterations);
+static void bench_signal_sem(uint16_t iterations);
+static void bench_signal_notify(uint16_t iterations);
+static void bench_flag_sem(uint16_t iterations);
+static void bench_flag_atomic(uint16_t iterations);
+static void bench_trace(uint16_t iterations);
+static void encode_reference(dvs_data_t* p_data, uint8_t* p_pkt);
+
+/*******************************************************************************
+ * Public Function Definitions 
+ ******************************************************************************/
+uint32_t bench_run(bench_id_t id, uint16_t iterations)
+{
+    uint32_t start = cycle_get();
+
+    switch (id)
+    {
+        case BENCH_SPINN_ENCODE:
+            bench_encode(iterations);
+            break;
+        case BENCH_SPINN_ENCODE_REF:
+            bench_encode_ref(iterations);
+            break;
+        case BENCH_SPINN_DECODE:
+            bench_decode(iterations);
+            break;
+        case BENCH_SIGNAL_SEM:
+            bench_signal_sem(iterations);
+            break;
+        case BENCH_SIGNAL_NOTIFY:
+            bench_signal_notify(iterations);
+            break;
+        case BENCH_FLAG_SEM:
+            bench_flag_sem(iterations);
+            break;
+        case BENCH_FLAG_ATOMIC:
+            bench_flag_atomic(iterations);
+            break;
+        case BENCH_PIPELINE:
+            /* Times itself, as it reports a stalled link as 0 */
+            return pipe_bench_run(iterations);
+        case BENCH_TRACE:
+            bench_trace(iterations);
+            break;
+        default:
+            return 0;
+    }
+
+    return cycle_get() - start;
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Maps and encodes a varying event using the table-driven codec
+ * 
+ * INPUTS
+ * iterations (uint16_t) : Number of events to encode
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bench_encode(uint16_t iterations)
+{
+    dvs_data_t data;
+    uint8_t pkt_buf[SPINN_SHORT_SYMS];
+
+    for (uint16_t i = 0; i < iterations; i++)
+    {
+        data.x = i & 0x7F;
+        data.y = (i >> 7) & 0x7F;
+        data.polarity = (i >> 14) & 0x1;
+        spinn_codec_encode_event(spinn_codec_map_event(&data), pkt_buf);
+        bench_sink[0] = pkt_buf[0];
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Maps and encodes a varying event using the reference encoder
+ * 
+ * INPUTS
+ * iterations (uint16_t) : Number of events to encode
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bench_encode_ref(uint16_t iterations)
+{
+    dvs_data_t data;
+    uint8_t pkt_buf[SPINN_SHORT_SYMS];
+
+    for (uint16_t i = 0; i < iterations; i++)
+    {
+        data.x = i & 0x7F;
+        data.y = (i >> 7) & 0x7F;
+        data.polarity = (i >> 14) & 0x1;
+        encode_reference(&data, pkt_buf);
+        bench_sink[0] = pkt_buf[0];
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Decodes and validates a short packet repeatedly
+ * 
+ * INPUTS
+ * iterations (uint16_t) : Number of packets to decode
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bench_decode(uint16_t iterations)
+{
+    uint8_t pkt_buf[SPINN_SHORT_SYMS];
+    spinn_packet_t pkt;
+
+    spinn_codec_encode_event(0x8000, pkt_buf);
+    for (uint16_t i = 0; i < iterations; i++)
+    {
+        bench_sink[0] = spinn_codec_decode(pkt_buf, SPINN_SHORT_SYMS, &pkt);
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Signals the calling task through a binary semaphore and takes it, as the
+ * EXTI interrupt used to hand each SpiNNaker link edge to its task
+ * 
+ * INPUTS
+ * iterations (uint16_t) : Number of handoffs
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bench_signal_sem(uint16_t iterations)
+{
+    BaseType_t woken = pdFALSE;
+    SemaphoreHandle_t sem = xSemaphoreCreateBinaryStatic(&bench_sem_obj);
+
+    for (uint16_t i = 0; i < iterations; i++)
+    {
+        xSemaphoreGiveFromISR(sem, &woken);
+        bench_sink[0] = xSemaphoreTake(sem, 0);
+    }
+    vSemaphoreDelete(sem);
+}
+
+/**
+ * DESCRIPTION
+ * Signals the calling task through its notification value and takes it, as
+ * the EXTI interrupt hands each SpiNNaker link edge to its task
+ * 
+ * INPUTS
+ * iterations (uint16_t) : Number of handoffs
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bench_signal_notify(uint16_t iterations)
+{
+    BaseType_t woken = pdFALSE;
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    for (uint16_t i = 0; i < iterations; i++)
+    {
+        vTaskNotifyGiveFromISR(task, &woken);
+        bench_sink[0] = ulTaskNotifyTake(pdTRUE, 0);
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Reads a flag under a semaphore, as the forwarding flags used to be read
+ * once per event or packet
+ * 
+ * INPUTS
+ * iterations (uint16_t) : Number of reads
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bench_flag_sem(uint16_t iterations)
+{
+    SemaphoreHandle_t sem = xSemaphoreCreateBinaryStatic(&bench_sem_obj);
+
+    xSemaphoreGive(sem);
+    for (uint16_t i = 0; i < iterations; i++)
+    {
+        if (xSemaphoreTake(sem, portMAX_DELAY) == pdTRUE)
+        {
+            bench_sink[0] = bench_flag;
+            xSemaphoreGive(sem);
+        }
+    }
+    vSemaphoreDelete(sem);
+}
+
+/**
+ * DESCRIPTION
+ * Reads a single-byte flag directly, as the forwarding flags now are
+ * 
+ * INPUTS
+ * iterations (uint16_t) : Number of reads
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bench_flag_atomic(uint16_t iterations)
+{
+    for (uint16_t i = 0; i < iterations; i++)
+    {
+        bench_sink[0] = bench_flag;
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Adds a trace record with every type being recorded, as instrumented code
+ * does while tracing
+ * 
+ * INPUTS
+ * iterations (uint16_t) : Number of records
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bench_trace(uint16_t iterations)
+{
+    uint32_t lost;
+
+    trace_start(TRACE_ALL);
+    for (uint16_t i = 0; i < iterations; i++)
+    {
+        trace_rec(TRACE_EVENT_DECODED, 0, i);
+    }
+    trace_stop(&lost);
+}
+
+/**
+ * DESCRIPTION
+ * Encodes an event at full resolution one bit and one symbol at a time, as a
+ * baseline for the table-driven codec
+ * 
+ * INPUTS
+ * p_data (dvs_data_t*) : Event to encode
+ * p_pkt (uint8_t*) : Buffer of SPINN_SHORT_SYMS bytes to fill
+ *
+ * RETURNS
+ * Nothing
+ */
+static void encode_reference(dvs_data_t* p_data, uint8_t* p_pkt)
+{
+    uint8_t address[] = {0x00, 0x02, 0x00, 0x00};
+    uint8_t xor_all;
+    uint8_t odd_parity;
+    uint16_t mapped_event;
+
+    mapped_event = 0x8000 + ((p_data->polarity & 0x1) << 14);
+    mapped_event += ((p_data->y & 0x7F) << 7);
+    mapped_event +=  (p_data->x & 0x7F);
+
+    xor_all = address[3] ^ address[2] ^ address[1] ^ address[0] ^
+              ((mapped_event & 0xFF00) >> 8) ^ (mapped_event & 0xFF);
+    odd_parity = 1 ^ ((xor_all & 0x80) >> 7) ^ ((xor_all & 0x40) >> 6) ^
+                     ((xor_all & 0x20) >> 5) ^ ((xor_all & 0x10) >> 4) ^
+                     ((xor_all & 0x08) >> 3) ^ ((xor_all & 0x04) >> 2) ^
+                     ((xor_all & 0x02) >> 1) ^ (xor_all & 0x01);
+
+    p_pkt[0] = spinn_codec_symbols[odd_parity];
+    p_pkt[1] = spinn_codec_symbols[0];
+    p_pkt[2] = spinn_codec_symbols[ mapped_event & 0x000F];
+    p_pkt[3] = spinn_codec_symbols[(mapped_event & 0x00F0) >> 4];
+    p_pkt[4] = spinn_codec_symbols[(mapped_event & 0x0F00) >> 8];
+    p_pkt[5] = spinn_codec_symbols[(mapped_event & 0xF000) >> 12];
+    for (int8_t i = 3; i >= 0; i--)
+    {
+        p_pkt[9 - i] = spinn_codec_symbols[address[i]];
+    }
+    p_pkt[10] = spinn_codec_symbols[SPINN_EOP_IDX];
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
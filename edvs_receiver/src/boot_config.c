@@ -0,0 +1,296 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+#include "string.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "boot_config.h"
+#include "dvs_usart.h"
+#include "spinn_channel.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* Reflected CRC-32, as used by zlib, computed a bit at a time as the page
+   is only checked once per boot */
+#define BOOT_CRC_POLY    (0xEDB88320u)
+#define BOOT_CRC_INIT    (0xFFFFFFFFu)
+
+/* Status flags left by the last flash operation */
+#define BOOT_FLASH_FLAGS (FLASH_FLAG_EOP | FLASH_FLAG_PGERR | \
+                          FLASH_FLAG_WRPERR)
+
+#define BOOT_PAGE        ((boot_page_t const *) BOOT_CONFIG_ADDR)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* Layout of the flash page. The header is programmed last, so a save cut
+   short by a reset leaves a page which is ignored */
+typedef struct boot_page_s {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;
+    boot_config_t config;
+    uint32_t crc;
+} boot_page_t;
+
+/* Fail to compile if the page cannot be programmed in whole words */
+typedef char boot_config_check[(sizeof(boot_config_t) % 4 == 0 &&
+                                sizeof(boot_page_t) <= BOOT_CONFIG_PAGE_LEN) ?
+                               1 : -1];
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static uint8_t boot_page_valid(boot_page_t const * p_page);
+static uint32_t boot_crc(uint32_t crc, void const * p_data, uint16_t len);
+static FLASH_Status boot_program(uint32_t* p_addr, void const * p_data,
+                                 uint16_t len, uint32_t* p_crc);
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+uint8_t boot_config_apply(void)
+{
+    boot_page_t const * p_page = BOOT_PAGE;
+    boot_settings_t const * p_set = &p_page->config.settings;
+    boot_route_t const * p_route;
+    uint8_t idx;
+
+    if (!boot_page_valid(p_page))
+    {
+        return false;
+    }
+
+    dvs_set_mode((dvs_res_t) p_set->dvs_res);
+    spinn_set_packing(p_set->pkt_events);
+    spinn_set_drop_policy((spinn_drop_t) p_set->policy);
+    spinn_set_ack_timeout(p_set->ack_timeout_ms);
+
+    for (idx = 0; idx < PWM_CHANNELS; idx++)
+    {
+        pwm_cfg_t cfg = p_page->config.pwm[idx].cfg;
+        pwm_set_config(idx, &cfg);
+    }
+
+    /* Routes are saved in match order, so adding them in turn restores
+       their priority */
+    spinn_route_clear();
+    for (idx = 0; idx < p_set->route_count; idx++)
+    {
+        p_route = &p_page->config.routes[idx];
+        spinn_route_add(p_route->key, p_route->mask,
+                        (spinn_handler_t) p_route->handler, p_route->arg);
+    }
+
+    /* Forwarding last, once everything it depends on is in place */
+    if (p_set->dvs_fwd_pc)
+    {
+        dvs_forward_pc(true, 0);
+    }
+    if (p_set->spinn_fwd_pc)
+    {
+        spinn_forward_pc(true, 0);
+    }
+    if (p_set->spinn_fwd_rx_pc)
+    {
+        spinn_forward_rx_pc(true, 0);
+    }
+    spinn_tap_pc(p_set->spinn_tap_pc);
+
+    return true;
+}
+
+uint8_t boot_config_save(void)
+{
+    spinn_settings_t spinn;
+    spinn_route_t route;
+    boot_settings_t set;
+    boot_pwm_t pwm;
+    boot_route_t entry;
+    uint32_t addr = BOOT_CONFIG_ADDR + offsetof(boot_page_t, config);
+    uint32_t crc = BOOT_CRC_INIT;
+    uint32_t header[2];
+    FLASH_Status status;
+    uint8_t idx;
+
+    spinn_get_settings(&spinn);
+    memset(&set, 0, sizeof(set));
+    set.dvs_res = dvs_get_mode();
+    set.dvs_fwd_pc = dvs_get_forward_pc();
+    set.spinn_fwd_pc = spinn.fwd_pc;
+    set.spinn_tap_pc = spinn.tap_pc;
+    set.spinn_fwd_rx_pc = spinn.fwd_rx_pc;
+    set.pkt_events = spinn.pkt_events;
+    set.policy = spinn.policy;
+    set.ack_timeout_ms = spinn.ack_timeout_ms;
+    while (spinn_route_get(set.route_count, &route))
+    {
+        set.route_count++;
+    }
+
+    FLASH_Unlock();
+    FLASH_ClearFlag(BOOT_FLASH_FLAGS);
+
+    /* Each section is assembled on the stack and programmed in turn, rather
+       than building the whole page in RAM */
+    status = FLASH_ErasePage(BOOT_CONFIG_ADDR);
+    if (status == FLASH_COMPLETE)
+    {
+        status = boot_program(&addr, &set, sizeof(set), &crc);
+    }
+    for (idx = 0; idx < PWM_CHANNELS && status == FLASH_COMPLETE; idx++)
+    {
+        memset(&pwm, 0, sizeof(pwm));
+        pwm_get_config(idx, &pwm.cfg);
+        status = boot_program(&addr, &pwm, sizeof(pwm), &crc);
+    }
+    for (idx = 0; idx < SPINN_ROUTE_ENTRIES && status == FLASH_COMPLETE;
+         idx++)
+    {
+        memset(&entry, 0, sizeof(entry));
+        if (spinn_route_get(idx, &route))
+        {
+            entry.key = route.key;
+            entry.mask = route.mask;
+            entry.handler = route.handler;
+            entry.arg = route.arg;
+        }
+        status = boot_program(&addr, &entry, sizeof(entry), &crc);
+    }
+    if (status == FLASH_COMPLETE)
+    {
+        crc = ~crc;
+        status = boot_program(&addr, &crc, sizeof(crc), NULL);
+    }
+    if (status == FLASH_COMPLETE)
+    {
+        /* Version and length share a word, little-endian as the core */
+        header[0] = BOOT_CONFIG_MAGIC;
+        header[1] = BOOT_CONFIG_VERSION | (sizeof(boot_config_t) << 16);
+        addr = BOOT_CONFIG_ADDR;
+        status = boot_program(&addr, header, sizeof(header), NULL);
+    }
+
+    FLASH_Lock();
+
+    return status == FLASH_COMPLETE && boot_page_valid(BOOT_PAGE);
+}
+
+uint8_t boot_config_erase(void)
+{
+    FLASH_Status status;
+
+    FLASH_Unlock();
+    FLASH_ClearFlag(BOOT_FLASH_FLAGS);
+    status = FLASH_ErasePage(BOOT_CONFIG_ADDR);
+    FLASH_Lock();
+
+    return status == FLASH_COMPLETE;
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Checks a page has been saved in full by this version of the firmware
+ *
+ * INPUTS
+ * p_page (boot_page_t const *) : Page to check
+ *
+ * RETURNS
+ * true if valid, false otherwise
+ */
+static uint8_t boot_page_valid(boot_page_t const * p_page)
+{
+    if (p_page->magic != BOOT_CONFIG_MAGIC ||
+        p_page->version != BOOT_CONFIG_VERSION ||
+        p_page->length != sizeof(boot_config_t))
+    {
+        return false;
+    }
+
+    return ~boot_crc(BOOT_CRC_INIT, &p_page->config,
+                     sizeof(boot_config_t)) == p_page->crc;
+}
+
+/**
+ * DESCRIPTION
+ * Adds bytes to a running CRC-32
+ *
+ * INPUTS
+ * crc (uint32_t) : CRC so far, BOOT_CRC_INIT to start
+ * p_data (void const *) : Bytes to add
+ * len (uint16_t) : Number of bytes
+ *
+ * RETURNS
+ * Updated CRC, to be inverted once all bytes have been added
+ */
+static uint32_t boot_crc(uint32_t crc, void const * p_data, uint16_t len)
+{
+    uint8_t const * p_byte = p_data;
+    uint8_t bit;
+
+    while (len--)
+    {
+        crc ^= *p_byte++;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? BOOT_CRC_POLY : 0);
+        }
+    }
+    return crc;
+}
+
+/**
+ * DESCRIPTION
+ * Programs whole words to erased flash. Flash must be unlocked
+ *
+ * INPUTS
+ * p_addr (uint32_t*) : Address to program, advanced past what is programmed
+ * p_data (void const *) : Data to program
+ * len (uint16_t) : Number of bytes, a multiple of 4
+ * p_crc (uint32_t*) : Running CRC to add the data to, or NULL
+ *
+ * RETURNS
+ * FLASH_COMPLETE if programmed, or the error which stopped programming
+ */
+static FLASH_Status boot_program(uint32_t* p_addr, void const * p_data,
+                                 uint16_t len, uint32_t* p_crc)
+{
+    uint8_t const * p_byte = p_data;
+    FLASH_Status status = FLASH_COMPLETE;
+    uint32_t word;
+    uint16_t pos;
+
+    if (p_crc)
+    {
+        *p_crc = boot_crc(*p_crc, p_data, len);
+    }
+
+    for (pos = 0; pos < len && status == FLASH_COMPLETE; pos += 4)
+    {
+        memcpy(&word, &p_byte[pos], sizeof(word));
+        status = FLASH_ProgramWord(*p_addr, word);
+        *p_addr += 4;
+    }
+    return status;
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "cycle_count.h"
+#include "ram_code.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* Run-time counter bits taken from the cycle counter; the rest come from the
+   count of counter wraps */
+#define CYCLE_RUNTIME_BITS (32 - CYCLE_RUNTIME_SHIFT)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Times the cycle counter has wrapped, extending it for run-time stats */
+static volatile uint32_t cycle_wraps = 0;
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static void irq_init(void);
+
+/*******************************************************************************
+ * Public Function Definitions 
+ ******************************************************************************/
+void cycle_config(void)
+{
+    TIM_TimeBaseInitTypeDef tim_init;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+
+    /* Count every core clock cycle and wrap at full 32-bit range */
+    tim_init.TIM_Prescaler = 0;
+    tim_init.TIM_CounterMode = TIM_CounterMode_Up;
+    tim_init.TIM_Period = 0xFFFFFFFF;
+    tim_init.TIM_ClockDivision = TIM_CKD_DIV1;
+    tim_init.TIM_RepetitionCounter = 0;
+    TIM_TimeBaseInit(TIM2, &tim_init);
+
+    irq_init();
+
+    TIM_Cmd(TIM2, ENABLE);
+}
+
+RAM_CODE
+uint32_t cycle_get(void)
+{
+    return TIM2->CNT;
+}
+
+uint32_t cycle_get_runtime(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t wraps, count;
+
+    /* The scheduler reads this with interrupts masked, so a wrap may not
+       have been counted yet; check for it pending with the counter and
+       wrap count read together */
+    __disable_irq();
+    count = TIM2->CNT;
+    wraps = cycle_wraps;
+    if ((TIM2->SR & TIM_SR_UIF) && count < 0x80000000)
+    {
+        wraps++;
+    }
+    if (!primask)
+    {
+        __enable_irq();
+    }
+
+    return (wraps << CYCLE_RUNTIME_BITS) | (count >> CYCLE_RUNTIME_SHIFT);
+}
+
+RAM_CODE
+uint8_t cycle_log2(uint32_t cycles)
+{
+    uint8_t bucket = 0;
+
+    if (cycles & 0xFFFF0000)
+    {
+        bucket += 16;
+        cycles >>= 16;
+    }
+    if (cycles & 0xFF00)
+    {
+        bucket += 8;
+        cycles >>= 8;
+    }
+    if (cycles & 0xF0)
+    {
+        bucket += 4;
+        cycles >>= 4;
+    }
+    if (cycles & 0xC)
+    {
+        bucket += 2;
+        cycles >>= 2;
+    }
+    if (cycles & 0x2)
+    {
+        bucket += 1;
+    }
+
+    return bucket;
+}
+
+void TIM2_IRQHandler(void)
+{
+    if (TIM2->SR & TIM_SR_UIF)
+    {
+        TIM2->SR = ~TIM_SR_UIF;
+        cycle_wraps++;
+    }
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Configure interrupt counting cycle counter wraps, at lowest priority as
+ * it only has to run once every 89s
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void irq_init(void)
+{
+    NVIC_InitTypeDef nvic;
+
+    TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+    TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
+
+    nvic.NVIC_IRQChannel = TIM2_IRQn;
+    nvic.NVIC_IRQChannelPriority = 3;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
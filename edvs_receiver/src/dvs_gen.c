@@ -0,0 +1,243 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+#ifndef BARE_METAL
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "timers.h"
+#endif
+
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "dvs_gen.h"
+#include "dvs_usart.h"
+#include "cycle_count.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+#define DVS_GEN_TIMER_NAME  "dvs_gen_timer"
+
+/* Seed for the noise pattern, restored on each start so that runs repeat */
+#define DVS_GEN_SEED        (0x2545F491u)
+
+/* Sensor coordinates are 7 bits */
+#define DVS_GEN_PIXEL_MASK  (0x7F)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Written by the PC receive task, read by the generator */
+static volatile uint8_t gen_active = false;
+static dvs_gen_pattern_t gen_pattern = DVS_GEN_NOISE;
+static uint32_t gen_rate = 0;
+
+/* Generator state, only touched by dvs_gen_poll once started. The time base
+   is taken by the first poll after starting */
+static uint8_t gen_timed = false;
+static uint32_t gen_last = 0;
+static uint32_t gen_remainder = 0;
+static uint32_t gen_random = DVS_GEN_SEED;
+static uint16_t gen_step = 0;
+
+/* Single writer, dvs_gen_poll */
+static volatile uint32_t gen_generated = 0;
+static volatile uint32_t gen_lost = 0;
+
+#ifndef BARE_METAL
+/* Runs the generator every tick while started */
+static TimerHandle_t gen_timer = NULL;
+static StaticTimer_t gen_timer_obj;
+#endif
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static void gen_next(dvs_data_t* p_data);
+#ifndef BARE_METAL
+static void gen_timer_poll(TimerHandle_t timer);
+#endif
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+void dvs_gen_config(void)
+{
+#ifndef BARE_METAL
+    gen_timer = xTimerCreateStatic(DVS_GEN_TIMER_NAME,  /* timer name */
+                                   1,                   /* timer period */
+                                   pdTRUE,              /* auto-reload */
+                                   (void*) 0,           /* no id specified */
+                                   gen_timer_poll,      /* callback */
+                                   &gen_timer_obj);     /* storage */
+#endif
+}
+
+void dvs_gen_start(dvs_gen_pattern_t pattern, uint32_t rate)
+{
+    gen_active = false;
+#ifndef BARE_METAL
+    xTimerStop(gen_timer, portMAX_DELAY);
+#endif
+
+    if (rate == 0 || pattern >= DVS_GEN_NUM)
+    {
+        return;
+    }
+
+    /* Nothing is polling, so state can be reset without a lock */
+    gen_pattern = pattern;
+    gen_rate = rate;
+    gen_timed = false;
+    gen_remainder = 0;
+    gen_random = DVS_GEN_SEED;
+    gen_step = 0;
+    gen_generated = 0;
+    gen_lost = 0;
+    gen_active = true;
+
+#ifndef BARE_METAL
+    xTimerStart(gen_timer, portMAX_DELAY);
+#endif
+}
+
+void dvs_gen_poll(void)
+{
+    dvs_data_t data;
+    uint32_t now, elapsed, due;
+    uint64_t total;
+
+    if (!gen_active)
+    {
+        return;
+    }
+
+    now = cycle_get();
+    if (!gen_timed)
+    {
+        gen_last = now;
+        gen_timed = true;
+        return;
+    }
+
+    /* Events due over the time elapsed, carrying the fraction of an event
+       over to the next poll. Limiting the time to a second bounds the sum,
+       and the burst after the generator was held off for that long */
+    elapsed = now - gen_last;
+    gen_last = now;
+    if (elapsed > SystemCoreClock)
+    {
+        elapsed = SystemCoreClock;
+    }
+    total = gen_remainder + (uint64_t) elapsed * gen_rate;
+    due = (uint32_t) (total / SystemCoreClock);
+    gen_remainder = (uint32_t) (total % SystemCoreClock);
+
+    while (due)
+    {
+        gen_next(&data);
+        if (!dvs_try_put_sim(data))
+        {
+            break;
+        }
+        gen_generated++;
+        due--;
+    }
+    gen_lost += due;
+}
+
+uint8_t dvs_gen_active(void)
+{
+    return gen_active;
+}
+
+void dvs_gen_get_stats(dvs_gen_stats_t* p_stats)
+{
+    p_stats->generated = gen_generated;
+    p_stats->lost = gen_lost;
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Makes the next event of the started pattern
+ *
+ * INPUTS
+ * p_data (dvs_data_t*) : Filled with the event
+ *
+ * RETURNS
+ * Nothing
+ */
+static void gen_next(dvs_data_t* p_data)
+{
+    uint32_t r;
+
+    switch (gen_pattern)
+    {
+        case DVS_GEN_BAR:
+            /* Down each column in turn, a full sweep every 16384 events */
+            p_data->x = (gen_step >> 7) & DVS_GEN_PIXEL_MASK;
+            p_data->y = gen_step & DVS_GEN_PIXEL_MASK;
+            p_data->polarity = 1;
+            gen_step++;
+            break;
+
+        case DVS_GEN_HOT_BLOCK:
+        case DVS_GEN_NOISE:
+        default:
+            /* xorshift32: cheap, and good enough to spread events over the
+               sensor */
+            r = gen_random;
+            r ^= r << 13;
+            r ^= r >> 17;
+            r ^= r << 5;
+            gen_random = r;
+
+            p_data->x = r & DVS_GEN_PIXEL_MASK;
+            p_data->y = (r >> 7) & DVS_GEN_PIXEL_MASK;
+            p_data->polarity = (r >> 14) & 0x1;
+            if (gen_pattern == DVS_GEN_HOT_BLOCK)
+            {
+                p_data->x = DVS_GEN_BLOCK_X +
+                            (p_data->x % DVS_GEN_BLOCK_SIZE);
+                p_data->y = DVS_GEN_BLOCK_Y +
+                            (p_data->y % DVS_GEN_BLOCK_SIZE);
+            }
+            break;
+    }
+}
+
+#ifndef BARE_METAL
+/**
+ * DESCRIPTION
+ * Timer callback running the generator
+ *
+ * INPUTS
+ * timer (TimerHandle_t) : Expired timer
+ *
+ * RETURNS
+ * Nothing
+ */
+static void gen_timer_poll(TimerHandle_t timer)
+{
+    (void) timer;
+    dvs_gen_poll();
+}
+#endif
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
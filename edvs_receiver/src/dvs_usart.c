@@ -3,12 +3,12 @@
  ******************************************************************************/
 #include "stm32f0xx.h"
 
+#ifndef BARE_METAL
 /* FreeRTOS includes */
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
-#include "semphr.h"
 #include "timers.h"
+#endif
 
 #include "string.h"
 #include <stdbool.h>
@@ -19,14 +19,25 @@
 #include "dvs_usart.h"
 #include "pc_usart.h"
 #include "spinn_channel.h"
+#include "os_port.h"
+#include "trace.h"
+#include "ram_code.h"
+#ifdef BARE_METAL
+#include "cycle_count.h"
+#else
+#include "task_config.h"
+#include "wake_stats.h"
+#endif
 
 /*******************************************************************************
  * Local Definitions
  ******************************************************************************/
 #define USART_GPIO GPIOA
-#define BUFFER_LENGTH 20    //length of TX, RX and command buffers
 #define DVS_BAUD_RATE 500000
-#define DATA_LENGTH 3
+
+/* Received bytes are buffered in a ring, of a power of 2 length so that
+   free-running indices can be masked */
+#define DVS_RX_MASK    (DVS_RX_BUF_LEN - 1)
 
 #define RESET_TIMER_NAME "rst_dvs"
 
@@ -43,30 +54,69 @@
 /* Each y value is multiplied by 32 to get array index */
 #define DVS_BYTES_PER_ROW   (32)
 
-#define DVS_BUFFER_LENGTH   (350)
+/* Whether each slot of the event store is filled, one bit per slot */
+#define DVS_SLOT_FILLED(i)  ((dvs_filled[(i) >> 3] >> ((i) & 7)) & 1)
+#define DVS_SLOT_SET(i)     (dvs_filled[(i) >> 3] |= (1 << ((i) & 7)))
+#define DVS_SLOT_CLEAR(i)   (dvs_filled[(i) >> 3] &= ~(1 << ((i) & 7)))
+
+/* Milliseconds to keep offering an event rejected by a full SpiNNaker
+   queue */
+#define DVS_SPINN_RETRIES   (10)
 
 /*******************************************************************************
  * Local Type and Enum definitions
  ******************************************************************************/
-typedef struct dvs_buf_s {
-    bool filled;
-    dvs_data_t data;
-} dvs_buf_t;
+/* None */
 
 /*******************************************************************************
  * Local Variable Declarations
  ******************************************************************************/
-static xQueueHandle dvs_rxq;
-static xQueueHandle dvs_dataq;
-static xSemaphoreHandle xFwdSemaphore = NULL;
+/* Ring of received bytes, written by the USART interrupt and by simulated
+   events from the PC, and read by the pipeline task. Indices are only ever
+   incremented, head by the writers and tail by the reader */
+static uint8_t dvs_rx_buf[DVS_RX_BUF_LEN];
+static volatile uint32_t dvs_rx_head = 0;
+static volatile uint32_t dvs_rx_tail = 0;
+
+/* Pipeline counters, each with a single writer; bytes received are counted
+   by the head index */
+static volatile uint32_t dvs_rx_dropped = 0;
+static volatile uint16_t dvs_rx_high_water = 0;
+static volatile uint32_t dvs_decoded = 0;
+static volatile uint32_t dvs_filtered = 0;
+static volatile uint32_t dvs_sent = 0;
+static volatile uint32_t dvs_retry_dropped = 0;
+
+/* First byte of the event being decoded, if it has been received */
+static uint8_t dvs_first = 0;
+static uint8_t dvs_have_first = false;
+
+#ifdef BARE_METAL
+/* Event rejected by a full SpiNNaker queue, offered again on each pass of
+   the main loop; its last byte stays in the ring until it is through */
+static dvs_data_t dvs_held;
+static uint8_t dvs_holding = false;
+static uint32_t dvs_held_start = 0;
+#else
+/* Pipeline task, notified by the USART interrupt of each received byte */
+static TaskHandle_t dvs_pipe_handle = NULL;
 static TimerHandle_t reset_timer = NULL;
-static uint8_t forward_pc_flag = false;
+
+/* Static storage for RTOS objects */
+static StaticTimer_t reset_timer_obj;
+static StackType_t dvs_pipe_stack[DVS_PIPE_STACK_WORDS];
+static StaticTask_t dvs_pipe_tcb;
+/* Flag for PC forwarding; a single byte, so read and written atomically */
+static volatile uint8_t forward_pc_flag = false;
+#endif
 
 /* Current resolution mode */
 static dvs_res_t dvs_res;
 
-/* Static array to act as storage for DVS events */
-static dvs_buf_t dvs_events[DVS_BUFFER_LENGTH];
+/* Static array to act as storage for DVS events, with the filled flags
+   kept apart as bits rather than padding each slot out by a byte */
+static dvs_data_t dvs_events[DVS_BUFFER_LENGTH];
+static uint8_t dvs_filled[DVS_FILLED_BYTES];
 static int dvs_max_idx = -1;
 
 /*******************************************************************************
@@ -74,12 +124,19 @@ static int dvs_max_idx = -1;
  ******************************************************************************/
 static void hal_init(void);
 static void irq_init(void);
+static void dvs_start(void);
+#ifndef BARE_METAL
 static void tasks_init(void);
 
-static void usart_rx_task(void *pvParameters);
-static void decoded_tx_task(void *pvParameters);
+static void dvs_pipe_task(void *pvParameters);
 
 static void reset_fwd_flag(TimerHandle_t timer);
+#endif
+static uint8_t dvs_rx_put(uint8_t data);
+static uint8_t dvs_handle_event(dvs_data_t* p_data);
+#ifdef BARE_METAL
+static uint8_t dvs_send_held(void);
+#endif
 
 static bool update_events(dvs_data_t* p_in_data, dvs_data_t* p_out_data);
 
@@ -92,24 +149,25 @@ void dvs_config(void)
 {
     hal_init();
     irq_init();
+#ifdef BARE_METAL
+    /* No task to wait for, so start the eDVS streaming straight away */
+    dvs_start();
+#else
     tasks_init();
+#endif
 }
 
+#ifndef BARE_METAL
 void dvs_forward_pc(uint8_t forward, uint16_t timeout_ms)
 {
     if (forward == true)
     {
         /* Set forwarding to true */
-        if (xSemaphoreTake(xFwdSemaphore, portMAX_DELAY) == pdTRUE)
+        forward_pc_flag = true;
+        if (timeout_ms > 0)
         {
-            forward_pc_flag = true;
-            if (timeout_ms > 0)
-            {
-                /* Set up a timeout to cancel the forwarding */
-                xTimerChangePeriod(reset_timer, timeout_ms, portMAX_DELAY);
-
-            }
-            xSemaphoreGive(xFwdSemaphore);
+            /* Set up a timeout to cancel the forwarding */
+            xTimerChangePeriod(reset_timer, timeout_ms, portMAX_DELAY);
         }
     }
     else
@@ -123,33 +181,165 @@ void dvs_forward_pc(uint8_t forward, uint16_t timeout_ms)
     }
 }
 
+uint8_t dvs_get_forward_pc(void)
+{
+    return forward_pc_flag;
+}
+#endif
+
 void dvs_put_sim(dvs_data_t data)
+{
+    /* Wait for room as a real event would be queued */
+    while (!dvs_try_put_sim(data))
+    {
+        os_delay_ms(1);
+    }
+}
+
+uint8_t dvs_try_put_sim(dvs_data_t data)
 {
     uint8_t first, second;
+    uint8_t queued = false;
+
     first = 0x80 + data.y;
     second = ((data.polarity & 0x1) << 7) + data.x;
-    xQueueSendToBack(dvs_rxq, &first, portMAX_DELAY);
-    xQueueSendToBack(dvs_rxq, &second, portMAX_DELAY);
+
+    /* The interrupt also writes the ring, so put both bytes together with
+       it held off */
+    os_enter_critical();
+    if (dvs_rx_head - dvs_rx_tail <= DVS_RX_BUF_LEN - 2)
+    {
+        dvs_rx_put(first);
+        dvs_rx_put(second);
+        queued = true;
+    }
+    os_exit_critical();
+
+#ifndef BARE_METAL
+    if (queued)
+    {
+        xTaskNotifyGive(dvs_pipe_handle);
+    }
+#endif
+    return queued;
+}
+
+void dvs_pipe_poll(void)
+{
+    uint8_t data;
+    dvs_data_t event;
+
+#ifdef BARE_METAL
+    if (dvs_holding)
+    {
+        if (!dvs_send_held())
+        {
+            return;
+        }
+        dvs_rx_tail++;
+    }
+#endif
+
+    while (dvs_rx_tail != dvs_rx_head)
+    {
+        data = dvs_rx_buf[dvs_rx_tail & DVS_RX_MASK];
+        trace_rec(TRACE_QUEUE_RECV, TRACE_Q_DVS_RX, data);
+
+        if (!dvs_have_first)
+        {
+            /* First byte of an event has its top bit set; skip anything
+               else to resynchronise */
+            if (data & 0x80)
+            {
+                dvs_first = data;
+                dvs_have_first = true;
+            }
+        }
+        else
+        {
+            event.x = data & 0x7F;
+            event.y = dvs_first & 0x7F;
+            event.polarity = (data & 0x80) > 0 ? 1 : 0;
+            dvs_have_first = false;
+
+            dvs_decoded++;
+            trace_rec(TRACE_EVENT_DECODED, event.polarity, 
+                      (event.y << 8) | event.x);
+            if (!dvs_handle_event(&event))
+            {
+                /* Held back; return to the loop and offer it again later */
+                return;
+            }
+        }
+
+        /* Free the byte only once handled, so that an empty ring means the
+           event is through the pipeline */
+        dvs_rx_tail++;
+    }
+}
+
+uint8_t dvs_pipe_idle(void)
+{
+    return dvs_rx_tail == dvs_rx_head;
 }
 
 void dvs_set_mode(dvs_res_t res)
 {
     dvs_res = res;
     /* Clear array to start new mode of operation */
-    memset(dvs_events, 0, DVS_BUFFER_LENGTH * sizeof(dvs_buf_t));
+    memset(dvs_events, 0, sizeof(dvs_events));
+    memset(dvs_filled, 0, sizeof(dvs_filled));
     spinn_set_mode(res);
 }
 
+dvs_res_t dvs_get_mode(void)
+{
+    return dvs_res;
+}
+
+void dvs_get_stats(dvs_stats_t* p_stats)
+{
+    uint32_t head = dvs_rx_head;
+
+    p_stats->rx_bytes = head;
+    p_stats->rx_dropped = dvs_rx_dropped;
+    p_stats->decoded = dvs_decoded;
+    p_stats->filtered = dvs_filtered;
+    p_stats->sent = dvs_sent;
+    p_stats->retry_dropped = dvs_retry_dropped;
+    p_stats->rx_depth = head - dvs_rx_tail;
+    p_stats->rx_high_water = dvs_rx_high_water;
+}
+
+RAM_CODE
 void USART1_IRQHandler(void)
 {
     uint8_t data;
-    static portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    os_base_t xHigherPriorityTaskWoken = OS_FALSE;
 
+    trace_rec(TRACE_ISR_ENTER, USART1_IRQn, 0);
     if (USART_GetITStatus(USART1, USART_IT_RXNE)==SET) {
         data = USART_ReceiveData(USART1);
-        xQueueSendFromISR(dvs_rxq, &data, &xHigherPriorityTaskWoken);
+        /* A full ring drops the byte, and the decoder resynchronises on
+           the next first byte of an event */
+        if (!dvs_rx_put(data))
+        {
+            dvs_rx_dropped++;
+            trace_rec(TRACE_DROP, TRACE_DROP_DVS_RX, data);
+        }
+#ifndef BARE_METAL
+        else if (dvs_pipe_handle != NULL)
+        {
+            vTaskNotifyGiveFromISR(dvs_pipe_handle, &xHigherPriorityTaskWoken);
+            wake_isr_stamp(WAKE_DVS_RX, xHigherPriorityTaskWoken);
+        }
+#endif
         USART_ClearITPendingBit(USART1, USART_IT_RXNE);
     }
+    trace_rec(TRACE_ISR_EXIT, USART1_IRQn, 0);
+
+    /* Switch straight to a woken task rather than leave it for the tick */
+    os_yield_from_isr(xHigherPriorityTaskWoken);
 }
 
 
@@ -228,6 +418,33 @@ static void irq_init(void)
 }
 
 
+/**
+ * DESCRIPTION
+ * Configures the eDVS to stream 2-byte events, then enables the interrupt
+ * receiving them
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void dvs_start(void)
+{
+    /* Make sure that there is no echo */
+    dvs_send_string("!U0\n");
+
+    /* Set event format to 2-byte */
+    dvs_send_string("!E0\n");
+
+    /* Enable event streaming */
+    dvs_send_string("E+\n");
+
+    /* Enable interrupt for receiving */
+    USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);
+}
+
+#ifndef BARE_METAL
 /**
  * DESCRIPTION
  * Initialise task and start running
@@ -240,27 +457,25 @@ static void irq_init(void)
  */
 static void tasks_init(void)
 {
-    xFwdSemaphore = xSemaphoreCreateBinary();
-    xSemaphoreGive(xFwdSemaphore);
-    dvs_rxq = xQueueCreate(BUFFER_LENGTH, sizeof(uint8_t));
-    dvs_dataq = xQueueCreate(DATA_LENGTH, sizeof(dvs_data_t));
-    xTaskCreate(usart_rx_task, (char const *)"DVS_Rx", 
-                configMINIMAL_STACK_SIZE, (void *)NULL, 
-                tskIDLE_PRIORITY + 1, NULL);
-    xTaskCreate(decoded_tx_task, (char const *)"Decoded_Tx", 
-                configMINIMAL_STACK_SIZE + 40, (void *)NULL, 
-                tskIDLE_PRIORITY + 1, NULL);
-    reset_timer = xTimerCreate(RESET_TIMER_NAME,  /* timer name */
-                               100,               /* timer period */
-                               pdFALSE,           /* auto-reload */
-                               (void*) 0,         /* no id specified */
-                               reset_fwd_flag);   /* callback function */
+    dvs_pipe_handle = xTaskCreateStatic(dvs_pipe_task, 
+                                        (char const *)DVS_PIPE_TASK_NAME, 
+                                        DVS_PIPE_STACK_WORDS, (void *)NULL, 
+                                        tskIDLE_PRIORITY + 1, dvs_pipe_stack,
+                                        &dvs_pipe_tcb);
+    reset_timer = xTimerCreateStatic(RESET_TIMER_NAME,  /* timer name */
+                                     100,               /* timer period */
+                                     pdFALSE,           /* auto-reload */
+                                     (void*) 0,         /* no id specified */
+                                     reset_fwd_flag,    /* callback */
+                                     &reset_timer_obj); /* storage */
 }
 
 
 /**
  * DESCRIPTION
- * Task to retrieve queued DVS bytes, convert to struct format, and queue up
+ * Task to run each received event to completion: decode from the byte
+ * stream, filter and downscale, then forward to the PC or map and queue for
+ * SpiNNaker. Everything received is handled in one batch per wake
  * 
  * INPUTS
  * pvParameters (void*) : FreeRTOS struct with task information
@@ -268,121 +483,168 @@ static void tasks_init(void)
  * RETURNS
  * Nothing
  */
-static void usart_rx_task(void *pvParameters)
+static void dvs_pipe_task(void *pvParameters)
 {
-    uint8_t i = 0;
-    char data_buf[BUFFER_LENGTH];
-    dvs_data_t tmp_data;
-
-    /* Make sure that there is no echo */
-    dvs_send_string("!U0\n");
-
-    /* Set event format to 2-byte */
-    dvs_send_string("!E0\n");
-
-    /* Enable event streaming */
-    dvs_send_string("E+\n");
-
-    /* Enable interrupt for receiving */
-    USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);
+    dvs_start();
 
-    for (;;) {
-        if (pdPASS == xQueueReceive(dvs_rxq, &data_buf[i++], portMAX_DELAY)) {
-            if (i >= 2)
-            {
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        wake_task_record(WAKE_DVS_RX);
+        dvs_pipe_poll();
+    }
+}
 
-                /* Check that the byte pair is valid by checking for 0 in first byte */
-                if ((data_buf[0] & 0x80) == 0)
-                {
-                    /* Copy byte in data buffer and decrement i */
-                    data_buf[0] = data_buf[1];
-                    i--;
-                }
-                else
-                {
-                    tmp_data.x = data_buf[1] & 0x7F;
-                    tmp_data.y = data_buf[0] & 0x7F;
-                    tmp_data.polarity = (data_buf[1] & 0x80) > 0 ? 1 : 0;
-                    i = 0;
+/**
+ * DESCRIPTION
+ * Performs safe reset of forwarding flag
+ * 
+ * INPUTS
+ * timer (TimerHandle_t) : Expired timer or NULL
+ *
+ * RETURNS
+ * Nothing
+ */
+static void reset_fwd_flag(TimerHandle_t timer)
+{
+    forward_pc_flag = false;
+}
+#endif
 
-                    /* Place new struct into queue */
-                    xQueueSendToBack(dvs_dataq, &tmp_data, portMAX_DELAY);
-                }
-            }
+/**
+ * DESCRIPTION
+ * Appends a received byte to the ring. Called from the USART interrupt, or
+ * with it held off
+ * 
+ * INPUTS
+ * data (uint8_t) : Received byte
+ *
+ * RETURNS
+ * true if stored, false if the ring was full
+ */
+RAM_CODE
+static uint8_t dvs_rx_put(uint8_t data)
+{
+    uint32_t head = dvs_rx_head;
+    uint32_t depth = head - dvs_rx_tail;
 
-            /* If buffer is overflowing, clear it */
-            if (i == BUFFER_LENGTH)
-            {
-                i = 0;
-            }
+    if (depth >= DVS_RX_BUF_LEN)
+    {
+        return false;
+    }
 
-        }
+    /* Store before publishing the index to the reader */
+    dvs_rx_buf[head & DVS_RX_MASK] = data;
+    dvs_rx_head = head + 1;
+    if (depth + 1 > dvs_rx_high_water)
+    {
+        dvs_rx_high_water = depth + 1;
     }
+    trace_rec(TRACE_QUEUE_SEND, TRACE_Q_DVS_RX, data);
+    return true;
 }
 
 /**
  * DESCRIPTION
- * Task to wait for decoded struct and send to SpiNN and possibly PC
+ * Filters and downscales a decoded event, sending any resulting event to
+ * SpiNNaker, or to the PC when forwarding
  * 
  * INPUTS
- * pvParameters (void*) : FreeRTOS struct with task information
+ * p_data (dvs_data_t*) : Decoded event, overwritten with the event to send
  *
  * RETURNS
- * Nothing
+ * true if the event is dealt with, false if it is held back for a full
+ * SpiNNaker queue
  */
-static void decoded_tx_task(void *pvParameters)
+static uint8_t dvs_handle_event(dvs_data_t* p_data)
 {
-    dvs_data_t data;
+#ifndef BARE_METAL
+    uint8_t retries = 0;
+#endif
 
-    for (;;)
+    /* Update stored events and only submit event if required */
+    /* Note that by passing in same struct, less copying is required */
+    if (update_events(p_data, p_data) == false)
     {
-        /* Wait on queue */
-       if (pdPASS == xQueueReceive(dvs_dataq, &data, portMAX_DELAY)) {
+        dvs_filtered++;
+        return true;
+    }
 
-            /* Update stored events and only submit event if required */
-            /* Note that by passing in same struct, less copying is required */
-            if (update_events(&data, &data) == true)
-            {
-                if (xSemaphoreTake(xFwdSemaphore, portMAX_DELAY) == pdTRUE)
-                {
-                    if (forward_pc_flag)
-                    {
-                        pc_send_byte(data.x);
-                        pc_send_byte(data.y);
-                        pc_send_byte(data.polarity);
-                        pc_send_string(PC_EOL);
-                    }
-                    else
-                    {
-                        /* Send decoded data to SpiNNaker */
-                        spinn_send_dvs(&data);
-                    }
-                    xSemaphoreGive(xFwdSemaphore);
-                }
-            }
-       }
+#ifndef BARE_METAL
+    if (forward_pc_flag)
+    {
+        pc_send_byte(p_data->x);
+        pc_send_byte(p_data->y);
+        pc_send_byte(p_data->polarity);
+        pc_send_string(PC_EOL);
+        return true;
     }
+#endif
+
+    /* Send decoded data to SpiNNaker; if the queue rejects it, hold back the
+       DVS stream for a while so that the event is not lost, but never stall
+       on a dead link */
+#ifdef BARE_METAL
+    /* Waiting here would starve the main loop, and with it the watchdog, so
+       hold the event and let the loop offer it again */
+    if (!spinn_send_dvs(p_data))
+    {
+        dvs_held = *p_data;
+        dvs_held_start = cycle_get();
+        dvs_holding = true;
+        return false;
+    }
+#else
+    while (!spinn_send_dvs(p_data))
+    {
+        if (retries++ >= DVS_SPINN_RETRIES)
+        {
+            dvs_retry_dropped++;
+            trace_rec(TRACE_DROP, TRACE_DROP_DVS_RETRY, 
+                      (p_data->y << 8) | p_data->x);
+            return true;
+        }
+        os_delay_ms(1);
+    }
+#endif
+    dvs_sent++;
+    return true;
 }
 
-
+#ifdef BARE_METAL
 /**
  * DESCRIPTION
- * Performs safe reset of forwarding flag
+ * Offers the held event to SpiNNaker again, dropping it once it has been
+ * held for DVS_SPINN_RETRIES milliseconds
  * 
  * INPUTS
- * timer (TimerHandle_t) : Expired timer or NULL
+ * None
  *
  * RETURNS
- * Nothing
+ * true if the event is sent or dropped, false if it is still held
  */
-static void reset_fwd_flag(TimerHandle_t timer)
+static uint8_t dvs_send_held(void)
 {
-    if (xSemaphoreTake(xFwdSemaphore, portMAX_DELAY) == pdTRUE)
+    if (spinn_send_dvs(&dvs_held))
+    {
+        dvs_sent++;
+    }
+    else if (cycle_get() - dvs_held_start <
+             (SystemCoreClock / 1000) * DVS_SPINN_RETRIES)
     {
-        forward_pc_flag = false;
-        xSemaphoreGive(xFwdSemaphore);
+        return false;
     }
+    else
+    {
+        dvs_retry_dropped++;
+        trace_rec(TRACE_DROP, TRACE_DROP_DVS_RETRY, 
+                  (dvs_held.y << 8) | dvs_held.x);
+    }
+    dvs_holding = false;
+    return true;
 }
+#endif
+
 
 /**
  * DESCRIPTION
@@ -425,7 +687,7 @@ static bool update_events(dvs_data_t* p_in_data, dvs_data_t* p_out_data)
     for (int i = 0; i < DVS_BUFFER_LENGTH; i++)
     {
         /* Check if slot is filled */
-        if (dvs_events[i].filled == false)
+        if (!DVS_SLOT_FILLED(i))
         {
             free_idx = i;
             break;
@@ -440,8 +702,8 @@ static bool update_events(dvs_data_t* p_in_data, dvs_data_t* p_out_data)
     }
 
     /* Copy data in */
-    memcpy(&dvs_events[free_idx].data, p_in_data, sizeof(dvs_data_t));
-    dvs_events[free_idx].filled = true;
+    memcpy(&dvs_events[free_idx], p_in_data, sizeof(dvs_data_t));
+    DVS_SLOT_SET(free_idx);
 
     /* Update max filled slot if necessary */
     if (free_idx > dvs_max_idx)
@@ -476,9 +738,9 @@ static bool update_events(dvs_data_t* p_in_data, dvs_data_t* p_out_data)
     memset(relevant, -1, DVS_WIDTH_16*DVS_WIDTH_16);
     for (int i = 0; i <= dvs_max_idx; i++)
     {
-        if (dvs_events[i].filled == true)
+        if (DVS_SLOT_FILLED(i))
         {
-            p_current_event = &dvs_events[i].data;
+            p_current_event = &dvs_events[i];
             if (p_current_event->x <= max_x && p_current_event->x >= min_x &&
                 p_current_event->y <= max_y && p_current_event->y >= min_y)
             {
@@ -521,13 +783,13 @@ static bool update_events(dvs_data_t* p_in_data, dvs_data_t* p_out_data)
         /* Delete data in buffer */
         for (int16_t idx = 0; idx < relevant_idx; idx++)
         {
-            dvs_events[relevant[idx]].filled = false;
+            DVS_SLOT_CLEAR(relevant[idx]);
         }
 
         /* Update maximum index */
         for (int16_t idx = dvs_max_idx; idx >= 0; idx--)
         {
-            if (dvs_events[idx].filled == true)
+            if (DVS_SLOT_FILLED(idx))
             {
                 dvs_max_idx = idx;
                 break;
@@ -558,7 +820,7 @@ static void dvs_send_string(char * str)
     while (*str)
     {
         if (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET) {
-            vTaskDelay(1);
+            os_delay_ms(1);
         } else {
             USART_SendData(USART1, (uint8_t) *str);
             str++;
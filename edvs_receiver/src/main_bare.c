@@ -0,0 +1,179 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+/* Hardware */
+#include "stm32f0xx.h"
+
+/* C Standard Libraries */
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "os_port.h"
+#include "pc_usart.h"
+#include "dvs_usart.h"
+#include "spinn_channel.h"
+#include "cycle_count.h"
+#include "pipe_bench.h"
+#include "dvs_gen.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* SysTick only wakes the super-loop from sleep, so that link stalls are
+   still noticed and the watchdog kicked with no other interrupts */
+#define BARE_TICK_HZ       (100)
+
+/* Events timed through the pipeline at boot, and how often the result is
+   sent to the PC, which may connect at any time */
+#define BARE_BENCH_EVENTS  (2000)
+#define BARE_REPORT_MS     (1000)
+
+/* Report frame is a marker, event count (2 bytes) and cycles (4 bytes) */
+#define BARE_REPORT_MARKER "bare"
+#define BARE_REPORT_LEN    (10)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Result of the pipeline benchmark run at boot, as sent to the PC */
+static uint8_t bare_report[BARE_REPORT_LEN];
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static void iwdg_init(void);
+static void bare_bench(void);
+
+/*******************************************************************************
+ * Public Function Definitions 
+ ******************************************************************************/
+int main(void)
+{
+    uint32_t report_cycles = (SystemCoreClock / 1000) * BARE_REPORT_MS;
+    uint32_t report_start;
+
+    /* Start free-running cycle counter for timing and timeouts */
+    cycle_config();
+
+    /* SpiNNaker before DVS, as the eDVS starts streaming straight away */
+    pc_config();
+    spinn_config();
+    dvs_config();
+
+    /* Set up Watchdog Timer */
+    iwdg_init();
+
+    SysTick_Config(SystemCoreClock / BARE_TICK_HZ);
+
+    bare_bench();
+    report_start = cycle_get();
+
+    for (;;)
+    {
+        os_yield();
+        dvs_gen_poll();
+
+        if (cycle_get() - report_start >= report_cycles)
+        {
+            pc_send_frame(bare_report, sizeof(bare_report));
+            report_start = cycle_get();
+        }
+
+        /* Sleep until the next interrupt unless it has already brought more
+           work; with interrupts masked, one arriving after the check still
+           ends the sleep, and is serviced once unmasked. The generator has
+           no interrupt of its own, so keeps the loop awake while running */
+        __disable_irq();
+        if (dvs_pipe_idle() && !dvs_gen_active())
+        {
+            __WFI();
+        }
+        __enable_irq();
+    }
+}
+
+void os_yield(void)
+{
+    dvs_pipe_poll();
+    spinn_poll();
+
+    /* Reset IWDG counter to reset value */
+    IWDG_ReloadCounter();
+}
+
+void os_delay_ms(uint16_t ms)
+{
+    uint32_t start = cycle_get();
+    uint32_t cycles = (SystemCoreClock / 1000) * ms;
+
+    while (cycle_get() - start < cycles)
+    {
+    }
+}
+
+void SysTick_Handler(void)
+{
+    /* Nothing to do beyond waking the super-loop */
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Static function to set up independent watchdog timer with window disabled
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void iwdg_init(void)
+{
+    IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);
+    IWDG_SetPrescaler(IWDG_Prescaler_16);
+    IWDG_SetReload(2500);
+    IWDG_ReloadCounter();
+    IWDG_Enable();
+}
+
+/**
+ * DESCRIPTION
+ * Times simulated events through the pipeline, as the bench command does in
+ * the FreeRTOS build, and keeps the result to report
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void bare_bench(void)
+{
+    uint32_t cycles = pipe_bench_run(BARE_BENCH_EVENTS);
+    uint8_t i;
+
+    for (i = 0; i < 4; i++)
+    {
+        bare_report[i] = BARE_REPORT_MARKER[i];
+    }
+    bare_report[4] = (BARE_BENCH_EVENTS >> 8) & 0xFF;
+    bare_report[5] = BARE_BENCH_EVENTS & 0xFF;
+    bare_report[6] = (cycles >> 24) & 0xFF;
+    bare_report[7] = (cycles >> 16) & 0xFF;
+    bare_report[8] = (cycles >> 8) & 0xFF;
+    bare_report[9] = cycles & 0xFF;
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
@@ -16,9 +16,14 @@
  * Local Includes
  ******************************************************************************/
 #include "main_receiver.h"
+#include "task_config.h"
 #include "pc_usart.h"
 #include "dvs_usart.h"
 #include "spinn_channel.h"
+#include "cycle_count.h"
+#include "pwm.h"
+#include "boot_config.h"
+#include "dvs_gen.h"
 #include "stm32f0xx_it.h"
 
 /*******************************************************************************
@@ -31,7 +36,18 @@
 /*******************************************************************************
  * Local Type and Enum definitions
  ******************************************************************************/
-/* None */
+/* Fails to compile if RTOS objects outgrow the RAM left by the main stack
+   and application buffers; host builds size stacks for pthreads, so only
+   the device is checked */
+#ifndef SIM_HOST
+typedef char ram_budget_check[(RAM_RTOS_BYTES <= RAM_RTOS_BUDGET_BYTES) ? 
+                              1 : -1];
+#endif
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+static StaticTimer_t iwdg_timer_obj;
 
 /*******************************************************************************
  * Private Function Declarations (static)
@@ -49,11 +65,12 @@ void main_receiver(void)
 
     /* Create timer for telling watchdog not to reset */
     TimerHandle_t iwdg_kicker = NULL;
-    iwdg_kicker = xTimerCreate(IWDG_TIMER_NAME,   /* timer name */
-                               IWDG_TIMER_PERIOD, /* timer period */
-                               pdTRUE,            /* auto-reload */
-                               (void*) 0,         /* no id specified */
-                               iwdg_kick);        /* callback function */
+    iwdg_kicker = xTimerCreateStatic(IWDG_TIMER_NAME,   /* timer name */
+                                     IWDG_TIMER_PERIOD, /* timer period */
+                                     pdTRUE,            /* auto-reload */
+                                     (void*) 0,         /* no id specified */
+                                     iwdg_kick,         /* callback */
+                                     &iwdg_timer_obj);  /* storage */
  
     /* Check timer created successfully */
     if (iwdg_kicker == NULL)
@@ -61,13 +78,24 @@ void main_receiver(void)
         error_loop();
     }
 
+    /* Start free-running cycle counter for timing measurements */
+    cycle_config();
+
     /* Set up USART tasks */
     pc_config();
     dvs_config();
+    dvs_gen_config();
+
+    /* Set up PWM outputs before SpiNNaker packets can be routed to them */
+    pwm_config();
 
     /* Set up SpiNNaker tasks */
     spinn_config();
 
+    /* Restore settings saved from the PC, so that streaming resumes as soon
+       as the scheduler starts, including after a watchdog reset */
+    boot_config_apply();
+
     /* Set up Watchdog Timer */
     iwdg_init();
 
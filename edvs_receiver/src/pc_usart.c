@@ -3,10 +3,13 @@
  ******************************************************************************/
 #include "stm32f0xx.h"
 
+#ifndef BARE_METAL
 /* FreeRTOS includes */
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "timers.h"
+#endif
 
 #include "string.h"
 #include <stdbool.h>
@@ -15,14 +18,28 @@
  * Local Includes
  ******************************************************************************/
 #include "pc_usart.h"
+#ifndef BARE_METAL
+#include "task_config.h"
+#include "wake_stats.h"
+#endif
 #include "dvs_usart.h"
 #include "spinn_channel.h"
+#include "spinn_codec.h"
+#include "spinn_route.h"
+#include "spinn_link.h"
+#include "bench.h"
+#include "pwm.h"
+#include "cycle_count.h"
+#include "trace.h"
+#include "boot_config.h"
+#include "telemetry.h"
+#include "dvs_gen.h"
 
 /*******************************************************************************
  * Local Definitions
  ******************************************************************************/
 #define USART_GPIO GPIOA
-#define BUFFER_LENGTH 40    //length of TX, RX and command buffers
+#define BUFFER_LENGTH PC_RXQ_LENGTH    //length of RX and command buffers
 #define USART_ECHO
 #define USART_BAUD_RATE 500000
 
@@ -39,12 +56,55 @@
 #define PC_CMD_RX_FWD    "f_rx"
 #define PC_CMD_RX_RST    "r_rx"
 #define PC_CMD_RX_USE    "u_rx"
+#define PC_CMD_BENCH     "bnch"
+#define PC_CMD_SPN_PACK  "pspn"
+#define PC_CMD_SPN_DROP  "dspn"
+#define PC_CMD_SPN_QUEUE "qspn"
+#define PC_CMD_SPN_ACK   "tspn"
+#define PC_CMD_SPN_LINK  "lspn"
+#define PC_CMD_ROUTE_ADD "kspn"
+#define PC_CMD_ROUTE_CLR "cspn"
+#define PC_CMD_ROUTE_GET "hspn"
+#define PC_CMD_PWM_CFG   "pwmc"
+#define PC_CMD_PWM_STATE "pwms"
+#define PC_CMD_SPN_HIST  "yspn"
+#define PC_CMD_SPN_RXERR "espn"
+#define PC_CMD_SPN_TAP   "aspn"
+#define PC_CMD_TASKS     "task"
+#define PC_CMD_WAKE      "wake"
+#define PC_CMD_TRACE     "trce"
+#define PC_CMD_CFG_SAVE  "cfgs"
+#define PC_CMD_CFG_CLEAR "cfgc"
+#define PC_CMD_TELEMETRY "tlmy"
+#define PC_CMD_DVS_GEN   "gdvs"
+#define PC_CMD_SPN_LOOP  "lpbk"
+
+/* Task stats frame is a header of total run time, unused RAM budget and
+   number of tasks, then name, run time and stack high-water mark of each
+   task */
+#define TASK_STATS_HDR_LEN   (9)
+#define TASK_STATS_NAME_LEN  (8)
+#define TASK_STATS_ENTRY_LEN (TASK_STATS_NAME_LEN + 6)
+
+/* Trace command either starts recording the record types in its mask, or
+   stops and dumps as a header frame of record count and records lost, then
+   frames of up to TRACE_FRAME_RECORDS records */
+#define TRACE_OP_START       (0)
+#define TRACE_OP_DUMP        (1)
+#define TRACE_HDR_LEN        (6)
+#define TRACE_FRAME_RECORDS  (8)
+
+/* Telemetry frame is every counter of telemetry_t, in order, as 19 32-bit
+   counts, two 16-bit high-water marks and the link up flag */
+#define TELEMETRY_COUNTS     (19)
+#define TELEMETRY_LEN        (TELEMETRY_COUNTS * 4 + 2 * 2 + 1)
 
 
 #define PC_RESP_OK        "000 Success\r"
 #define PC_RESP_BAD_CMD   "001 Not recognised\r"
 #define PC_RESP_BAD_LEN   "002 Wrong length\r"
 #define PC_RESP_BAD_PARAM "003 Bad parameter\r"
+#define PC_RESP_FLASH     "004 Flash write failed\r"
 
 #define PC_IDENTIFIER "Interface"
 
@@ -57,33 +117,64 @@
 /*******************************************************************************
  * Local Variable Declarations
  ******************************************************************************/
+#ifndef BARE_METAL
 static xQueueHandle pc_txq, pc_rxq;
 
+/* Static storage for queues and tasks */
+static uint8_t pc_txq_buf[PC_TXQ_LENGTH];
+static uint8_t pc_rxq_buf[PC_RXQ_LENGTH];
+static StaticQueue_t pc_txq_obj, pc_rxq_obj;
+static StackType_t pc_tx_stack[PC_TX_STACK_WORDS];
+static StackType_t pc_rx_stack[PC_RX_STACK_WORDS];
+static StaticTask_t pc_tx_tcb, pc_rx_tcb;
+
+/* Receive counters, only written by the interrupt */
+static volatile uint32_t pc_rx_bytes = 0;
+static volatile uint32_t pc_rx_dropped = 0;
+#endif
+
 
 /*******************************************************************************
  * Private Function Declarations (static)
  ******************************************************************************/
 static void hal_init(void);
+#ifndef BARE_METAL
 static void irq_init(void);
 static void tasks_init(void);
 
 static void usart_tx_task(void *pvParameters);
 static void usart_rx_task(void *pvParameters);
 
+static void send_task_stats(void);
+static void send_telemetry(void);
+static uint8_t* pack_be(uint8_t* buf, uint32_t val, uint8_t bytes);
+static uint32_t unpack_be(char* buf, uint8_t bytes);
+#endif
+
 /*******************************************************************************
  * Public Function Definitions 
  ******************************************************************************/
 void pc_config(void)
 {
     hal_init();
+#ifndef BARE_METAL
     irq_init();
     tasks_init();
+#endif
 
 }
 
 void pc_send_byte(uint8_t data)
 {
+#ifdef BARE_METAL
+    /* Only used to report results, so simply wait for the transmitter */
+    while (USART_GetFlagStatus(USART2, USART_FLAG_TXE) == RESET)
+    {
+    }
+    USART_SendData(USART2, data);
+#else
     xQueueSend(pc_txq, &data, portMAX_DELAY);
+#endif
 }
 
 void pc_send_string(char * str)
@@ -94,18 +185,81 @@ void pc_send_string(char * str)
     }
 }
 
+void pc_send_frame(uint8_t * buf, uint16_t len)
+{
+    pc_send_byte((len & 0xFF00) >> 8);
+    pc_send_byte(len & 0x00FF);
+    while (len--)
+    {
+        pc_send_byte(*buf);
+        buf++;
+    }
+    pc_send_string(PC_EOL);
+}
+
+#ifndef BARE_METAL
+uint8_t pc_send_frame_nb(uint8_t * buf, uint16_t len)
+{
+    uint8_t header[2];
+    uint8_t eol = PC_EOL[0];
+    uint8_t queued = false;
+    uint16_t i;
+
+    header[0] = (len & 0xFF00) >> 8;
+    header[1] = len & 0x00FF;
+
+    /* Only tasks add to the queue, so with the scheduler suspended the free
+       space cannot shrink and no other bytes can be queued mid-frame */
+    vTaskSuspendAll();
+    if (uxQueueSpacesAvailable(pc_txq) >= len + sizeof(header) + 1)
+    {
+        xQueueSend(pc_txq, &header[0], 0);
+        xQueueSend(pc_txq, &header[1], 0);
+        for (i = 0; i < len; i++)
+        {
+            xQueueSend(pc_txq, &buf[i], 0);
+        }
+        xQueueSend(pc_txq, &eol, 0);
+        queued = true;
+    }
+    xTaskResumeAll();
+
+    return queued;
+}
+
 void USART2_IRQHandler(void)
 {
     uint8_t data;
-    static portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+    trace_rec(TRACE_ISR_ENTER, USART2_IRQn, 0);
     if (USART_GetITStatus(USART2, USART_IT_RXNE)==SET) {
         data = USART_ReceiveData(USART2);
-        xQueueSendFromISR(pc_rxq, &data, &xHigherPriorityTaskWoken);
+        if (xQueueSendFromISR(pc_rxq, &data, &xHigherPriorityTaskWoken) == 
+            pdPASS)
+        {
+            pc_rx_bytes++;
+        }
+        else
+        {
+            pc_rx_dropped++;
+        }
+        wake_isr_stamp(WAKE_PC_RX, xHigherPriorityTaskWoken);
         USART_ClearITPendingBit(USART2, USART_IT_RXNE);
     }
+    trace_rec(TRACE_ISR_EXIT, USART2_IRQn, 0);
+
+    /* Switch straight to a woken task rather than leave it for the tick */
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 }
 
+void pc_get_stats(pc_stats_t* p_stats)
+{
+    p_stats->rx_bytes = pc_rx_bytes;
+    p_stats->rx_dropped = pc_rx_dropped;
+}
+#endif
+
 
 /*******************************************************************************
  * Private Function Definitions (static)
@@ -153,6 +307,7 @@ static void hal_init(void)
 
 }
 
+#ifndef BARE_METAL
 /**
  * DESCRIPTION
  * Initialise and register interrupt routines
@@ -188,13 +343,17 @@ static void irq_init(void)
  */
 static void tasks_init(void)
 {
-    pc_txq = xQueueCreate(BUFFER_LENGTH, sizeof(uint8_t));
-    pc_rxq = xQueueCreate(BUFFER_LENGTH, sizeof(uint8_t));
+    pc_txq = xQueueCreateStatic(PC_TXQ_LENGTH, sizeof(uint8_t), pc_txq_buf,
+                                &pc_txq_obj);
+    pc_rxq = xQueueCreateStatic(PC_RXQ_LENGTH, sizeof(uint8_t), pc_rxq_buf,
+                                &pc_rxq_obj);
 
-    xTaskCreate(usart_tx_task, (char const *)"PC_Tx", configMINIMAL_STACK_SIZE,
-                (void *)NULL, tskIDLE_PRIORITY + 1, NULL);
-    xTaskCreate(usart_rx_task, (char const *)"PC_Rx", configMINIMAL_STACK_SIZE,
-                (void *)NULL, tskIDLE_PRIORITY + 1, NULL);
+    xTaskCreateStatic(usart_tx_task, (char const *)PC_TX_TASK_NAME, 
+                      PC_TX_STACK_WORDS, (void *)NULL, tskIDLE_PRIORITY + 1, 
+                      pc_tx_stack, &pc_tx_tcb);
+    xTaskCreateStatic(usart_rx_task, (char const *)PC_RX_TASK_NAME, 
+                      PC_RX_STACK_WORDS, (void *)NULL, tskIDLE_PRIORITY + 1, 
+                      pc_rx_stack, &pc_rx_tcb);
 }
 
 /**
@@ -241,6 +400,7 @@ static void usart_rx_task(void *pvParameters)
 
     for (;;) {
         if (pdPASS == xQueueReceive(pc_rxq, &data_buf[i++], portMAX_DELAY)) {
+            wake_task_record(WAKE_PC_RX);
 
 #ifdef USART_ECHO
             pc_send_byte(data_buf[i-1]);
@@ -371,6 +531,45 @@ static void usart_rx_task(void *pvParameters)
                     /* Reset the forwarding of SpiNN packets */
                     spinn_forward_pc(false, 0);
                 }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_TAP) == 0)
+                {
+                    /* Mirror packets sent on the SpiNNaker link to the PC */
+                    /* 6 bytes is 4 command, 1 data, 1 \r */
+                    if (i == 6)
+                    {
+                        uint8_t tap = data_buf[4];
+                        if (tap <= true)
+                        {
+                            pc_send_string(PC_RESP_OK);
+                            spinn_tap_pc(tap);
+                        }
+                        else
+                        {
+                            pc_send_string(PC_RESP_BAD_PARAM);
+                        }
+                    }
+                    else if (i > 6)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_TASKS) == 0)
+                {
+                    /* Report CPU time and stack use of every task */
+                    pc_send_string(PC_RESP_OK);
+                    send_task_stats();
+                }
+                else if (strcmp(cmd_buf, PC_CMD_TELEMETRY) == 0)
+                {
+                    /* Report every pipeline counter in one frame */
+                    pc_send_string(PC_RESP_OK);
+                    send_telemetry();
+                }
                 else if (strcmp(cmd_buf, PC_CMD_SPN_MODE) == 0)
                 {
                     /* Retrieve requested mode and set in spinn_channel.c */
@@ -398,6 +597,441 @@ static void usart_rx_task(void *pvParameters)
                         continue;
                     }
                 }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_PACK) == 0)
+                {
+                    /* Set number of events which may share a packet */
+                    /* 6 bytes is 4 command, 1 data, 1 \r */
+                    if (i == 6)
+                    {
+                        uint8_t req_events = data_buf[4];
+                        if (req_events > 0 && 
+                            req_events <= SPINN_MAX_PKT_EVENTS)
+                        {
+                            pc_send_string(PC_RESP_OK);
+                            spinn_set_packing(req_events);
+                        }
+                        else
+                        {
+                            pc_send_string(PC_RESP_BAD_PARAM);
+                        }
+                    }
+                    else if (i > 6)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_DROP) == 0)
+                {
+                    /* Set behaviour when SpiNNaker transmit queue is full */
+                    /* 6 bytes is 4 command, 1 data, 1 \r */
+                    if (i == 6)
+                    {
+                        uint8_t req_policy = data_buf[4];
+                        if (req_policy < SPINN_DROP_NUM)
+                        {
+                            pc_send_string(PC_RESP_OK);
+                            spinn_set_drop_policy((spinn_drop_t) req_policy);
+                        }
+                        else
+                        {
+                            pc_send_string(PC_RESP_BAD_PARAM);
+                        }
+                    }
+                    else if (i > 6)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_QUEUE) == 0)
+                {
+                    /* Report SpiNNaker transmit queue state as a frame of
+                       policy, capacity, depth, high-water mark and counts of
+                       overwritten, dropped and rejected events */
+                    spinn_ring_stats_t stats;
+                    uint8_t resp[19];
+                    uint8_t *p_resp = resp;
+
+                    spinn_get_ring_stats(&stats);
+                    p_resp = pack_be(p_resp, stats.policy, 1);
+                    p_resp = pack_be(p_resp, SPINN_RING_CAPACITY, 2);
+                    p_resp = pack_be(p_resp, stats.depth, 2);
+                    p_resp = pack_be(p_resp, stats.high_water, 2);
+                    p_resp = pack_be(p_resp, stats.overwritten, 4);
+                    p_resp = pack_be(p_resp, stats.dropped, 4);
+                    pack_be(p_resp, stats.rejected, 4);
+
+                    pc_send_string(PC_RESP_OK);
+                    pc_send_frame(resp, sizeof(resp));
+                }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_ACK) == 0)
+                {
+                    /* Set SpiNNaker acknowledge timeout, 0 to wait forever */
+                    /* 7 bytes is 4 command, 2 data, 1 \r */
+                    if (i == 7)
+                    {
+                        pc_send_string(PC_RESP_OK);
+                        uint16_t ack_time = data_buf[4] << 8;
+                        ack_time += data_buf[5];
+                        spinn_set_ack_timeout(ack_time);
+                    }
+                    else if (i > 7)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_LINK) == 0)
+                {
+                    /* Report SpiNNaker link state as a frame of up flag,
+                       counts of timeouts, stalls, recoveries and abandoned
+                       packets, then last, longest and current stall in ms */
+                    spinn_link_stats_t stats;
+                    uint8_t resp[29];
+                    uint8_t *p_resp = resp;
+
+                    spinn_get_link_stats(&stats);
+                    p_resp = pack_be(p_resp, stats.up, 1);
+                    p_resp = pack_be(p_resp, stats.timeouts, 4);
+                    p_resp = pack_be(p_resp, stats.stalls, 4);
+                    p_resp = pack_be(p_resp, stats.recoveries, 4);
+                    p_resp = pack_be(p_resp, stats.abandoned, 4);
+                    p_resp = pack_be(p_resp, stats.last_recovery_ms, 4);
+                    p_resp = pack_be(p_resp, stats.max_recovery_ms, 4);
+                    pack_be(p_resp, stats.down_ms, 4);
+
+                    pc_send_string(PC_RESP_OK);
+                    pc_send_frame(resp, sizeof(resp));
+                }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_RXERR) == 0)
+                {
+                    /* Report received SpiNNaker packet counts as a frame of
+                       good packets, rejections by reason and overruns, and
+                       clear them if requested */
+                    /* 6 bytes is 4 command, 1 data, 1 \r */
+                    if (i == 6)
+                    {
+                        spinn_rx_stats_t stats;
+                        uint8_t resp[24];
+                        uint8_t *p_resp = resp;
+
+                        spinn_get_rx_stats(&stats, data_buf[4]);
+                        p_resp = pack_be(p_resp, stats.packets, 4);
+                        p_resp = pack_be(p_resp, stats.bad_length, 4);
+                        p_resp = pack_be(p_resp, stats.bad_eop, 4);
+                        p_resp = pack_be(p_resp, stats.bad_symbol, 4);
+                        p_resp = pack_be(p_resp, stats.bad_parity, 4);
+                        pack_be(p_resp, stats.overruns, 4);
+
+                        pc_send_string(PC_RESP_OK);
+                        pc_send_frame(resp, sizeof(resp));
+                    }
+                    else if (i > 6)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_ROUTE_ADD) == 0)
+                {
+                    /* Add route for received SpiNNaker packets */
+                    /* 15 bytes is 4 command, 4 key, 4 mask, 1 handler, 
+                       1 arg, 1 \r */
+                    if (i == 15)
+                    {
+                        uint32_t key = unpack_be(&data_buf[4], 4);
+                        uint32_t mask = unpack_be(&data_buf[8], 4);
+                        if (spinn_route_add(key, mask, 
+                                            (spinn_handler_t) data_buf[12],
+                                            data_buf[13]))
+                        {
+                            pc_send_string(PC_RESP_OK);
+                        }
+                        else
+                        {
+                            pc_send_string(PC_RESP_BAD_PARAM);
+                        }
+                    }
+                    else if (i > 15)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_ROUTE_CLR) == 0)
+                {
+                    /* Remove all routes for received SpiNNaker packets */
+                    pc_send_string(PC_RESP_OK);
+                    spinn_route_clear();
+                }
+                else if (strcmp(cmd_buf, PC_CMD_ROUTE_GET) == 0)
+                {
+                    /* Report routes as a frame of unrouted packet count and
+                       number of routes, then a frame per route of key, mask,
+                       handler, arg, last value and hits */
+                    spinn_route_t route;
+                    uint8_t resp[16];
+                    uint8_t *p_resp;
+                    uint8_t route_idx = 0;
+
+                    while (spinn_route_get(route_idx, &route))
+                    {
+                        route_idx++;
+                    }
+
+                    pc_send_string(PC_RESP_OK);
+                    p_resp = pack_be(resp, spinn_route_misses(), 4);
+                    pack_be(p_resp, route_idx, 1);
+                    pc_send_frame(resp, 5);
+
+                    for (route_idx = 0; spinn_route_get(route_idx, &route);
+                         route_idx++)
+                    {
+                        p_resp = pack_be(resp, route.key, 4);
+                        p_resp = pack_be(p_resp, route.mask, 4);
+                        p_resp = pack_be(p_resp, route.handler, 1);
+                        p_resp = pack_be(p_resp, route.arg, 1);
+                        p_resp = pack_be(p_resp, route.last_value, 2);
+                        pack_be(p_resp, route.hits, 4);
+                        pc_send_frame(resp, sizeof(resp));
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_PWM_CFG) == 0)
+                {
+                    /* Set scaling, limits and slew rate of PWM channel */
+                    /* 16 bytes is 4 command, 1 channel, 2 gain, 2 offset,
+                       2 min, 2 max, 2 slew, 1 \r */
+                    if (i == 16)
+                    {
+                        pwm_cfg_t cfg;
+                        cfg.gain = unpack_be(&data_buf[5], 2);
+                        cfg.offset = (int16_t) unpack_be(&data_buf[7], 2);
+                        cfg.min = unpack_be(&data_buf[9], 2);
+                        cfg.max = unpack_be(&data_buf[11], 2);
+                        cfg.slew = unpack_be(&data_buf[13], 2);
+                        if (pwm_set_config(data_buf[4], &cfg))
+                        {
+                            pc_send_string(PC_RESP_OK);
+                        }
+                        else
+                        {
+                            pc_send_string(PC_RESP_BAD_PARAM);
+                        }
+                    }
+                    else if (i > 16)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_PWM_STATE) == 0)
+                {
+                    /* Report target and output compare value of each PWM
+                       channel as a frame */
+                    uint8_t resp[4 * PWM_CHANNELS];
+                    uint8_t *p_resp = resp;
+                    uint16_t target, compare;
+                    uint8_t channel;
+
+                    for (channel = 0; channel < PWM_CHANNELS; channel++)
+                    {
+                        pwm_get(channel, &target, &compare);
+                        p_resp = pack_be(p_resp, target, 2);
+                        p_resp = pack_be(p_resp, compare, 2);
+                    }
+
+                    pc_send_string(PC_RESP_OK);
+                    pc_send_frame(resp, sizeof(resp));
+                }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_HIST) == 0)
+                {
+                    /* Report SpiNNaker link latency histograms as one frame
+                       each, and clear them if requested */
+                    /* 6 bytes is 4 command, 1 data, 1 \r */
+                    if (i == 6)
+                    {
+                        uint32_t counts[SPINN_HIST_BUCKETS];
+                        uint8_t *p_resp;
+                        uint8_t hist, bucket;
+
+                        pc_send_string(PC_RESP_OK);
+                        for (hist = 0; hist < SPINN_HIST_NUM; hist++)
+                        {
+                            spinn_link_get_hist((spinn_hist_t) hist, counts,
+                                                data_buf[4]);
+
+                            /* Pack in place to save stack; each count is
+                               read before its own bytes are overwritten */
+                            p_resp = (uint8_t*) counts;
+                            for (bucket = 0; bucket < SPINN_HIST_BUCKETS; 
+                                 bucket++)
+                            {
+                                p_resp = pack_be(p_resp, counts[bucket], 4);
+                            }
+                            pc_send_frame((uint8_t*) counts, sizeof(counts));
+                        }
+                    }
+                    else if (i > 6)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_WAKE) == 0)
+                {
+                    /* Report interrupt to task wake latency histograms as
+                       one frame each, and clear them if requested */
+                    /* 6 bytes is 4 command, 1 data, 1 \r */
+                    if (i == 6)
+                    {
+                        uint32_t counts[WAKE_HIST_BUCKETS];
+                        uint8_t *p_resp;
+                        uint8_t src, bucket;
+
+                        pc_send_string(PC_RESP_OK);
+                        for (src = 0; src < WAKE_NUM; src++)
+                        {
+                            wake_get_hist((wake_src_t) src, counts, 
+                                          data_buf[4]);
+
+                            /* Pack in place as for the link histograms */
+                            p_resp = (uint8_t*) counts;
+                            for (bucket = 0; bucket < WAKE_HIST_BUCKETS; 
+                                 bucket++)
+                            {
+                                p_resp = pack_be(p_resp, counts[bucket], 4);
+                            }
+                            pc_send_frame((uint8_t*) counts, sizeof(counts));
+                        }
+                    }
+                    else if (i > 6)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_TRACE) == 0)
+                {
+                    /* Start tracing, or stop and send the trace */
+                    /* 8 bytes is 4 command, 1 op, 2 mask, 1 \r */
+                    if (i == 8)
+                    {
+                        uint8_t op = data_buf[4];
+                        uint16_t mask = unpack_be(&data_buf[5], 2);
+
+                        if (op == TRACE_OP_START)
+                        {
+                            trace_start(mask);
+                            pc_send_string(PC_RESP_OK);
+                        }
+                        else if (op == TRACE_OP_DUMP)
+                        {
+                            uint8_t resp[TRACE_FRAME_RECORDS * 
+                                         TRACE_RECORD_LEN];
+                            uint8_t *p_resp;
+                            trace_rec_t rec;
+                            uint32_t lost;
+                            uint16_t count, idx;
+
+                            /* Stopped first, so that sending the trace does
+                               not overwrite it */
+                            count = trace_stop(&lost);
+                            pc_send_string(PC_RESP_OK);
+                            p_resp = pack_be(resp, count, 2);
+                            pack_be(p_resp, lost, 4);
+                            pc_send_frame(resp, TRACE_HDR_LEN);
+
+                            p_resp = resp;
+                            for (idx = 0; idx < count; idx++)
+                            {
+                                trace_get(idx, &rec);
+                                p_resp = pack_be(p_resp, rec.cycles, 4);
+                                p_resp = pack_be(p_resp, rec.id, 1);
+                                p_resp = pack_be(p_resp, rec.tag, 1);
+                                p_resp = pack_be(p_resp, rec.value, 2);
+                                if (p_resp == resp + sizeof(resp) || 
+                                    idx == count - 1)
+                                {
+                                    pc_send_frame(resp, p_resp - resp);
+                                    p_resp = resp;
+                                }
+                            }
+                        }
+                        else
+                        {
+                            pc_send_string(PC_RESP_BAD_PARAM);
+                        }
+                    }
+                    else if (i > 8)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_CFG_SAVE) == 0)
+                {
+                    /* Save current settings to be applied at every boot.
+                       The core stalls while flash is written, so events
+                       arriving meanwhile are lost */
+                    if (boot_config_save())
+                    {
+                        pc_send_string(PC_RESP_OK);
+                    }
+                    else
+                    {
+                        pc_send_string(PC_RESP_FLASH);
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_CFG_CLEAR) == 0)
+                {
+                    /* Forget saved settings, so defaults are used from the
+                       next boot */
+                    if (boot_config_erase())
+                    {
+                        pc_send_string(PC_RESP_OK);
+                    }
+                    else
+                    {
+                        pc_send_string(PC_RESP_FLASH);
+                    }
+                }
                 else if (strcmp(cmd_buf, PC_CMD_RX_FWD) == 0)
                 {
                     /* Set board to forward any received SpiNNaker data */
@@ -437,7 +1071,8 @@ static void usart_rx_task(void *pvParameters)
                         pc_send_string(PC_RESP_OK);
 
                         /* Use as SpiNNaker packet */
-                        spinn_use_data((uint8_t*) &data_buf[4]);
+                        spinn_use_data((uint8_t*) &data_buf[4], 
+                                       SPINN_SHORT_SYMS);
                     }
                     else if (i > 16)
                     {
@@ -449,6 +1084,110 @@ static void usart_rx_task(void *pvParameters)
                         continue;
                     }
                 }
+                else if (strcmp(cmd_buf, PC_CMD_BENCH) == 0)
+                {
+                    /* Run benchmark and return total cycles taken */
+                    /* 8 bytes is 4 command, 1 id, 2 iterations, 1 \r */
+                    if (i == 8)
+                    {
+                        uint8_t bench_id = data_buf[4];
+                        uint16_t iterations = data_buf[5] << 8;
+                        iterations += data_buf[6];
+                        if (bench_id < BENCH_NUM)
+                        {
+                            uint32_t cycles;
+                            uint8_t resp[4];
+
+                            pc_send_string(PC_RESP_OK);
+                            cycles = bench_run((bench_id_t) bench_id, 
+                                               iterations);
+                            pack_be(resp, cycles, 4);
+                            pc_send_frame(resp, sizeof(resp));
+                        }
+                        else
+                        {
+                            pc_send_string(PC_RESP_BAD_PARAM);
+                        }
+                    }
+                    else if (i > 8)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_DVS_GEN) == 0)
+                {
+                    /* Start or stop generating events in place of the eDVS
+                       and return counts of the run so far */
+                    /* 10 bytes is 4 command, 1 pattern, 4 rate, 1 \r */
+                    if (i == 10)
+                    {
+                        uint8_t pattern = data_buf[4];
+                        uint32_t rate = unpack_be(&data_buf[5], 4);
+                        if (pattern < DVS_GEN_NUM)
+                        {
+                            dvs_gen_stats_t stats;
+                            uint8_t resp[8];
+                            uint8_t *p_resp = resp;
+
+                            /* Counts before starting clears them */
+                            dvs_gen_get_stats(&stats);
+                            dvs_gen_start((dvs_gen_pattern_t) pattern, rate);
+                            pc_send_string(PC_RESP_OK);
+                            p_resp = pack_be(p_resp, stats.generated, 4);
+                            pack_be(p_resp, stats.lost, 4);
+                            pc_send_frame(resp, sizeof(resp));
+                        }
+                        else
+                        {
+                            pc_send_string(PC_RESP_BAD_PARAM);
+                        }
+                    }
+                    else if (i > 10)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
+                else if (strcmp(cmd_buf, PC_CMD_SPN_LOOP) == 0)
+                {
+                    /* Loop SpiNNaker packets back from the encoder to the
+                       decoder, or return to the link, and return counts of
+                       packets looped back so far */
+                    /* 6 bytes is 4 command, 1 data, 1 \r */
+                    if (i == 6)
+                    {
+                        spinn_loop_stats_t stats;
+                        uint8_t resp[12];
+                        uint8_t *p_resp = resp;
+
+                        /* Counts before enabling clears them */
+                        spinn_get_loop_stats(&stats);
+                        spinn_set_loopback(data_buf[4] != 0);
+                        pc_send_string(PC_RESP_OK);
+                        p_resp = pack_be(p_resp, stats.packets, 4);
+                        p_resp = pack_be(p_resp, stats.events, 4);
+                        pack_be(p_resp, stats.errors, 4);
+                        pc_send_frame(resp, sizeof(resp));
+                    }
+                    else if (i > 6)
+                    {
+                        pc_send_string(PC_RESP_BAD_LEN);
+                    }
+                    else
+                    {
+                        /* Continue to avoid buffer being cleared */
+                        continue;
+                    }
+                }
                 else
                 {
                     /* If command is not recognised, say so */
@@ -469,6 +1208,162 @@ static void usart_rx_task(void *pvParameters)
     }
 }
 
+/**
+ * DESCRIPTION
+ * Writes value into buffer most significant byte first
+ * 
+ * INPUTS
+ * buf (uint8_t*) : Buffer to write into
+ * val (uint32_t) : Value to write
+ * bytes (uint8_t) : Number of least significant bytes of val to write
+ *
+ * RETURNS
+ * Pointer to byte after those written (uint8_t*)
+ */
+static uint8_t* pack_be(uint8_t* buf, uint32_t val, uint8_t bytes)
+{
+    while (bytes--)
+    {
+        *buf++ = (val >> (8 * bytes)) & 0xFF;
+    }
+    return buf;
+}
+
+/**
+ * DESCRIPTION
+ * Sends the counters of every module as one frame, laid out as telemetry_t
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void send_telemetry(void)
+{
+    telemetry_t telem;
+    uint8_t resp[TELEMETRY_LEN];
+    uint8_t *p_resp = resp;
+
+    telemetry_get(&telem);
+    p_resp = pack_be(p_resp, telem.uptime_ms, 4);
+    p_resp = pack_be(p_resp, telem.pc_rx_bytes, 4);
+    p_resp = pack_be(p_resp, telem.pc_rx_dropped, 4);
+    p_resp = pack_be(p_resp, telem.dvs_rx_bytes, 4);
+    p_resp = pack_be(p_resp, telem.dvs_rx_dropped, 4);
+    p_resp = pack_be(p_resp, telem.decoded, 4);
+    p_resp = pack_be(p_resp, telem.filtered, 4);
+    p_resp = pack_be(p_resp, telem.queued, 4);
+    p_resp = pack_be(p_resp, telem.retry_dropped, 4);
+    p_resp = pack_be(p_resp, telem.tx_overwritten, 4);
+    p_resp = pack_be(p_resp, telem.tx_dropped, 4);
+    p_resp = pack_be(p_resp, telem.tx_rejected, 4);
+    p_resp = pack_be(p_resp, telem.tx_packets, 4);
+    p_resp = pack_be(p_resp, telem.tx_abandoned, 4);
+    p_resp = pack_be(p_resp, telem.link_timeouts, 4);
+    p_resp = pack_be(p_resp, telem.link_stalls, 4);
+    p_resp = pack_be(p_resp, telem.rx_packets, 4);
+    p_resp = pack_be(p_resp, telem.rx_errors, 4);
+    p_resp = pack_be(p_resp, telem.route_misses, 4);
+    p_resp = pack_be(p_resp, telem.dvs_rx_high_water, 2);
+    p_resp = pack_be(p_resp, telem.tx_high_water, 2);
+    pack_be(p_resp, telem.link_up, 1);
+
+    pc_send_frame(resp, sizeof(resp));
+}
+
+/**
+ * DESCRIPTION
+ * Sends run time and stack high-water mark of every task, with total run
+ * time and RAM left in the budget, as one frame. Run times are in units of
+ * 2^CYCLE_RUNTIME_SHIFT core cycles, stack in words
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void send_task_stats(void)
+{
+    static const char * const task_names[] = {
+        PC_TX_TASK_NAME, PC_RX_TASK_NAME, DVS_PIPE_TASK_NAME, 
+        SPINN_TX_TASK_NAME, SPINN_RX_TASK_NAME,
+    };
+    uint8_t resp[TASK_STATS_HDR_LEN + TASK_COUNT * TASK_STATS_ENTRY_LEN];
+    uint8_t *p_resp = resp + TASK_STATS_HDR_LEN;
+    TaskHandle_t task;
+    TaskStatus_t status;
+    uint32_t total_time = cycle_get_runtime();
+    uint8_t count = 0;
+    uint8_t idx, i;
+
+    /* Tasks are looked up one at a time, as the status of every task at
+       once would need more RAM than the whole frame */
+    for (idx = 0; idx < TASK_COUNT; idx++)
+    {
+        /* Application tasks by name, then the kernel's idle and timer */
+        if (idx < sizeof(task_names) / sizeof(task_names[0]))
+        {
+            task = xTaskGetHandle(task_names[idx]);
+        }
+        else if (idx == sizeof(task_names) / sizeof(task_names[0]))
+        {
+            task = xTaskGetIdleTaskHandle();
+        }
+        else
+        {
+            task = xTimerGetTimerDaemonTaskHandle();
+        }
+        if (task == NULL)
+        {
+            continue;
+        }
+
+        vTaskGetInfo(task, &status, pdTRUE, eInvalid);
+        for (i = 0; i < TASK_STATS_NAME_LEN; i++)
+        {
+            *p_resp++ = *status.pcTaskName;
+            if (*status.pcTaskName != '\0')
+            {
+                status.pcTaskName++;
+            }
+        }
+        p_resp = pack_be(p_resp, status.ulRunTimeCounter, 4);
+        p_resp = pack_be(p_resp, status.usStackHighWaterMark, 2);
+        count++;
+    }
+
+    p_resp = pack_be(resp, total_time, 4);
+    p_resp = pack_be(p_resp, RAM_RTOS_BUDGET_BYTES - RAM_RTOS_BYTES, 4);
+    pack_be(p_resp, count, 1);
+
+    pc_send_frame(resp, TASK_STATS_HDR_LEN + count * TASK_STATS_ENTRY_LEN);
+}
+
+/**
+ * DESCRIPTION
+ * Reads value from buffer most significant byte first
+ * 
+ * INPUTS
+ * buf (char*) : Buffer to read from
+ * bytes (uint8_t) : Number of bytes to read
+ *
+ * RETURNS
+ * Value read (uint32_t)
+ */
+static uint32_t unpack_be(char* buf, uint8_t bytes)
+{
+    uint32_t val = 0;
+
+    while (bytes--)
+    {
+        val = (val << 8) | (uint8_t) *buf++;
+    }
+    return val;
+}
+#endif
+
 /*******************************************************************************
  * End of file
  ******************************************************************************/
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "pipe_bench.h"
+#include "os_port.h"
+#include "cycle_count.h"
+#include "dvs_usart.h"
+#include "spinn_channel.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static uint8_t pipe_drained(void);
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+uint32_t pipe_bench_run(uint16_t events)
+{
+    spinn_ring_stats_t stats;
+    dvs_data_t data;
+    uint32_t start, drain_start;
+    uint32_t drain_cycles = (SystemCoreClock / 1000) * PIPE_BENCH_DRAIN_MS;
+    uint32_t cycles;
+    uint16_t i = 0;
+
+    spinn_get_ring_stats(&stats);
+    spinn_set_drop_policy(SPINN_DROP_REJECT);
+
+    start = cycle_get();
+    while (i < events)
+    {
+        data.x = i & 0x7F;
+        data.y = (i >> 7) & 0x7F;
+        data.polarity = (i >> 14) & 0x1;
+
+        /* Let the pipeline run whenever it cannot take the next event */
+        if (dvs_try_put_sim(data))
+        {
+            i++;
+        }
+        else
+        {
+            os_yield();
+        }
+    }
+
+    drain_start = cycle_get();
+    while (!pipe_drained() && cycle_get() - drain_start < drain_cycles)
+    {
+        os_yield();
+    }
+    cycles = pipe_drained() ? cycle_get() - start : 0;
+
+    spinn_set_drop_policy(stats.policy);
+    return cycles;
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Checks whether every event has been through the pipeline and taken from
+ * the transmit queue
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * true if nothing is waiting, false otherwise
+ */
+static uint8_t pipe_drained(void)
+{
+    spinn_ring_stats_t stats;
+
+    spinn_get_ring_stats(&stats);
+    return dvs_pipe_idle() && stats.depth == 0;
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
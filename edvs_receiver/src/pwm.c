@@ -0,0 +1,237 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "pwm.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* Full-scale gain maps the 16-bit value range onto one period */
+#define PWM_GAIN_SHIFT (16)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Value mapping of each channel */
+static pwm_cfg_t pwm_cfg[PWM_CHANNELS];
+
+/* Compare value each channel is moving towards */
+static volatile uint16_t pwm_target[PWM_CHANNELS];
+
+/* Compare register of each channel */
+static volatile uint32_t* const pwm_ccr[PWM_CHANNELS] = {
+    &TIM3->CCR1,
+    &TIM3->CCR2,
+};
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static void hal_init(void);
+static void irq_init(void);
+
+/*******************************************************************************
+ * Public Function Definitions 
+ ******************************************************************************/
+void pwm_config(void)
+{
+    uint8_t channel;
+
+    for (channel = 0; channel < PWM_CHANNELS; channel++)
+    {
+        pwm_cfg[channel].gain = PWM_PERIOD;
+        pwm_cfg[channel].offset = 0;
+        pwm_cfg[channel].min = 0;
+        pwm_cfg[channel].max = PWM_PERIOD;
+        pwm_cfg[channel].slew = 0;
+        pwm_target[channel] = 0;
+    }
+
+    hal_init();
+    irq_init();
+}
+
+uint8_t pwm_set_config(uint8_t channel, pwm_cfg_t* p_cfg)
+{
+    if (channel >= PWM_CHANNELS || p_cfg->min > p_cfg->max || 
+        p_cfg->max > PWM_PERIOD)
+    {
+        return 0;
+    }
+
+    pwm_cfg[channel] = *p_cfg;
+    return 1;
+}
+
+void pwm_get_config(uint8_t channel, pwm_cfg_t* p_cfg)
+{
+    *p_cfg = pwm_cfg[channel];
+}
+
+void pwm_set(uint8_t channel, uint16_t value)
+{
+    pwm_cfg_t *p_cfg = &pwm_cfg[channel];
+    int32_t compare;
+
+    compare = p_cfg->offset + 
+              (((uint32_t) value * p_cfg->gain) >> PWM_GAIN_SHIFT);
+    if (compare < p_cfg->min)
+    {
+        compare = p_cfg->min;
+    }
+    else if (compare > p_cfg->max)
+    {
+        compare = p_cfg->max;
+    }
+
+    pwm_target[channel] = compare;
+
+    if (p_cfg->slew == 0)
+    {
+        /* Preloaded, so the new value starts with the next period */
+        *pwm_ccr[channel] = compare;
+    }
+    else
+    {
+        /* Update interrupt ramps compare value and disables itself once
+           every channel has reached its target */
+        TIM3->DIER |= TIM_DIER_UIE;
+    }
+}
+
+void pwm_get(uint8_t channel, uint16_t* p_target, uint16_t* p_compare)
+{
+    *p_target = pwm_target[channel];
+    *p_compare = *pwm_ccr[channel];
+}
+
+void TIM3_IRQHandler(void)
+{
+    uint8_t channel;
+    uint8_t slewing = 0;
+    uint16_t compare, target, slew;
+
+    if (TIM3->SR & TIM_SR_UIF)
+    {
+        TIM3->SR = (uint16_t) ~TIM_SR_UIF;
+
+        for (channel = 0; channel < PWM_CHANNELS; channel++)
+        {
+            compare = *pwm_ccr[channel];
+            target = pwm_target[channel];
+            slew = pwm_cfg[channel].slew;
+
+            if (slew == 0 || compare == target)
+            {
+                compare = target;
+            }
+            else if (compare < target)
+            {
+                compare = (target - compare > slew) ? compare + slew : target;
+                slewing = 1;
+            }
+            else
+            {
+                compare = (compare - target > slew) ? compare - slew : target;
+                slewing = 1;
+            }
+            *pwm_ccr[channel] = compare;
+        }
+
+        if (!slewing)
+        {
+            TIM3->DIER &= (uint16_t) ~TIM_DIER_UIE;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Configure PA6 and PA7 as TIM3 outputs and start TIM3 in PWM mode
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void hal_init(void)
+{
+    GPIO_InitTypeDef port_init;
+    TIM_TimeBaseInitTypeDef tim_init;
+    TIM_OCInitTypeDef oc_init;
+
+    RCC_AHBPeriphClockCmd( RCC_AHBPeriph_GPIOA, ENABLE );
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+
+    port_init.GPIO_Pin = GPIO_Pin_6 | GPIO_Pin_7;
+    port_init.GPIO_Mode = GPIO_Mode_AF;
+    port_init.GPIO_Speed = GPIO_Speed_50MHz;
+    port_init.GPIO_OType = GPIO_OType_PP;
+    port_init.GPIO_PuPd = GPIO_PuPd_NOPULL;
+    GPIO_Init( GPIOA, &port_init );
+    GPIO_PinAFConfig(GPIOA, GPIO_PinSource6, GPIO_AF_1);
+    GPIO_PinAFConfig(GPIOA, GPIO_PinSource7, GPIO_AF_1);
+
+    TIM_TimeBaseStructInit(&tim_init);
+    tim_init.TIM_Prescaler = 0;
+    tim_init.TIM_Period = PWM_PERIOD - 1;
+    tim_init.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(TIM3, &tim_init);
+
+    /* Outputs start off; compare values are preloaded so that a change
+       never cuts a period short */
+    TIM_OCStructInit(&oc_init);
+    oc_init.TIM_OCMode = TIM_OCMode_PWM1;
+    oc_init.TIM_OutputState = TIM_OutputState_Enable;
+    oc_init.TIM_Pulse = 0;
+    oc_init.TIM_OCPolarity = TIM_OCPolarity_High;
+    TIM_OC1Init(TIM3, &oc_init);
+    TIM_OC2Init(TIM3, &oc_init);
+    TIM_OC1PreloadConfig(TIM3, TIM_OCPreload_Enable);
+    TIM_OC2PreloadConfig(TIM3, TIM_OCPreload_Enable);
+    TIM_ARRPreloadConfig(TIM3, ENABLE);
+
+    TIM_Cmd(TIM3, ENABLE);
+}
+
+/**
+ * DESCRIPTION
+ * Configure update interrupt used for slewing; only enabled while a channel
+ * is moving towards its target
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void irq_init(void)
+{
+    NVIC_InitTypeDef nvic;
+
+    nvic.NVIC_IRQChannel = TIM3_IRQn;
+    nvic.NVIC_IRQChannelPriority = 2;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+
+    TIM_ClearITPendingBit(TIM3, TIM_IT_Update);
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
@@ -0,0 +1,286 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "spinn_channel.h"
+#include "spinn_codec.h"
+#include "spinn_ring.h"
+#include "spinn_link.h"
+#include "trace.h"
+#include "cycle_count.h"
+#include "os_port.h"
+#include "ram_code.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* Time to wait for SpiNNaker to acknowledge a symbol before the link is
+   considered stalled, and time to wait for a stalled link to respond to each
+   attempt to restart it, as for the transmit task of the FreeRTOS build */
+#define SPINN_ACK_TIMEOUT_MS (10)
+#define SPINN_PROBE_MS       (100)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Ring of mapped events to be packed and sent. The super-loop produces, and
+   the acknowledge interrupt consumes, with the super-loop only taking over
+   as consumer with interrupts masked */
+static spinn_ring_t spinn_txr;
+
+/* Packet being sent, and index of the next symbol to write */
+static uint8_t spinn_pkt_buf[SPINN_LONG_SYMS];
+static volatile uint8_t spinn_pkt_len = 0;
+static volatile uint8_t spinn_pkt_idx = 0;
+
+/* Whether the last symbol written has been acknowledged, so that the next
+   can be written, and cycle count when it was written */
+static volatile uint8_t spinn_tx_ready = true;
+static volatile uint32_t spinn_tx_stamp = 0;
+
+/* False while SpiNNaker is not acknowledging */
+static volatile uint8_t spinn_link_up = true;
+
+/* Packets are decoded and checked by the super-loop instead of being sent
+   while set. Counters only written by the super-loop */
+static volatile uint8_t spinn_loopback_flag = false;
+static spinn_loop_stats_t spinn_loop_stats;
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static void spinn_tx_next(void);
+static void spinn_loop_drain(void);
+
+/*******************************************************************************
+ * Public Function Definitions 
+ ******************************************************************************/
+void spinn_config(void)
+{
+    /* Derive packet header and tail from chip address */
+    spinn_codec_set_address(SPINN_CHIP_ADDRESS);
+    spinn_codec_set_mode(DVS_RES_128);
+
+    /* Empty ring for mapped events waiting to be sent */
+    spinn_ring_init(&spinn_txr, SPINN_DROP_OLDEST);
+
+    spinn_link_config();
+}
+
+uint8_t spinn_send_dvs(dvs_data_t* p_data)
+{
+    uint16_t event = spinn_codec_map_event(p_data);
+    spinn_push_t result;
+
+    /* Queue mapped event; sent once the link is free. What happens when the
+       ring is full depends on the drop policy */
+    result = spinn_ring_push(&spinn_txr, event);
+    if (result == SPINN_PUSH_REJECTED)
+    {
+        return false;
+    }
+    trace_rec(result == SPINN_PUSH_OK ? TRACE_QUEUE_SEND : TRACE_DROP,
+              result == SPINN_PUSH_OK ? TRACE_Q_SPINN_TX : TRACE_DROP_SPINN_TX,
+              event);
+    return true;
+}
+
+void spinn_set_mode(dvs_res_t mode)
+{
+    spinn_codec_set_mode(mode);
+}
+
+void spinn_set_drop_policy(spinn_drop_t policy)
+{
+    spinn_ring_set_policy(&spinn_txr, policy);
+}
+
+void spinn_get_ring_stats(spinn_ring_stats_t* p_stats)
+{
+    spinn_ring_get_stats(&spinn_txr, p_stats);
+}
+
+void spinn_set_loopback(uint8_t loopback)
+{
+    if (loopback)
+    {
+        memset(&spinn_loop_stats, 0, sizeof(spinn_loop_stats));
+    }
+    spinn_loopback_flag = loopback;
+}
+
+void spinn_get_loop_stats(spinn_loop_stats_t* p_stats)
+{
+    *p_stats = spinn_loop_stats;
+}
+
+RAM_CODE
+void spinn_tx_ack_from_isr(os_base_t* p_woken)
+{
+    (void) p_woken;
+
+    /* Send the next symbol straight from the interrupt, which has no task to
+       hand over to */
+    spinn_link_up = true;
+    spinn_tx_ready = true;
+    spinn_tx_next();
+}
+
+void spinn_rx_edge_from_isr(os_base_t* p_woken)
+{
+    /* Packets from SpiNNaker are not handled by this build */
+    (void) p_woken;
+}
+
+void spinn_poll(void)
+{
+    uint32_t timeout_ms;
+
+    if (spinn_loopback_flag)
+    {
+        spinn_loop_drain();
+        return;
+    }
+
+    os_enter_critical();
+    if (spinn_tx_ready)
+    {
+        /* Link idle, so start on anything queued since it went idle */
+        spinn_tx_next();
+    }
+    else
+    {
+        timeout_ms = spinn_link_up ? SPINN_ACK_TIMEOUT_MS : SPINN_PROBE_MS;
+        if (cycle_get() - spinn_tx_stamp > 
+            timeout_ms * (SystemCoreClock / 1000))
+        {
+            /* Stalled; abandon the packet, then restart the link with an EOP
+               as the transmit task of the FreeRTOS build does. SpiNNaker
+               acknowledging it sends whatever has been queued meanwhile */
+            spinn_link_up = false;
+            spinn_pkt_idx = spinn_pkt_len;
+            spinn_link_tx_resync();
+            spinn_tx_stamp = cycle_get();
+            spinn_link_tx_sym(SPINN_SYM_EOP);
+        }
+    }
+    os_exit_critical();
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Writes the next symbol to the link, first packing queued events into a new
+ * packet if the last has been sent. Events queued behind a busy link are
+ * carried in the payload of the same packet. Acknowledge interrupt, or with
+ * interrupts masked, only
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+RAM_CODE
+static void spinn_tx_next(void)
+{
+    uint16_t events[SPINN_MAX_PKT_EVENTS];
+    uint8_t event_count = 0;
+
+    if (spinn_pkt_idx == spinn_pkt_len)
+    {
+        while (event_count < SPINN_MAX_PKT_EVENTS &&
+               spinn_ring_pop(&spinn_txr, &events[event_count]))
+        {
+            trace_rec(TRACE_QUEUE_RECV, TRACE_Q_SPINN_TX, events[event_count]);
+            event_count++;
+        }
+        if (event_count == 0)
+        {
+            /* Nothing queued; stay ready for the super-loop to restart */
+            return;
+        }
+        spinn_pkt_len = spinn_codec_encode_events(events, event_count, 
+                                                  spinn_pkt_buf);
+        trace_rec(TRACE_PACKET_QUEUED, event_count, spinn_pkt_len);
+        spinn_pkt_idx = 0;
+    }
+
+    spinn_tx_ready = false;
+    spinn_tx_stamp = cycle_get();
+    spinn_link_tx_sym(spinn_pkt_buf[spinn_pkt_idx++]);
+}
+
+/**
+ * DESCRIPTION
+ * Packs everything queued into packets as the acknowledge interrupt would,
+ * but decodes each straight back and checks it carries the events it was
+ * encoded from rather than sending it. This build has no receive path to
+ * route packets to. Super-loop only
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void spinn_loop_drain(void)
+{
+    uint16_t events[SPINN_MAX_PKT_EVENTS];
+    uint8_t pkt_buf[SPINN_LONG_SYMS];
+    spinn_packet_t pkt;
+    uint8_t event_count;
+    uint8_t pkt_len;
+
+    do
+    {
+        /* A late acknowledge could otherwise take events from under the
+           super-loop */
+        event_count = 0;
+        os_enter_critical();
+        while (event_count < SPINN_MAX_PKT_EVENTS &&
+               spinn_ring_pop(&spinn_txr, &events[event_count]))
+        {
+            trace_rec(TRACE_QUEUE_RECV, TRACE_Q_SPINN_TX, events[event_count]);
+            event_count++;
+        }
+        os_exit_critical();
+
+        if (event_count > 0)
+        {
+            pkt_len = spinn_codec_encode_events(events, event_count, 
+                                                pkt_buf);
+            trace_rec(TRACE_PACKET_QUEUED, event_count, pkt_len);
+            if (spinn_codec_decode(pkt_buf, pkt_len, &pkt) == 
+                    SPINN_DECODE_OK &&
+                spinn_codec_matches(&pkt, events, event_count))
+            {
+                spinn_loop_stats.packets++;
+                spinn_loop_stats.events += event_count;
+            }
+            else
+            {
+                spinn_loop_stats.errors++;
+            }
+        }
+    } while (event_count == SPINN_MAX_PKT_EVENTS);
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
@@ -11,25 +11,43 @@
 #include "stm32f0xx.h"
 
 #include <stdbool.h>
+#include <string.h>
 
 /*******************************************************************************
  * Local Includes
  ******************************************************************************/
 #include "spinn_channel.h"
+#include "spinn_codec.h"
+#include "spinn_ring.h"
+#include "spinn_link.h"
+#include "trace.h"
+#include "spinn_route.h"
 #include "pc_usart.h"
+#include "task_config.h"
+#include "wake_stats.h"
 
 /*******************************************************************************
  * Local Definitions
  ******************************************************************************/
-#define SPINN_SHORT_SYMS (11)
-#define SPINN_LONG_SYMS  (19)
-#define BUFFER_LENGTH    (20)
-#define EOP_IDX          (16)
-
 #define SPINN_TIMER_NAME "rst_spinn"
 
 #define SPINN_TX_PRIORITY (1)
 
+/* Default time to wait for SpiNNaker to acknowledge a symbol before the link
+   is considered stalled, and time to wait for a stalled link to respond to
+   each attempt to restart it */
+#define SPINN_ACK_TIMEOUT_MS (10)
+#define SPINN_PROBE_MS       (100)
+
+/* Receive buffer length; room for the longest packet with margin, beyond
+   which a packet with a lost EOP is discarded */
+#define SPINN_RX_BUF_SYMS    (SPINN_SHORT_SYMS * 2)
+
+/* Packets mirrored to the PC are batched into frames of a header of packet
+   count, packets dropped before this frame and tick of the first packet,
+   followed by a length byte and the symbols of each packet */
+#define SPINN_TAP_HDR_LEN    (7)
+
 /*******************************************************************************
  * Local Type and Enum definitions
  ******************************************************************************/
@@ -38,70 +56,101 @@
 /*******************************************************************************
  * Global Variable Declarations
  ******************************************************************************/
-/* Semaphore for transmitting next symbol */
-xSemaphoreHandle xSpinnTxSemaphore = NULL;
-/* Semaphore for waiting until a symbol has been received */
-xSemaphoreHandle xSpinnRxSemaphore = NULL;
-
+/* None */
 
 /*******************************************************************************
  * Local Variable Declarations
  ******************************************************************************/
-/* Queue for channel packets */
-static xQueueHandle spinn_txq;
-
-/* Flag/semaphore for PC forwarding */
-static xSemaphoreHandle spinFwdSemaphore = NULL;
-static uint8_t spinn_fwd_pc_flag = false;
-
-static xSemaphoreHandle spinFwdRxSemaphore = NULL;
-static uint8_t spinn_fwd_rx_pc_flag = false;
+/* Ring of mapped events to be packed and sent, and semaphore to wake the
+   transmit task when the ring has been refilled */
+static spinn_ring_t spinn_txr;
+static xSemaphoreHandle spinTxWakeSemaphore = NULL;
+
+/* Flags for PC forwarding; single bytes, so each is read and written
+   atomically and needs no lock */
+static volatile uint8_t spinn_fwd_pc_flag = false;
+static volatile uint8_t spinn_tap_pc_flag = false;
+static volatile uint8_t spinn_fwd_rx_pc_flag = false;
+static volatile uint8_t spinn_loopback_flag = false;
+
+/* Tasks signalled directly by the EXTI interrupt; acknowledges are given to
+   the transmit task and data pin edges to the receive task */
+static TaskHandle_t spinn_tx_handle = NULL;
+static TaskHandle_t spinn_rx_handle = NULL;
 
 /* Timer for resetting forwarding after timeout */
 static TimerHandle_t spinn_reset_timer = NULL;
 static TimerHandle_t spinn_rx_reset_timer = NULL;
 
-/* Symbol encoding table for 2-of-7 format */
-static uint8_t symbol_table[] = 
-{
-    0x11, 0x12, 0x14, 0x18, 0x21, 0x22, 0x24, 0x28,
-    0x41, 0x42, 0x44, 0x48, 0x03, 0x06, 0x0C, 0x09, 0x60
-};
+/* Static storage for RTOS objects */
+static StaticTimer_t spinn_reset_timer_obj, spinn_rx_reset_timer_obj;
+static StaticSemaphore_t spinn_tx_wake_sem_obj;
+static StackType_t spinn_tx_stack[SPINN_TX_STACK_WORDS];
+static StackType_t spinn_rx_stack[SPINN_RX_STACK_WORDS];
+static StaticTask_t spinn_tx_tcb, spinn_rx_tcb;
 
-/* Current mode of sending data */
-static dvs_res_t dvs_res = DVS_RES_128;
+/* Maximum number of queued events to pack into one packet */
+static uint8_t spinn_pkt_events = SPINN_MAX_PKT_EVENTS;
 
-/* Virtual chip address symbols to queue */
-static uint8_t virtual_chip_address[] = {0x00, 0x02, 0x00, 0x00};
-static uint8_t virtual_chip_symbols[] = {0x11, 0x14, 0x11, 0x11};
+/* Acknowledge timeout in ms, or 0 to wait forever */
+static uint16_t spinn_ack_timeout_ms = SPINN_ACK_TIMEOUT_MS;
 
-/* Previous data byte for XORing due to lack of ToggleBits function */
-static uint8_t prev_data = 0x00;
+/* Link state and stall counters; only written by the transmit task */
+static spinn_link_stats_t spinn_link_stats;
+static TickType_t spinn_stall_start = 0;
+
+/* Received packet counters; written by the receive task, by the transmit
+   task in loopback and by packets injected from the PC, so updated in
+   critical sections */
+static spinn_rx_stats_t spinn_rx_stats;
+
+/* Looped back packet counters; only written by the transmit task, and
+   cleared before it loops packets back */
+static spinn_loop_stats_t spinn_loop_stats;
+
+/* Batch of packets being mirrored to the PC; only used by the transmit
+   task */
+static uint8_t spinn_tap_buf[SPINN_TAP_BUF_LEN];
+static uint8_t spinn_tap_len = 0;
+static uint8_t spinn_tap_count = 0;
+static uint16_t spinn_tap_dropped = 0;
+static TickType_t spinn_tap_tick = 0;
 
 
 
 /*******************************************************************************
  * Private Function Declarations (static)
  ******************************************************************************/
-static void hal_init(void);
-static void irq_init(void);
 static void tasks_init(void);
 
 static void spinn_reset_fwd_flag(TimerHandle_t timer);
 
 static void spinn_tx_task(void *pvParameters);
+static uint8_t spinn_wait_ack(void);
+static void spinn_restart_link(void);
+static void spinn_tap_add(uint8_t* p_pkt, uint8_t len, uint8_t block);
+static void spinn_tap_flush(uint8_t block);
+static void spinn_loop_packet(uint16_t* p_events, uint8_t count,
+                              uint8_t* p_pkt, uint8_t len);
 static void spinn_rx_task(void *pvParameters);
+static uint8_t spinn_rx_decode(uint8_t* buf, uint8_t len, 
+                               spinn_packet_t* p_pkt);
+static void spinn_rx_deliver(spinn_packet_t* p_pkt);
+static uint8_t spinn_rx_next(void);
 
 static void spinn_reset_fwd_rx_flag(TimerHandle_t timer);
-static uint8_t spinn_lookup_sym(uint8_t sym);
 
 /*******************************************************************************
  * Public Function Definitions 
  ******************************************************************************/
 void spinn_config(void)
 {
-    hal_init();
-    irq_init();
+    /* Derive packet header and tail from chip address */
+    spinn_codec_set_address(SPINN_CHIP_ADDRESS);
+    spinn_codec_set_mode(DVS_RES_128);
+
+    spinn_link_config();
+    spinn_route_config();
     tasks_init();
 }
 
@@ -110,21 +159,12 @@ void spinn_forward_pc(uint8_t forward, uint16_t timeout_ms)
     if (forward == true)
     {
         /* Set forwarding to true */
-        if (xSemaphoreTake(spinFwdSemaphore, portMAX_DELAY) == pdTRUE)
+        spinn_fwd_pc_flag = true;
+        if (timeout_ms > 0)
         {
-            spinn_fwd_pc_flag = true;
-            if (timeout_ms > 0)
-            {
-                /* Set up a timeout to cancel the forwarding */
-                xTimerChangePeriod(spinn_reset_timer, timeout_ms, 
-                                   portMAX_DELAY);
-
-            }
-            xSemaphoreGive(spinFwdSemaphore);
+            /* Set up a timeout to cancel the forwarding */
+            xTimerChangePeriod(spinn_reset_timer, timeout_ms, portMAX_DELAY);
         }
-
-        /* Give semaphore such that task knows to continue */
-        xSemaphoreGive(xSpinnTxSemaphore);
     }
     else
     {
@@ -134,99 +174,80 @@ void spinn_forward_pc(uint8_t forward, uint16_t timeout_ms)
             xTimerStop(spinn_reset_timer, portMAX_DELAY);
         }
         spinn_reset_fwd_flag(NULL);
-        /* Take semaphore such that task waits for interrupt */
-        /* Only wait 100ms in case semaphore has not previously been given */
-        xSemaphoreTake(xSpinnTxSemaphore, 100);
     }
 }
 
-void spinn_send_dvs(dvs_data_t* p_data)
+void spinn_tap_pc(uint8_t tap)
 {
-    uint8_t pkt_buf[SPINN_SHORT_SYMS];
-    uint8_t* pkt_buf_p = pkt_buf;
+    spinn_tap_pc_flag = tap;
+}
 
-    /* Queue each item in order of sending */
-    uint8_t odd_parity = 0;
-    uint8_t xor_all = 0;
-    uint8_t tmp_byte = 0;
-    uint16_t mapped_event;
+uint8_t spinn_send_dvs(dvs_data_t* p_data)
+{
+    uint16_t event = spinn_codec_map_event(p_data);
+    spinn_push_t result;
 
-    /* If queue is not empty, delete earliest entry */
-    if (uxQueueSpacesAvailable(spinn_txq) == 0)
+    /* Queue mapped event; transmit task packs queued events into packets.
+       What happens when the ring is full depends on the drop policy */
+    result = spinn_ring_push(&spinn_txr, event);
+    if (result == SPINN_PUSH_REJECTED)
     {
-        xQueueReceive(spinn_txq, pkt_buf, portMAX_DELAY);
+        return false;
     }
+    trace_rec(result == SPINN_PUSH_OK ? TRACE_QUEUE_SEND : TRACE_DROP,
+              result == SPINN_PUSH_OK ? TRACE_Q_SPINN_TX : TRACE_DROP_SPINN_TX,
+              event);
 
-    mapped_event = 0x8000 + ((p_data->polarity & 0x1) << 14);
+    /* Binary semaphore, so giving while already given is harmless */
+    xSemaphoreGive(spinTxWakeSemaphore);
+    return true;
+}
 
-    switch (dvs_res)
-    {
-        case DVS_RES_64:
-            mapped_event += ((p_data->y & 0x7E) << 5);
-            mapped_event += ((p_data->x & 0x7E) >> 1);
-            break;
-        case DVS_RES_32:
-            mapped_event += ((p_data->y & 0x7C) << 3);
-            mapped_event += ((p_data->x & 0x7C) >> 2);
-            break;
-        case DVS_RES_16:
-            mapped_event += ((p_data->y & 0x78) << 1);
-            mapped_event += ((p_data->x & 0x78) >> 3);
-            break;
-        case DVS_RES_128:
-        default:
-            mapped_event += ((p_data->y & 0x7F) << 7);
-            mapped_event +=  (p_data->x & 0x7F);
-            break;
-    }
+void spinn_set_mode(dvs_res_t mode)
+{
+    spinn_codec_set_mode(mode);
+}
 
-    /* Calculate parity */
-    xor_all = virtual_chip_address[3] ^ virtual_chip_address[2] ^ 
-              virtual_chip_address[1] ^ virtual_chip_address[0] ^
-              ((mapped_event & 0xFF00) >> 8) ^ (mapped_event & 0xFF);
-    odd_parity = 1 ^ ((xor_all & 0x80) >> 7) ^ ((xor_all & 0x40) >> 6) ^
-                     ((xor_all & 0x20) >> 5) ^ ((xor_all & 0x10) >> 4) ^
-                     ((xor_all & 0x08) >> 3) ^ ((xor_all & 0x04) >> 2) ^
-                     ((xor_all & 0x02) >> 1) ^ (xor_all & 0x01);
-
-    /* Add header to buffer */
-    *pkt_buf_p = symbol_table[odd_parity];
-    pkt_buf_p++;
-    *pkt_buf_p = symbol_table[0];
-    pkt_buf_p++;
-
-    /* Add data to buffer */
-    tmp_byte =  (mapped_event & 0x000F);
-    *pkt_buf_p = symbol_table[tmp_byte];
-    pkt_buf_p++;
-    tmp_byte = ((mapped_event & 0x00F0) >> 4);
-    *pkt_buf_p = symbol_table[tmp_byte];
-    pkt_buf_p++;
-    tmp_byte = ((mapped_event & 0x0F00) >> 8);
-    *pkt_buf_p = symbol_table[tmp_byte];
-    pkt_buf_p++;
-    tmp_byte = ((mapped_event & 0xF000) >> 12);
-    *pkt_buf_p = symbol_table[tmp_byte];
-    pkt_buf_p++;
-
-    /* Fill the remaining buffer space with chip address and EOP */
-    for (int8_t i = 3; i >= 0; i--)
-    {
-        *pkt_buf_p = virtual_chip_symbols[i];
-        pkt_buf_p++;
-    }
+void spinn_set_packing(uint8_t events)
+{
+    spinn_pkt_events = events;
+}
 
-    *pkt_buf_p = symbol_table[EOP_IDX];
-    pkt_buf_p++;
+void spinn_set_drop_policy(spinn_drop_t policy)
+{
+    spinn_ring_set_policy(&spinn_txr, policy);
+}
 
-    /* Add entire buffer to queue as a packet */
-    xQueueSendToBack(spinn_txq, pkt_buf, portMAX_DELAY);
+void spinn_get_ring_stats(spinn_ring_stats_t* p_stats)
+{
+    spinn_ring_get_stats(&spinn_txr, p_stats);
+}
 
+void spinn_set_ack_timeout(uint16_t timeout_ms)
+{
+    spinn_ack_timeout_ms = timeout_ms;
 }
 
-void spinn_set_mode(dvs_res_t mode)
+void spinn_get_settings(spinn_settings_t* p_settings)
 {
-    dvs_res = mode;
+    p_settings->fwd_pc = spinn_fwd_pc_flag;
+    p_settings->tap_pc = spinn_tap_pc_flag;
+    p_settings->fwd_rx_pc = spinn_fwd_rx_pc_flag;
+    p_settings->pkt_events = spinn_pkt_events;
+    p_settings->policy = spinn_txr.policy;
+    p_settings->ack_timeout_ms = spinn_ack_timeout_ms;
+}
+
+void spinn_get_link_stats(spinn_link_stats_t* p_stats)
+{
+    *p_stats = spinn_link_stats;
+
+    /* Report how long the link has currently been stalled for */
+    if (!p_stats->up)
+    {
+        p_stats->down_ms = (xTaskGetTickCount() - spinn_stall_start) * 
+                           portTICK_PERIOD_MS;
+    }
 }
 
 void spinn_forward_rx_pc(uint8_t forward, uint16_t timeout_ms)
@@ -234,17 +255,12 @@ void spinn_forward_rx_pc(uint8_t forward, uint16_t timeout_ms)
     if (forward == true)
     {
         /* Set forwarding to true */
-        if (xSemaphoreTake(spinFwdRxSemaphore, portMAX_DELAY) == pdTRUE)
+        spinn_fwd_rx_pc_flag = true;
+        if (timeout_ms > 0)
         {
-            spinn_fwd_rx_pc_flag = true;
-            if (timeout_ms > 0)
-            {
-                /* Set up a timeout to cancel the forwarding */
-                xTimerChangePeriod(spinn_rx_reset_timer, timeout_ms, 
-                                   portMAX_DELAY);
-
-            }
-            xSemaphoreGive(spinFwdRxSemaphore);
+            /* Set up a timeout to cancel the forwarding */
+            xTimerChangePeriod(spinn_rx_reset_timer, timeout_ms, 
+                               portMAX_DELAY);
         }
     }
     else
@@ -258,152 +274,72 @@ void spinn_forward_rx_pc(uint8_t forward, uint16_t timeout_ms)
     }
 }
 
-void spinn_use_data(uint8_t *buf)
+void spinn_use_data(uint8_t *buf, uint8_t len)
 {
-    uint16_t speed = 0;
-    uint8_t speed_syms[4];
-
-    /* Decode buffer and get motor data */
-    speed_syms[0] = spinn_lookup_sym(buf[2]);
-    speed_syms[1] = spinn_lookup_sym(buf[3]);
-    speed_syms[2] = spinn_lookup_sym(buf[4]);
-    speed_syms[3] = spinn_lookup_sym(buf[5]);
-    if (speed_syms[0] >= sizeof(symbol_table) || 
-        speed_syms[1] >= sizeof(symbol_table) || 
-        speed_syms[2] >= sizeof(symbol_table) || 
-        speed_syms[3] >= sizeof(symbol_table))
+    spinn_packet_t pkt;
+
+    if (spinn_rx_decode(buf, len, &pkt))
     {
-        /* Received a symbol in error; return early */
-        return;
+        spinn_rx_deliver(&pkt);
     }
-    speed = speed_syms[0] +
-            (speed_syms[1] << 4) +
-            (speed_syms[2] << 8) +
-            (speed_syms[3] << 12);
+}
 
-    /* Thread-safe check of whether to forward */
-    if (pdTRUE == xSemaphoreTake(spinFwdRxSemaphore, portMAX_DELAY))
+void spinn_set_loopback(uint8_t loopback)
+{
+    if (loopback)
     {
-        /* If forwarding, send to PC */
-        if (spinn_fwd_rx_pc_flag)
-        {
-            pc_send_byte((speed & 0xFF00) >> 8);
-            pc_send_byte(speed & 0x00FF);
-            pc_send_byte('\r');
-        }
-        else
-        {
-            /* Currently no motor PWM signal set up, so ignore */
-        }
-        xSemaphoreGive(spinFwdRxSemaphore);
+        memset(&spinn_loop_stats, 0, sizeof(spinn_loop_stats));
     }
+    spinn_loopback_flag = loopback;
 }
 
+void spinn_get_loop_stats(spinn_loop_stats_t* p_stats)
+{
+    *p_stats = spinn_loop_stats;
+}
 
-/*******************************************************************************
- * Private Function Definitions (static)
- ******************************************************************************/
-
+void spinn_get_rx_stats(spinn_rx_stats_t* p_stats, uint8_t reset)
+{
+    taskENTER_CRITICAL();
+    *p_stats = spinn_rx_stats;
+    if (reset)
+    {
+        memset(&spinn_rx_stats, 0, sizeof(spinn_rx_stats));
+    }
+    taskEXIT_CRITICAL();
+}
 
-/**
- * DESCRIPTION
- * Configure hardware for SpiNNaker connection
- * 
- * INPUTS
- * None
- *
- * RETURNS
- * Nothing
- */
-static void hal_init(void)
+void spinn_tx_ack_from_isr(os_base_t* p_woken)
 {
-    GPIO_InitTypeDef port_init;
-
-    /* Enable clock on GPIO pins */
-    RCC_AHBPeriphClockCmd( RCC_AHBPeriph_GPIOB, ENABLE );
-    RCC_AHBPeriphClockCmd( RCC_AHBPeriph_GPIOC, ENABLE );
-
-    /* Configure pins with given properties */
-    port_init.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_2 | GPIO_Pin_3 | 
-                         GPIO_Pin_4 | GPIO_Pin_5 | GPIO_Pin_6 | GPIO_Pin_15;
-    port_init.GPIO_Mode = GPIO_Mode_OUT; /* Output Mode */
-    port_init.GPIO_Speed = GPIO_Speed_50MHz; /* Highest speed pins */
-    port_init.GPIO_OType = GPIO_OType_PP;   /* Output type push pull */
-    port_init.GPIO_PuPd = GPIO_PuPd_UP;     /* Pull up */
-    GPIO_Init( GPIOB, &port_init );
-
-    /* Set up B7 as an input */
-    port_init.GPIO_Pin = GPIO_Pin_7  | GPIO_Pin_8  | GPIO_Pin_9  | GPIO_Pin_10 |
-                         GPIO_Pin_11 | GPIO_Pin_12 | GPIO_Pin_13 | GPIO_Pin_14;
-    port_init.GPIO_Mode = GPIO_Mode_IN; /* Input mode */
-    port_init.GPIO_Speed = GPIO_Speed_50MHz; /* Highest speed */
-    /* Other parameters remain the same */
-    GPIO_Init(GPIOB, &port_init);
-
-    /* Set up PF0 and PF1 as outputs, already enabled, enable level shifters */
-    port_init.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1;
-    port_init.GPIO_Mode = GPIO_Mode_OUT;
-    port_init.GPIO_Speed = GPIO_Speed_2MHz;
-    port_init.GPIO_OType = GPIO_OType_PP;
-    port_init.GPIO_PuPd = GPIO_PuPd_UP;
-    GPIO_Init( GPIOC, &port_init );
-
-    /* Ensure bits are all reset */
-    GPIO_Write(GPIOB, 0);
-
-    /* Ensure level shifters are enabled */
-    GPIO_WriteBit(GPIOC, GPIO_Pin_0, Bit_SET);
-    GPIO_WriteBit(GPIOC, GPIO_Pin_1, Bit_SET);
+    BaseType_t woken = pdFALSE;
 
+    /* Edges can arrive while the link is configured, before the task
+       exists */
+    if (spinn_tx_handle != NULL)
+    {
+        vTaskNotifyGiveFromISR(spinn_tx_handle, &woken);
+        wake_isr_stamp(WAKE_SPINN_TX_ACK, woken);
+        *p_woken |= woken;
+    }
 }
 
-/**
- * DESCRIPTION
- * Configure ISRs for SpiNNaker connection
- * 
- * INPUTS
- * None
- *
- * RETURNS
- * Nothing
- */
-static void irq_init(void)
+void spinn_rx_edge_from_isr(os_base_t* p_woken)
 {
+    BaseType_t woken = pdFALSE;
 
-    EXTI_InitTypeDef exti;
-    NVIC_InitTypeDef nvic;
-
-    /* Configure external interrupt */
-
-    /* Ensure peripheral clock is configured */
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE); 
-
-    /* Map all pins into interrupt */
-    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource7);
-    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource8);
-    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource9);
-    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource10);
-    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource11);
-    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource12);
-    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource13);
-    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource14);
-
-    exti.EXTI_Line = EXTI_Line7  | EXTI_Line8  | EXTI_Line9  | EXTI_Line10 | 
-                     EXTI_Line11 | EXTI_Line12 | EXTI_Line13 | EXTI_Line14;
-    exti.EXTI_Mode = EXTI_Mode_Interrupt;
-    /* Signals are transitions, so rising or falling edge */
-    exti.EXTI_Trigger = EXTI_Trigger_Rising_Falling;
-    exti.EXTI_LineCmd = ENABLE;
-    EXTI_Init(&exti);
-
-    /* Configure interrupt register */
-    nvic.NVIC_IRQChannel = EXTI4_15_IRQn;
-    nvic.NVIC_IRQChannelPriority = 5;
-    nvic.NVIC_IRQChannelCmd = ENABLE;
-    NVIC_Init(&nvic);
-
+    if (spinn_rx_handle != NULL)
+    {
+        vTaskNotifyGiveFromISR(spinn_rx_handle, &woken);
+        wake_isr_stamp(WAKE_SPINN_RX_EDGE, woken);
+        *p_woken |= woken;
+    }
 }
 
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+
 /**
  * DESCRIPTION
  * Initialise task and start running
@@ -417,42 +353,43 @@ static void irq_init(void)
 static void tasks_init(void)
 {
     /* Create timer for resetting to task */
-    spinn_reset_timer = xTimerCreate(SPINN_TIMER_NAME,  /* timer name */
+    spinn_reset_timer = xTimerCreateStatic(SPINN_TIMER_NAME,  /* timer name */
                                      100,               /* timer period */
                                      pdFALSE,           /* auto-reload */
                                      (void*) 0,         /* no id specified */
-                                     spinn_reset_fwd_flag);   /* callback function */
-    spinn_rx_reset_timer = xTimerCreate("spn_rx_timer",  /* timer name */
+                                     spinn_reset_fwd_flag,    /* callback */
+                                     &spinn_reset_timer_obj); /* storage */
+    spinn_rx_reset_timer = xTimerCreateStatic("spn_rx_timer", /* timer name */
                                      100,               /* timer period */
                                      pdFALSE,           /* auto-reload */
                                      (void*) 0,         /* no id specified */
-                                     spinn_reset_fwd_rx_flag);   /* callback function */
-
-    /* Create semaphore for forwarding */
-    spinFwdSemaphore = xSemaphoreCreateBinary();
-    xSemaphoreGive(spinFwdSemaphore);
-    spinFwdRxSemaphore = xSemaphoreCreateBinary();
-    xSemaphoreGive(spinFwdRxSemaphore);
-
-    /* Create semaphore for transmission and give to transmit first symbol */
-    xSpinnTxSemaphore = xSemaphoreCreateBinary();
-    /* First give so that we wait on the queue, not the semaphore, as the
-       semaphore will only be given once the first symbol is acknowledged */
-    xSemaphoreGive(xSpinnTxSemaphore);
-
-    /* Create semaphore to count transitions on the GPIO */
-    xSpinnRxSemaphore = xSemaphoreCreateCounting(8, 0);
+                                     spinn_reset_fwd_rx_flag,    /* callback */
+                                     &spinn_rx_reset_timer_obj); /* storage */
 
     /* Create task for acting upon queued data */
-    xTaskCreate(spinn_tx_task, (char const *)"txSpn", configMINIMAL_STACK_SIZE, 
-                (void *)NULL, tskIDLE_PRIORITY + SPINN_TX_PRIORITY, NULL);
-
-    /* Create a task to listen for new SpiNNaker data */
-    xTaskCreate(spinn_rx_task, (char const *)"rxSpn", configMINIMAL_STACK_SIZE, 
-                (void *)NULL, tskIDLE_PRIORITY, NULL);
-
-    /* Create queue for SpiNN packet data */
-    spinn_txq = xQueueCreate(BUFFER_LENGTH, SPINN_SHORT_SYMS * sizeof(uint8_t));
+    spinn_tx_handle = xTaskCreateStatic(spinn_tx_task, 
+                                        (char const *)SPINN_TX_TASK_NAME, 
+                                        SPINN_TX_STACK_WORDS, (void *)NULL, 
+                                        tskIDLE_PRIORITY + SPINN_TX_PRIORITY,
+                                        spinn_tx_stack, &spinn_tx_tcb);
+    /* Acknowledges are notified to the transmit task; notify once up front
+       so that the first symbol waits on the ring, not an acknowledge */
+    xTaskNotifyGive(spinn_tx_handle);
+
+    /* Create a task to listen for new SpiNNaker data, notified of each edge
+       on the data pins */
+    spinn_rx_handle = xTaskCreateStatic(spinn_rx_task, 
+                                        (char const *)SPINN_RX_TASK_NAME, 
+                                        SPINN_RX_STACK_WORDS, (void *)NULL, 
+                                        tskIDLE_PRIORITY, spinn_rx_stack, 
+                                        &spinn_rx_tcb);
+
+    /* Link is assumed up until an acknowledge times out */
+    spinn_link_stats.up = true;
+
+    /* Empty ring for mapped events waiting to be sent */
+    spinn_ring_init(&spinn_txr, SPINN_DROP_OLDEST);
+    spinTxWakeSemaphore = xSemaphoreCreateBinaryStatic(&spinn_tx_wake_sem_obj);
 
 }
 
@@ -468,11 +405,7 @@ static void tasks_init(void)
  */
 static void spinn_reset_fwd_flag(TimerHandle_t timer)
 {
-    if (xSemaphoreTake(spinFwdSemaphore, portMAX_DELAY) == pdTRUE)
-    {
-        spinn_fwd_pc_flag = false;
-        xSemaphoreGive(spinFwdSemaphore);
-    }
+    spinn_fwd_pc_flag = false;
 }
 
 /**
@@ -489,55 +422,288 @@ static void spinn_tx_task(void *pvParameters)
 {
     uint8_t data = 0;
     uint8_t check_flag = false;
-    uint8_t sent_bytes = 0;
-    uint8_t pkt_buf[SPINN_SHORT_SYMS];
+    uint8_t tap_flag = false;
+    uint16_t events[SPINN_MAX_PKT_EVENTS];
+    uint8_t event_count = 0;
+    uint8_t pkt_buf[SPINN_LONG_SYMS];
+    uint8_t pkt_len = 0;
     uint8_t idx = 0;
 
     for (;;)
     {
 
-        /* Wait for data in the queue to transmit */
+        /* Wait for data in the ring to transmit; events are copied out so
+           the producer can never modify a packet while it is being sent */
         idx = 0;
-        if (pdPASS == xQueueReceive(spinn_txq, pkt_buf, portMAX_DELAY))
+        while (!spinn_ring_pop(&spinn_txr, &events[0]))
+        {
+            xSemaphoreTake(spinTxWakeSemaphore, portMAX_DELAY);
+        }
+        trace_rec(TRACE_QUEUE_RECV, TRACE_Q_SPINN_TX, events[0]);
+
+        /* If the link has fallen behind, carry any further queued events
+           in the payload of the same packet */
+        event_count = 1;
+        while (event_count < spinn_pkt_events &&
+               spinn_ring_pop(&spinn_txr, &events[event_count]))
+        {
+            trace_rec(TRACE_QUEUE_RECV, TRACE_Q_SPINN_TX, events[event_count]);
+            event_count++;
+        }
+        pkt_len = spinn_codec_encode_events(events, event_count, pkt_buf);
+        trace_rec(TRACE_PACKET_QUEUED, event_count, pkt_len);
+
+        /* Copy so that the whole packet is handled the same way */
+        check_flag = spinn_fwd_pc_flag;
+        tap_flag = spinn_tap_pc_flag;
+
+        if (spinn_loopback_flag)
+        {
+            /* Nothing leaves the board, so there is nothing to mirror */
+            spinn_loop_packet(events, event_count, pkt_buf, pkt_len);
+        }
+        else if (check_flag)
         {
-            while (idx < SPINN_SHORT_SYMS)
+            /* Forwarding replaces the link, so nothing is lost by waiting
+               for the PC */
+            spinn_tap_add(pkt_buf, pkt_len, true);
+        }
+        else
+        {
+            /* If the link has stalled, try to restart it before this
+               packet */
+            if (!spinn_link_stats.up)
+            {
+                spinn_restart_link();
+            }
+
+            while (idx < pkt_len)
             {
                 data = pkt_buf[idx++];
                 /* Wait for interrupt on pin to transmit next symbol */
-                if (xSemaphoreTake(xSpinnTxSemaphore, portMAX_DELAY) == pdTRUE)
+                if (spinn_wait_ack() == false)
                 {
+                    /* Stalled; abandon packet, the ring keeps filling until
+                       the link recovers */
+                    spinn_link_stats.abandoned++;
+                    break;
+                }
+
+                /* Toggle bits in port for next transition */
+                spinn_link_tx_sym(data);
+            }
 
-                    if (xSemaphoreTake(spinFwdSemaphore, portMAX_DELAY) == pdTRUE)
-                    {
-                        /* Copy to prevent holding while doing large task */
-                        check_flag = spinn_fwd_pc_flag;
-                        xSemaphoreGive(spinFwdSemaphore);
-                    }
-
-                    if (check_flag)
-                    {
-                        pc_send_byte(data);
-                        prev_data = data;
-                        /* Send carriage return to signify EOP */ 
-                        if (++sent_bytes == SPINN_SHORT_SYMS)
-                        {
-                            pc_send_string(PC_EOL);
-                            sent_bytes = 0;
-                        }
-                        /* If forwarding to PC, do not wait for interrupt */
-                        xSemaphoreGive(xSpinnTxSemaphore);
-                    }
-                    else
-                    {
-                        /* Toggle bits in port for next transition */
-                        GPIO_Write(GPIOB, 
-                            (GPIO_ReadOutputDataBit(GPIOB, GPIO_Pin_15) << 15)
-                             | data ^ prev_data);
-                        prev_data = data ^ prev_data;
-                    }
+            /* Mirror packets which were sent, never holding up the link */
+            if (idx == pkt_len)
+            {
+                spinn_link_stats.packets++;
+                if (tap_flag)
+                {
+                    spinn_tap_add(pkt_buf, pkt_len, false);
                 }
             }
         }
+
+        /* Send the batch once nothing more is waiting to join it */
+        if (spinn_ring_empty(&spinn_txr))
+        {
+            spinn_tap_flush(check_flag);
+        }
+    }
+}
+
+/**
+ * DESCRIPTION
+ * Waits for SpiNNaker to acknowledge the previous symbol, tracking stalls and
+ * recoveries of the link. A stalled link is given longer to respond
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * true if acknowledged, false on timeout
+ */
+static uint8_t spinn_wait_ack(void)
+{
+    TickType_t wait = portMAX_DELAY;
+    uint32_t recovery_ms;
+
+    if (spinn_ack_timeout_ms > 0)
+    {
+        wait = (spinn_link_stats.up ? spinn_ack_timeout_ms : SPINN_PROBE_MS) / 
+               portTICK_PERIOD_MS;
+    }
+
+    if (ulTaskNotifyTake(pdTRUE, wait) > 0)
+    {
+        wake_task_record(WAKE_SPINN_TX_ACK);
+        if (!spinn_link_stats.up)
+        {
+            /* Acknowledged again, so record how long recovery took */
+            recovery_ms = (xTaskGetTickCount() - spinn_stall_start) * 
+                          portTICK_PERIOD_MS;
+            spinn_link_stats.last_recovery_ms = recovery_ms;
+            if (recovery_ms > spinn_link_stats.max_recovery_ms)
+            {
+                spinn_link_stats.max_recovery_ms = recovery_ms;
+            }
+            spinn_link_stats.recoveries++;
+            spinn_link_stats.down_ms = 0;
+            spinn_link_stats.up = true;
+        }
+        return true;
+    }
+
+    spinn_link_stats.timeouts++;
+    if (spinn_link_stats.up)
+    {
+        spinn_link_stats.stalls++;
+        spinn_stall_start = xTaskGetTickCount();
+        spinn_link_stats.up = false;
+    }
+    return false;
+}
+
+/**
+ * DESCRIPTION
+ * Attempts to restart a stalled link. The port state is taken as the
+ * reference for the next transitions, then an EOP is sent without waiting
+ * for an acknowledge. This completes any symbol SpiNNaker has only partly
+ * seen and ends any partial packet, which it drops as malformed, and
+ * SpiNNaker acknowledging it marks the link as recovered
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void spinn_restart_link(void)
+{
+    /* Discard any late acknowledge so that only one for the EOP counts */
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    spinn_link_tx_resync();
+    spinn_link_tx_sym(SPINN_SYM_EOP);
+}
+
+/**
+ * DESCRIPTION
+ * Adds a packet to the batch being mirrored to the PC, first sending the
+ * batch if the packet would not fit. Transmit task only
+ * 
+ * INPUTS
+ * p_pkt (uint8_t*) : Packet symbols, including EOP
+ * len (uint8_t) : Number of symbols
+ * block (uint8_t) : Wait for room to send the batch if true, otherwise drop
+ *                   the batch if the PC cannot take it now
+ *
+ * RETURNS
+ * Nothing
+ */
+static void spinn_tap_add(uint8_t* p_pkt, uint8_t len, uint8_t block)
+{
+    if (spinn_tap_len + 1 + len > sizeof(spinn_tap_buf))
+    {
+        spinn_tap_flush(block);
+    }
+
+    if (spinn_tap_len == 0)
+    {
+        spinn_tap_len = SPINN_TAP_HDR_LEN;
+        spinn_tap_count = 0;
+        spinn_tap_tick = xTaskGetTickCount();
+    }
+
+    spinn_tap_buf[spinn_tap_len++] = len;
+    memcpy(&spinn_tap_buf[spinn_tap_len], p_pkt, len);
+    spinn_tap_len += len;
+    spinn_tap_count++;
+}
+
+/**
+ * DESCRIPTION
+ * Sends the batch of mirrored packets to the PC as one frame, if there is
+ * one. Packets in a batch which cannot be sent are counted and reported in
+ * the header of the next frame. Transmit task only
+ * 
+ * INPUTS
+ * block (uint8_t) : Wait for room to send the batch if true
+ *
+ * RETURNS
+ * Nothing
+ */
+static void spinn_tap_flush(uint8_t block)
+{
+    if (spinn_tap_len == 0)
+    {
+        return;
+    }
+
+    spinn_tap_buf[0] = spinn_tap_count;
+    spinn_tap_buf[1] = (spinn_tap_dropped & 0xFF00) >> 8;
+    spinn_tap_buf[2] = spinn_tap_dropped & 0x00FF;
+    spinn_tap_buf[3] = (spinn_tap_tick >> 24) & 0xFF;
+    spinn_tap_buf[4] = (spinn_tap_tick >> 16) & 0xFF;
+    spinn_tap_buf[5] = (spinn_tap_tick >> 8) & 0xFF;
+    spinn_tap_buf[6] = spinn_tap_tick & 0xFF;
+
+    if (block)
+    {
+        pc_send_frame(spinn_tap_buf, spinn_tap_len);
+        spinn_tap_dropped = 0;
+    }
+    else if (pc_send_frame_nb(spinn_tap_buf, spinn_tap_len))
+    {
+        spinn_tap_dropped = 0;
+    }
+    else if (spinn_tap_dropped < 0xFFFF - spinn_tap_count)
+    {
+        spinn_tap_dropped += spinn_tap_count;
+    }
+    else
+    {
+        spinn_tap_dropped = 0xFFFF;
+    }
+
+    spinn_tap_len = 0;
+}
+
+/**
+ * DESCRIPTION
+ * Decodes a packet just encoded, in place of sending it, and checks it
+ * carries the events it was encoded from. Packets decoded are then routed
+ * as if received on the link. Transmit task only
+ * 
+ * INPUTS
+ * p_events (uint16_t*) : Events the packet was encoded from
+ * count (uint8_t) : Number of events
+ * p_pkt (uint8_t*) : Packet symbols, including EOP
+ * len (uint8_t) : Number of symbols
+ *
+ * RETURNS
+ * Nothing
+ */
+static void spinn_loop_packet(uint16_t* p_events, uint8_t count,
+                              uint8_t* p_pkt, uint8_t len)
+{
+    spinn_packet_t pkt;
+    uint8_t decoded;
+
+    decoded = spinn_rx_decode(p_pkt, len, &pkt);
+    if (decoded && spinn_codec_matches(&pkt, p_events, count))
+    {
+        spinn_loop_stats.packets++;
+        spinn_loop_stats.events += count;
+    }
+    else
+    {
+        spinn_loop_stats.errors++;
+    }
+
+    if (decoded)
+    {
+        spinn_rx_deliver(&pkt);
     }
 }
 
@@ -553,55 +719,44 @@ static void spinn_tx_task(void *pvParameters)
  */
 static void spinn_rx_task(void *pvParameters)
 {
-    uint8_t rx_buf[SPINN_SHORT_SYMS*2];
+    uint8_t rx_buf[SPINN_RX_BUF_SYMS];
     uint8_t rx_buf_idx = 0;
-    uint8_t previous_data = 0, current_data = 0;
 
     /* Reset previous data to ensure state is correct */
-    previous_data =  GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_8 ) +
-                    (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_9 ) << 1) +
-                    (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_10) << 2) +
-                    (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_11) << 3) +
-                    (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_12) << 4) +
-                    (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_13) << 5) +
-                    (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_14) << 6);
+    spinn_link_rx_resync();
 
     for (;;)
     {
 
         while (rx_buf_idx < sizeof(rx_buf))
         {
-            /* Get semaphore twice */
-            xSemaphoreTake(xSpinnRxSemaphore, portMAX_DELAY);
-            xSemaphoreTake(xSpinnRxSemaphore, portMAX_DELAY);
-            /* Read data into buffer */
-            current_data =  GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_8 ) +
-                           (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_9 ) << 1) +
-                           (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_10) << 2) +
-                           (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_11) << 3) +
-                           (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_12) << 4) +
-                           (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_13) << 5) +
-                           (GPIO_ReadInputDataBit(GPIOB, GPIO_Pin_14) << 6);
-            rx_buf[rx_buf_idx] = current_data ^ previous_data;
-            previous_data = current_data;
-            /* Transmit acknowledge as transition */
-            if (GPIO_ReadOutputDataBit(GPIOB, GPIO_Pin_15) > 0)
+            rx_buf[rx_buf_idx] = spinn_rx_next();
+            if (rx_buf[rx_buf_idx++] == SPINN_SYM_EOP)
             {
-                GPIO_WriteBit(GPIOB, GPIO_Pin_15, Bit_RESET);
-            }
-            else
-            {
-                GPIO_WriteBit(GPIOB, GPIO_Pin_15, Bit_SET);
+                break;
             }
-            if (rx_buf[rx_buf_idx] == symbol_table[sizeof(symbol_table)-1])
+        }
+
+        if (rx_buf[rx_buf_idx - 1] == SPINN_SYM_EOP)
+        {
+            /* Handle data using method; length includes EOP */
+            spinn_use_data(&rx_buf[0], rx_buf_idx);
+        }
+        else
+        {
+            /* EOP was lost, so the buffer may hold the start of the next
+               packet too; discard everything up to the next EOP rather than
+               let the error spread into following packets */
+            taskENTER_CRITICAL();
+            spinn_rx_stats.overruns++;
+            taskEXIT_CRITICAL();
+            while (spinn_rx_next() != SPINN_SYM_EOP)
             {
-                break;
             }
-            rx_buf_idx++;
         }
 
-        /* Handle data using method */
-        spinn_use_data(&rx_buf[0]);
+        /* Time until the next packet is not symbol spacing */
+        spinn_link_rx_idle();
 
         /* Reset buffer */
         rx_buf_idx = 0;
@@ -610,43 +765,124 @@ static void spinn_rx_task(void *pvParameters)
 
 /**
  * DESCRIPTION
- * Performs safe reset of received forwarding flag
+ * Decodes and validates a whole packet, counting it by outcome, so that a
+ * packet received in error is dropped before it can drive an output
  * 
  * INPUTS
- * timer (TimerHandle_t) : Expired timer or NULL
+ * buf (uint8_t*) : Packet symbols, including EOP
+ * len (uint8_t) : Number of symbols
+ * p_pkt (spinn_packet_t*) : Filled with key and payload if packet is valid
+ *
+ * RETURNS
+ * true if the packet is valid, false otherwise
+ */
+static uint8_t spinn_rx_decode(uint8_t* buf, uint8_t len, 
+                               spinn_packet_t* p_pkt)
+{
+    spinn_decode_t result;
+
+    result = spinn_codec_decode(buf, len, p_pkt);
+
+    taskENTER_CRITICAL();
+    switch (result)
+    {
+        case SPINN_DECODE_OK:
+            spinn_rx_stats.packets++;
+            break;
+        case SPINN_DECODE_BAD_LENGTH:
+            spinn_rx_stats.bad_length++;
+            break;
+        case SPINN_DECODE_BAD_EOP:
+            spinn_rx_stats.bad_eop++;
+            break;
+        case SPINN_DECODE_BAD_SYMBOL:
+            spinn_rx_stats.bad_symbol++;
+            break;
+        case SPINN_DECODE_BAD_PARITY:
+            spinn_rx_stats.bad_parity++;
+            break;
+    }
+    taskEXIT_CRITICAL();
+
+    return result == SPINN_DECODE_OK;
+}
+
+/**
+ * DESCRIPTION
+ * Looks up the route for the key of a valid packet and applies its value,
+ * forwarding it to the PC if routed there and forwarding is on
+ * 
+ * INPUTS
+ * p_pkt (spinn_packet_t*) : Decoded packet
  *
  * RETURNS
  * Nothing
  */
-static void spinn_reset_fwd_rx_flag(TimerHandle_t timer)
+static void spinn_rx_deliver(spinn_packet_t* p_pkt)
 {
-    if (xSemaphoreTake(spinFwdRxSemaphore, portMAX_DELAY) == pdTRUE)
+    uint16_t value = p_pkt->key & 0xFFFF;
+    spinn_handler_t handler;
+
+    /* Find what to do with packet from its key */
+    if (!spinn_route_dispatch(p_pkt->key, &handler) ||
+        handler != SPINN_HANDLER_PC)
     {
-        spinn_fwd_rx_pc_flag = false;
-        xSemaphoreGive(spinFwdRxSemaphore);
+        return;
+    }
+
+    /* If forwarding, send to PC */
+    if (spinn_fwd_rx_pc_flag)
+    {
+        pc_send_byte((value & 0xFF00) >> 8);
+        pc_send_byte(value & 0x00FF);
+        pc_send_byte('\r');
     }
 }
 
 /**
  * DESCRIPTION
- * Returns index of symbol from lookup table
+ * Waits for a received symbol and acknowledges it. Waits for edges until at
+ * least two data pins have changed rather than counting two edges, so a lost
+ * or spurious edge costs at most one bad symbol instead of leaving every
+ * later symbol read half-way through its transition. Edges which arrive
+ * together are taken with a single wake, as only the pin state matters
  * 
  * INPUTS
- * sym (uint8_t) : Symbol to look up
+ * None
  *
  * RETURNS
- * Index of symbol or 17 if symbol not found
+ * Received symbol (uint8_t)
  */
-static uint8_t spinn_lookup_sym(uint8_t sym)
+static uint8_t spinn_rx_next(void)
 {
-    for (uint8_t idx = 0; idx < sizeof(symbol_table); idx++)
+    uint8_t sym = 0;
+
+    /* Clearing the lowest set bit leaves zero while fewer than two are set */
+    while ((sym & (sym - 1)) == 0)
     {
-        if (symbol_table[idx] == sym)
-        {
-            return idx;
-        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        wake_task_record(WAKE_SPINN_RX_EDGE);
+        sym |= spinn_link_rx_sym();
     }
-    return sizeof(symbol_table);
+
+    /* Transmit acknowledge as transition */
+    spinn_link_rx_ack();
+    return sym;
+}
+
+/**
+ * DESCRIPTION
+ * Performs safe reset of received forwarding flag
+ * 
+ * INPUTS
+ * timer (TimerHandle_t) : Expired timer or NULL
+ *
+ * RETURNS
+ * Nothing
+ */
+static void spinn_reset_fwd_rx_flag(TimerHandle_t timer)
+{
+    spinn_fwd_rx_pc_flag = false;
 }
 
 /*******************************************************************************
@@ -0,0 +1,407 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "spinn_codec.h"
+#include "ram_code.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* Index of address symbols and EOP within a short packet */
+#define TAIL_IDX    (6)
+#define TAIL_LENGTH (SPINN_SHORT_SYMS - TAIL_IDX)
+
+/* Index of first key symbol within any packet */
+#define KEY_IDX     (2)
+#define KEY_SYMS    (8)
+
+/* Decoded values which are not data nibbles; any bit above the nibble
+   marks a symbol which cannot appear inside a packet */
+#define SYM_EOP     (0x40)
+#define SYM_INV     (0x80)
+#define SYM_ERR_MASK (0xF0)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Global Variable Declarations
+ ******************************************************************************/
+/* Symbol encoding table for 2-of-7 format */
+const uint8_t spinn_codec_symbols[SPINN_NUM_SYMS] = 
+{
+    0x11, 0x12, 0x14, 0x18, 0x21, 0x22, 0x24, 0x28,
+    0x41, 0x42, 0x44, 0x48, 0x03, 0x06, 0x0C, 0x09, 0x60
+};
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Symbol pairs for every byte; low nibble symbol in bits 0-7, high nibble
+   symbol in bits 8-15 */
+static const uint16_t sym_pair_table[256] =
+{
+    0x1111, 0x1112, 0x1114, 0x1118, 0x1121, 0x1122, 0x1124, 0x1128,
+    0x1141, 0x1142, 0x1144, 0x1148, 0x1103, 0x1106, 0x110C, 0x1109,
+    0x1211, 0x1212, 0x1214, 0x1218, 0x1221, 0x1222, 0x1224, 0x1228,
+    0x1241, 0x1242, 0x1244, 0x1248, 0x1203, 0x1206, 0x120C, 0x1209,
+    0x1411, 0x1412, 0x1414, 0x1418, 0x1421, 0x1422, 0x1424, 0x1428,
+    0x1441, 0x1442, 0x1444, 0x1448, 0x1403, 0x1406, 0x140C, 0x1409,
+    0x1811, 0x1812, 0x1814, 0x1818, 0x1821, 0x1822, 0x1824, 0x1828,
+    0x1841, 0x1842, 0x1844, 0x1848, 0x1803, 0x1806, 0x180C, 0x1809,
+    0x2111, 0x2112, 0x2114, 0x2118, 0x2121, 0x2122, 0x2124, 0x2128,
+    0x2141, 0x2142, 0x2144, 0x2148, 0x2103, 0x2106, 0x210C, 0x2109,
+    0x2211, 0x2212, 0x2214, 0x2218, 0x2221, 0x2222, 0x2224, 0x2228,
+    0x2241, 0x2242, 0x2244, 0x2248, 0x2203, 0x2206, 0x220C, 0x2209,
+    0x2411, 0x2412, 0x2414, 0x2418, 0x2421, 0x2422, 0x2424, 0x2428,
+    0x2441, 0x2442, 0x2444, 0x2448, 0x2403, 0x2406, 0x240C, 0x2409,
+    0x2811, 0x2812, 0x2814, 0x2818, 0x2821, 0x2822, 0x2824, 0x2828,
+    0x2841, 0x2842, 0x2844, 0x2848, 0x2803, 0x2806, 0x280C, 0x2809,
+    0x4111, 0x4112, 0x4114, 0x4118, 0x4121, 0x4122, 0x4124, 0x4128,
+    0x4141, 0x4142, 0x4144, 0x4148, 0x4103, 0x4106, 0x410C, 0x4109,
+    0x4211, 0x4212, 0x4214, 0x4218, 0x4221, 0x4222, 0x4224, 0x4228,
+    0x4241, 0x4242, 0x4244, 0x4248, 0x4203, 0x4206, 0x420C, 0x4209,
+    0x4411, 0x4412, 0x4414, 0x4418, 0x4421, 0x4422, 0x4424, 0x4428,
+    0x4441, 0x4442, 0x4444, 0x4448, 0x4403, 0x4406, 0x440C, 0x4409,
+    0x4811, 0x4812, 0x4814, 0x4818, 0x4821, 0x4822, 0x4824, 0x4828,
+    0x4841, 0x4842, 0x4844, 0x4848, 0x4803, 0x4806, 0x480C, 0x4809,
+    0x0311, 0x0312, 0x0314, 0x0318, 0x0321, 0x0322, 0x0324, 0x0328,
+    0x0341, 0x0342, 0x0344, 0x0348, 0x0303, 0x0306, 0x030C, 0x0309,
+    0x0611, 0x0612, 0x0614, 0x0618, 0x0621, 0x0622, 0x0624, 0x0628,
+    0x0641, 0x0642, 0x0644, 0x0648, 0x0603, 0x0606, 0x060C, 0x0609,
+    0x0C11, 0x0C12, 0x0C14, 0x0C18, 0x0C21, 0x0C22, 0x0C24, 0x0C28,
+    0x0C41, 0x0C42, 0x0C44, 0x0C48, 0x0C03, 0x0C06, 0x0C0C, 0x0C09,
+    0x0911, 0x0912, 0x0914, 0x0918, 0x0921, 0x0922, 0x0924, 0x0928,
+    0x0941, 0x0942, 0x0944, 0x0948, 0x0903, 0x0906, 0x090C, 0x0909
+};
+
+/* Parity of every byte; 1 if an odd number of bits are set */
+static const uint8_t parity_table[256] =
+{
+    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
+    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
+    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
+    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
+    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
+    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
+    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
+    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0
+};
+
+/* Reverse of spinn_codec_symbols for every 7-bit port value; values which
+   are not valid 2-of-7 symbols map to SYM_INV */
+static const uint8_t sym_decode_table[128] =
+{
+    SYM_INV, SYM_INV, SYM_INV,      12, SYM_INV, SYM_INV,      13, SYM_INV,
+    SYM_INV,      15, SYM_INV, SYM_INV,      14, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV,       0,       1, SYM_INV,       2, SYM_INV, SYM_INV, SYM_INV,
+          3, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV,       4,       5, SYM_INV,       6, SYM_INV, SYM_INV, SYM_INV,
+          7, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV,       8,       9, SYM_INV,      10, SYM_INV, SYM_INV, SYM_INV,
+         11, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_EOP, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV,
+    SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV, SYM_INV
+};
+
+/* First header symbol indexed by parity of the event bytes; derived from
+   chip address by spinn_codec_set_address so overall parity is odd */
+static uint8_t header_syms[2];
+static uint8_t long_header_syms[2];
+
+/* Chip address symbols followed by EOP, in order of sending */
+static uint8_t tail_syms[TAIL_LENGTH];
+
+/* Chip address as the upper half of an encoded key */
+static uint32_t key_address = 0;
+
+/* Event mapping parameters for the current resolution */
+static uint8_t map_mask = 0x7F;
+static uint8_t map_x_shift = 0;
+static uint8_t map_y_shift = 7;
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static uint8_t decode_sym(uint8_t sym);
+
+/*******************************************************************************
+ * Public Function Definitions 
+ ******************************************************************************/
+void spinn_codec_set_address(uint16_t address)
+{
+    uint8_t addr_parity;
+    uint16_t pair;
+
+    /* Header depends on parity of address as well as event */
+    addr_parity = parity_table[((address & 0xFF00) >> 8) ^ (address & 0xFF)];
+    header_syms[0] = spinn_codec_symbols[1 ^ addr_parity];
+    header_syms[1] = spinn_codec_symbols[addr_parity];
+
+    /* Payload flag is itself a set bit, so parity bit is inverted */
+    long_header_syms[0] = spinn_codec_symbols[addr_parity | SPINN_CTRL_PAYLOAD];
+    long_header_syms[1] = spinn_codec_symbols[(1 ^ addr_parity) | 
+                                              SPINN_CTRL_PAYLOAD];
+
+    /* Address is sent least significant nibble first, then EOP */
+    pair = sym_pair_table[address & 0xFF];
+    tail_syms[0] = (uint8_t) pair;
+    tail_syms[1] = (uint8_t) (pair >> 8);
+    pair = sym_pair_table[(address & 0xFF00) >> 8];
+    tail_syms[2] = (uint8_t) pair;
+    tail_syms[3] = (uint8_t) (pair >> 8);
+    tail_syms[4] = SPINN_SYM_EOP;
+
+    key_address = (uint32_t) address << 16;
+}
+
+void spinn_codec_set_mode(dvs_res_t res)
+{
+    /* Each halving of resolution drops one bit from x and y */
+    uint8_t drop;
+
+    switch (res)
+    {
+        case DVS_RES_64:
+            drop = 1;
+            break;
+        case DVS_RES_32:
+            drop = 2;
+            break;
+        case DVS_RES_16:
+            drop = 3;
+            break;
+        case DVS_RES_128:
+        default:
+            drop = 0;
+            break;
+    }
+
+    map_mask = 0x7F & ~((1 << drop) - 1);
+    map_x_shift = drop;
+    map_y_shift = 7 - 2*drop;
+}
+
+uint16_t spinn_codec_map_event(dvs_data_t* p_data)
+{
+    return 0x8000 + ((p_data->polarity & 0x1) << 14) +
+           ((p_data->y & map_mask) << map_y_shift) +
+           ((p_data->x & map_mask) >> map_x_shift);
+}
+
+RAM_CODE
+void spinn_codec_encode_event(uint16_t event, uint8_t* p_pkt)
+{
+    uint8_t lo = event & 0xFF;
+    uint8_t hi = (event & 0xFF00) >> 8;
+    uint16_t pair;
+
+    /* Header */
+    p_pkt[0] = header_syms[parity_table[lo ^ hi]];
+    p_pkt[1] = spinn_codec_symbols[0];
+
+    /* Data, least significant nibble first */
+    pair = sym_pair_table[lo];
+    p_pkt[2] = (uint8_t) pair;
+    p_pkt[3] = (uint8_t) (pair >> 8);
+    pair = sym_pair_table[hi];
+    p_pkt[4] = (uint8_t) pair;
+    p_pkt[5] = (uint8_t) (pair >> 8);
+
+    /* Chip address and EOP */
+    p_pkt[6] = tail_syms[0];
+    p_pkt[7] = tail_syms[1];
+    p_pkt[8] = tail_syms[2];
+    p_pkt[9] = tail_syms[3];
+    p_pkt[10] = tail_syms[4];
+}
+
+RAM_CODE
+uint8_t spinn_codec_encode_events(uint16_t* p_events, uint8_t count,
+                                  uint8_t* p_pkt)
+{
+    uint16_t pair;
+    uint16_t second;
+    uint16_t third;
+    uint8_t xor_all;
+
+    if (count < 2)
+    {
+        spinn_codec_encode_event(p_events[0], p_pkt);
+        return SPINN_SHORT_SYMS;
+    }
+
+    second = p_events[1];
+    third = (count > 2) ? p_events[2] : 0;
+
+    /* Parity covers all three events as well as the address */
+    xor_all = (p_events[0] & 0xFF) ^ ((p_events[0] & 0xFF00) >> 8) ^
+              (second & 0xFF) ^ ((second & 0xFF00) >> 8) ^
+              (third & 0xFF) ^ ((third & 0xFF00) >> 8);
+
+    /* Header */
+    p_pkt[0] = long_header_syms[parity_table[xor_all]];
+    p_pkt[1] = spinn_codec_symbols[0];
+
+    /* Key is first event then chip address */
+    pair = sym_pair_table[p_events[0] & 0xFF];
+    p_pkt[2] = (uint8_t) pair;
+    p_pkt[3] = (uint8_t) (pair >> 8);
+    pair = sym_pair_table[(p_events[0] & 0xFF00) >> 8];
+    p_pkt[4] = (uint8_t) pair;
+    p_pkt[5] = (uint8_t) (pair >> 8);
+    p_pkt[6] = tail_syms[0];
+    p_pkt[7] = tail_syms[1];
+    p_pkt[8] = tail_syms[2];
+    p_pkt[9] = tail_syms[3];
+
+    /* Payload is second event then third event */
+    pair = sym_pair_table[second & 0xFF];
+    p_pkt[10] = (uint8_t) pair;
+    p_pkt[11] = (uint8_t) (pair >> 8);
+    pair = sym_pair_table[(second & 0xFF00) >> 8];
+    p_pkt[12] = (uint8_t) pair;
+    p_pkt[13] = (uint8_t) (pair >> 8);
+    pair = sym_pair_table[third & 0xFF];
+    p_pkt[14] = (uint8_t) pair;
+    p_pkt[15] = (uint8_t) (pair >> 8);
+    pair = sym_pair_table[(third & 0xFF00) >> 8];
+    p_pkt[16] = (uint8_t) pair;
+    p_pkt[17] = (uint8_t) (pair >> 8);
+
+    p_pkt[18] = SPINN_SYM_EOP;
+    return SPINN_LONG_SYMS;
+}
+
+RAM_CODE
+spinn_decode_t spinn_codec_decode(uint8_t* p_syms, uint8_t len,
+                                  spinn_packet_t* p_pkt)
+{
+    uint8_t flags = 0;
+    uint8_t parity = 0;
+    uint8_t value;
+    uint8_t has_payload;
+    uint32_t key = 0;
+    uint32_t payload = 0;
+
+    if (len != SPINN_SHORT_SYMS && len != SPINN_LONG_SYMS)
+    {
+        return SPINN_DECODE_BAD_LENGTH;
+    }
+    if (decode_sym(p_syms[len - 1]) != SYM_EOP)
+    {
+        return SPINN_DECODE_BAD_EOP;
+    }
+
+    /* Header nibbles contribute to parity only */
+    value = decode_sym(p_syms[0]);
+    flags |= value;
+    parity ^= value;
+    has_payload = (value & SPINN_CTRL_PAYLOAD) ? 1 : 0;
+    value = decode_sym(p_syms[1]);
+    flags |= value;
+    parity ^= value;
+
+    /* Key and payload are sent least significant nibble first */
+    for (uint8_t i = 0; i < KEY_SYMS; i++)
+    {
+        value = decode_sym(p_syms[KEY_IDX + i]);
+        flags |= value;
+        parity ^= value;
+        key |= ((uint32_t) (value & 0xF)) << (4 * i);
+    }
+    if (len == SPINN_LONG_SYMS)
+    {
+        for (uint8_t i = 0; i < KEY_SYMS; i++)
+        {
+            value = decode_sym(p_syms[KEY_IDX + KEY_SYMS + i]);
+            flags |= value;
+            parity ^= value;
+            payload |= ((uint32_t) (value & 0xF)) << (4 * i);
+        }
+    }
+
+    /* Any invalid or misplaced EOP symbol sets bits outside the nibble */
+    if ((flags & SYM_ERR_MASK) != 0)
+    {
+        return SPINN_DECODE_BAD_SYMBOL;
+    }
+    if (has_payload != (len == SPINN_LONG_SYMS))
+    {
+        return SPINN_DECODE_BAD_LENGTH;
+    }
+    if (parity_table[parity] == 0)
+    {
+        return SPINN_DECODE_BAD_PARITY;
+    }
+
+    p_pkt->key = key;
+    p_pkt->payload = payload;
+    p_pkt->has_payload = has_payload;
+    return SPINN_DECODE_OK;
+}
+
+uint8_t spinn_codec_matches(spinn_packet_t const * p_pkt,
+                            uint16_t const * p_events, uint8_t count)
+{
+    uint32_t payload;
+
+    if (p_pkt->key != (key_address | p_events[0]))
+    {
+        return false;
+    }
+    if (count < 2)
+    {
+        return !p_pkt->has_payload;
+    }
+
+    payload = p_events[1] | ((count > 2) ? (uint32_t) p_events[2] << 16 : 0);
+    return p_pkt->has_payload && p_pkt->payload == payload;
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Converts received symbol to nibble value with a single table lookup
+ *
+ * INPUTS
+ * sym (uint8_t) : Received symbol
+ *
+ * RETURNS
+ * Nibble value, SYM_EOP, or SYM_INV if symbol is not valid
+ */
+RAM_CODE
+static uint8_t decode_sym(uint8_t sym)
+{
+    /* Symbols only use 7 bits, so the top bit also marks an invalid symbol */
+    return sym_decode_table[sym & 0x7F] | (sym & 0x80);
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
@@ -0,0 +1,299 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "spinn_link.h"
+#include "cycle_count.h"
+#include "trace.h"
+#include "ram_code.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* Transmitted symbols are on pins 0-6 of GPIOB */
+#define TX_PIN_MASK      (0x7F)
+
+/* Received symbols are on pins 8-14 of GPIOB */
+#define RX_PIN_SHIFT     (8)
+#define RX_PIN_MASK      (0x7F)
+
+/* BSRR resets pins written to its upper half */
+#define BSRR_RESET_SHIFT (16)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Last TX data pin state written, owned by the transmit side */
+static uint8_t tx_state = 0x00;
+
+/* Last RX data pin state read, owned by the receive side */
+static uint8_t rx_state = 0x00;
+
+/* Cycle count at the last TX symbol or RX acknowledge written, and whether
+   the edge answering it has yet to be timed */
+static volatile uint32_t tx_stamp = 0;
+static volatile uint8_t tx_armed = 0;
+static volatile uint32_t rx_stamp = 0;
+static volatile uint8_t rx_armed = 0;
+
+/* Latency histograms, only written from the EXTI interrupt */
+static volatile uint32_t link_hist[SPINN_HIST_NUM][SPINN_HIST_BUCKETS];
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static void hal_init(void);
+static void irq_init(void);
+static void hist_add(spinn_hist_t hist, uint32_t cycles);
+
+/*******************************************************************************
+ * Public Function Definitions 
+ ******************************************************************************/
+void spinn_link_config(void)
+{
+    hal_init();
+    irq_init();
+
+    spinn_link_tx_resync();
+    spinn_link_rx_resync();
+}
+
+RAM_CODE
+void spinn_link_tx_sym(uint8_t sym)
+{
+    tx_state ^= sym;
+
+    /* Stamp before the pins change so the acknowledge cannot beat it */
+    tx_stamp = cycle_get();
+    tx_armed = 1;
+
+    /* Set and reset every TX data pin in one store, leaving other pins of
+       the port untouched */
+    GPIOB->BSRR = tx_state | 
+                  ((uint32_t) (~tx_state & TX_PIN_MASK) << BSRR_RESET_SHIFT);
+}
+
+void spinn_link_tx_resync(void)
+{
+    tx_state = GPIOB->ODR & TX_PIN_MASK;
+}
+
+uint8_t spinn_link_rx_sym(void)
+{
+    uint8_t current = (GPIOB->IDR >> RX_PIN_SHIFT) & RX_PIN_MASK;
+    uint8_t sym = current ^ rx_state;
+
+    rx_state = current;
+    return sym;
+}
+
+void spinn_link_rx_resync(void)
+{
+    rx_state = (GPIOB->IDR >> RX_PIN_SHIFT) & RX_PIN_MASK;
+    rx_armed = 0;
+}
+
+void spinn_link_rx_ack(void)
+{
+    rx_stamp = cycle_get();
+    rx_armed = 1;
+
+    /* Only the receive side writes pin 15, so reading it first is safe */
+    if (GPIOB->ODR & GPIO_Pin_15)
+    {
+        GPIOB->BRR = GPIO_Pin_15;
+    }
+    else
+    {
+        GPIOB->BSRR = GPIO_Pin_15;
+    }
+}
+
+void spinn_link_rx_idle(void)
+{
+    rx_armed = 0;
+}
+
+RAM_CODE
+void spinn_link_tx_ack_isr(void)
+{
+    uint32_t cycles;
+
+    if (tx_armed)
+    {
+        tx_armed = 0;
+        cycles = cycle_get() - tx_stamp;
+        hist_add(SPINN_HIST_TX_ACK, cycles);
+        trace_rec(TRACE_SYMBOL_ACKED, 0, cycles > 0xFFFF ? 0xFFFF : cycles);
+    }
+}
+
+RAM_CODE
+void spinn_link_rx_edge_isr(void)
+{
+    if (rx_armed)
+    {
+        rx_armed = 0;
+        hist_add(SPINN_HIST_RX_SYM, cycle_get() - rx_stamp);
+    }
+}
+
+void spinn_link_get_hist(spinn_hist_t hist, uint32_t* p_counts, 
+                         uint8_t reset)
+{
+    uint8_t i;
+
+    /* Histograms are written from the EXTI interrupt, so hold it off while
+       copying to get a consistent snapshot */
+    __disable_irq();
+    for (i = 0; i < SPINN_HIST_BUCKETS; i++)
+    {
+        p_counts[i] = link_hist[hist][i];
+        if (reset)
+        {
+            link_hist[hist][i] = 0;
+        }
+    }
+    __enable_irq();
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Configure hardware for SpiNNaker connection
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void hal_init(void)
+{
+    GPIO_InitTypeDef port_init;
+
+    /* Enable clock on GPIO pins */
+    RCC_AHBPeriphClockCmd( RCC_AHBPeriph_GPIOB, ENABLE );
+    RCC_AHBPeriphClockCmd( RCC_AHBPeriph_GPIOC, ENABLE );
+
+    /* Configure pins with given properties */
+    port_init.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_2 | GPIO_Pin_3 | 
+                         GPIO_Pin_4 | GPIO_Pin_5 | GPIO_Pin_6 | GPIO_Pin_15;
+    port_init.GPIO_Mode = GPIO_Mode_OUT; /* Output Mode */
+    port_init.GPIO_Speed = GPIO_Speed_50MHz; /* Highest speed pins */
+    port_init.GPIO_OType = GPIO_OType_PP;   /* Output type push pull */
+    port_init.GPIO_PuPd = GPIO_PuPd_UP;     /* Pull up */
+    GPIO_Init( GPIOB, &port_init );
+
+    /* Set up B7 as an input */
+    port_init.GPIO_Pin = GPIO_Pin_7  | GPIO_Pin_8  | GPIO_Pin_9  | GPIO_Pin_10 |
+                         GPIO_Pin_11 | GPIO_Pin_12 | GPIO_Pin_13 | GPIO_Pin_14;
+    port_init.GPIO_Mode = GPIO_Mode_IN; /* Input mode */
+    port_init.GPIO_Speed = GPIO_Speed_50MHz; /* Highest speed */
+    /* Other parameters remain the same */
+    GPIO_Init(GPIOB, &port_init);
+
+    /* Set up PF0 and PF1 as outputs, already enabled, enable level shifters */
+    port_init.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1;
+    port_init.GPIO_Mode = GPIO_Mode_OUT;
+    port_init.GPIO_Speed = GPIO_Speed_2MHz;
+    port_init.GPIO_OType = GPIO_OType_PP;
+    port_init.GPIO_PuPd = GPIO_PuPd_UP;
+    GPIO_Init( GPIOC, &port_init );
+
+    /* Ensure link outputs are all reset */
+    GPIOB->BRR = TX_PIN_MASK | GPIO_Pin_15;
+
+    /* Ensure level shifters are enabled */
+    GPIO_WriteBit(GPIOC, GPIO_Pin_0, Bit_SET);
+    GPIO_WriteBit(GPIOC, GPIO_Pin_1, Bit_SET);
+
+}
+
+/**
+ * DESCRIPTION
+ * Configure ISRs for SpiNNaker connection
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void irq_init(void)
+{
+
+    EXTI_InitTypeDef exti;
+    NVIC_InitTypeDef nvic;
+
+    /* Configure external interrupt */
+
+    /* Ensure peripheral clock is configured */
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE); 
+
+    /* Map all pins into interrupt */
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource7);
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource8);
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource9);
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource10);
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource11);
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource12);
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource13);
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource14);
+
+    exti.EXTI_Line = EXTI_Line7  | EXTI_Line8  | EXTI_Line9  | EXTI_Line10 | 
+                     EXTI_Line11 | EXTI_Line12 | EXTI_Line13 | EXTI_Line14;
+    exti.EXTI_Mode = EXTI_Mode_Interrupt;
+    /* Signals are transitions, so rising or falling edge */
+    exti.EXTI_Trigger = EXTI_Trigger_Rising_Falling;
+    exti.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&exti);
+
+    /* Configure interrupt register */
+    nvic.NVIC_IRQChannel = EXTI4_15_IRQn;
+    /* The M0 has two priority bits; this was set to 5, which NVIC_Init
+       truncated to 1, so keep the priority it has always run at */
+    nvic.NVIC_IRQChannelPriority = 1;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+
+}
+
+/**
+ * DESCRIPTION
+ * Counts a latency into its log2 bucket
+ * 
+ * INPUTS
+ * hist (spinn_hist_t) : Histogram to add to
+ * cycles (uint32_t) : Latency in core cycles
+ *
+ * RETURNS
+ * Nothing
+ */
+RAM_CODE
+static void hist_add(spinn_hist_t hist, uint32_t cycles)
+{
+    uint8_t bucket = cycle_log2(cycles);
+
+    if (bucket >= SPINN_HIST_BUCKETS)
+    {
+        bucket = SPINN_HIST_BUCKETS - 1;
+    }
+    link_hist[hist][bucket]++;
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "spinn_ring.h"
+#include "ram_code.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+void spinn_ring_init(spinn_ring_t* p_ring, spinn_drop_t policy)
+{
+    p_ring->head = 0;
+    p_ring->tail = 0;
+    p_ring->high_water = 0;
+    p_ring->overwritten = 0;
+    p_ring->dropped = 0;
+    p_ring->rejected = 0;
+    p_ring->policy = policy;
+}
+
+void spinn_ring_set_policy(spinn_ring_t* p_ring, spinn_drop_t policy)
+{
+    p_ring->policy = policy;
+}
+
+spinn_push_t spinn_ring_push(spinn_ring_t* p_ring, uint16_t event)
+{
+    uint32_t head = p_ring->head;
+    /* Tail may be stale, which can only overestimate the depth */
+    uint32_t depth = head - p_ring->tail;
+
+    if (depth >= SPINN_RING_CAPACITY)
+    {
+        if (p_ring->policy == SPINN_DROP_NEWEST)
+        {
+            p_ring->dropped++;
+            return SPINN_PUSH_DROPPED;
+        }
+        else if (p_ring->policy == SPINN_DROP_REJECT)
+        {
+            p_ring->rejected++;
+            return SPINN_PUSH_REJECTED;
+        }
+
+        /* Dropping oldest: write regardless, the consumer skips and counts
+           any events which have been lapped */
+        depth = SPINN_RING_CAPACITY - 1;
+    }
+
+    /* Volatile accesses keep the data store ahead of publishing the index */
+    p_ring->buf[head & SPINN_RING_MASK] = event;
+    p_ring->head = head + 1;
+
+    if (depth + 1 > p_ring->high_water)
+    {
+        p_ring->high_water = depth + 1;
+    }
+
+    return SPINN_PUSH_OK;
+}
+
+RAM_CODE
+uint8_t spinn_ring_pop(spinn_ring_t* p_ring, uint16_t* p_event)
+{
+    uint32_t tail = p_ring->tail;
+    uint32_t head;
+
+    for (;;)
+    {
+        head = p_ring->head;
+        if (head == tail)
+        {
+            return 0;
+        }
+
+        /* Skip anything the producer has lapped; only the last
+           SPINN_RING_CAPACITY events written are intact */
+        if (head - tail > SPINN_RING_CAPACITY)
+        {
+            p_ring->overwritten += head - tail - SPINN_RING_CAPACITY;
+            tail = head - SPINN_RING_CAPACITY;
+            p_ring->tail = tail;
+        }
+
+        *p_event = p_ring->buf[tail & SPINN_RING_MASK];
+
+        /* The producer only writes this slot once head has moved more than
+           SPINN_RING_CAPACITY past it, so if that has not happened the copy
+           is intact; otherwise go round again to skip it */
+        if (p_ring->head - tail <= SPINN_RING_CAPACITY)
+        {
+            p_ring->tail = tail + 1;
+            return 1;
+        }
+    }
+}
+
+uint8_t spinn_ring_empty(spinn_ring_t* p_ring)
+{
+    return p_ring->head == p_ring->tail;
+}
+
+void spinn_ring_get_stats(spinn_ring_t* p_ring, spinn_ring_stats_t* p_stats)
+{
+    uint32_t depth = p_ring->head - p_ring->tail;
+
+    /* Depth may include lapped events the consumer has not yet skipped */
+    if (depth > SPINN_RING_CAPACITY)
+    {
+        depth = SPINN_RING_CAPACITY;
+    }
+
+    p_stats->policy = p_ring->policy;
+    p_stats->depth = depth;
+    p_stats->high_water = p_ring->high_water;
+    p_stats->overwritten = p_ring->overwritten;
+    p_stats->dropped = p_ring->dropped;
+    p_stats->rejected = p_ring->rejected;
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
@@ -0,0 +1,290 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <string.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "spinn_route.h"
+#include "pwm.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+#define ROUTE_LUT_MASK  (SPINN_ROUTE_LUT_SIZE - 1)
+
+/* GPIOA pins which routes may drive; others are in use or reserved */
+#define ROUTE_GPIO_PINS (GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_4 | GPIO_Pin_5)
+#define ROUTE_GPIO_MAX  (15)
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* Set of routes which can match a value of the route bits, bit n for
+   routes[n] */
+typedef uint8_t route_set_t;
+
+/* Fail to compile if the table outgrows a route set */
+typedef char route_set_check[(SPINN_ROUTE_ENTRIES <= 
+                              sizeof(route_set_t) * 8) ? 1 : -1];
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Routes in priority order. Written by the PC task and read by the tasks
+   routing packets, each with the scheduler suspended, so that a lookup
+   never sees a table part way through being changed; interrupts never
+   touch routes, so are left enabled */
+static spinn_route_t routes[SPINN_ROUTE_ENTRIES];
+static uint8_t route_count = 0;
+
+/* Routes which can match each value of the route bits */
+static route_set_t route_lut[SPINN_ROUTE_LUT_SIZE];
+
+/* Packets matching no route */
+static uint32_t route_misses = 0;
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+static void hal_init(void);
+static spinn_route_t* route_lookup(uint32_t key);
+static void route_apply(spinn_route_t* p_route, uint16_t value);
+
+/*******************************************************************************
+ * Public Function Definitions 
+ ******************************************************************************/
+void spinn_route_config(void)
+{
+    hal_init();
+
+    /* By default everything goes to the PC, as before routing existed */
+    spinn_route_clear();
+    spinn_route_add(0, 0, SPINN_HANDLER_PC, 0);
+}
+
+uint8_t spinn_route_add(uint32_t key, uint32_t mask, spinn_handler_t handler,
+                        uint8_t arg)
+{
+    spinn_route_t *p_route;
+    uint8_t lut_key = (key >> SPINN_ROUTE_SHIFT) & ROUTE_LUT_MASK;
+    uint8_t lut_mask = (mask >> SPINN_ROUTE_SHIFT) & ROUTE_LUT_MASK;
+    route_set_t above;
+    uint8_t pos;
+    uint16_t idx;
+
+    if (route_count >= SPINN_ROUTE_ENTRIES || handler >= SPINN_HANDLER_NUM)
+    {
+        return 0;
+    }
+    if (handler == SPINN_HANDLER_PWM && arg >= PWM_CHANNELS)
+    {
+        return 0;
+    }
+    if (handler == SPINN_HANDLER_GPIO && 
+        (arg > ROUTE_GPIO_MAX || ((1 << arg) & ROUTE_GPIO_PINS) == 0))
+    {
+        return 0;
+    }
+
+    /* Catch-all routes stay below every other route, so that a route added
+       on top of the default one is still reached */
+    pos = route_count;
+    while (mask != 0 && pos > 0 && routes[pos - 1].mask == 0)
+    {
+        pos--;
+    }
+
+    /* Refuse a route which a route above matches every key of, as it could
+       never be reached */
+    for (idx = 0; idx < pos; idx++)
+    {
+        if ((routes[idx].mask & ~mask) == 0 &&
+            (key & routes[idx].mask) == routes[idx].key)
+        {
+            return 0;
+        }
+    }
+
+    vTaskSuspendAll();
+
+    /* Make room, moving the routes below down one place in every set */
+    memmove(&routes[pos + 1], &routes[pos], 
+            (route_count - pos) * sizeof(routes[0]));
+    above = (1 << pos) - 1;
+    for (idx = 0; idx < SPINN_ROUTE_LUT_SIZE; idx++)
+    {
+        route_lut[idx] = (route_lut[idx] & above) | 
+                         ((route_lut[idx] & ~above) << 1);
+        if ((idx & lut_mask) == (lut_key & lut_mask))
+        {
+            route_lut[idx] |= 1 << pos;
+        }
+    }
+
+    p_route = &routes[pos];
+    p_route->key = key & mask;
+    p_route->mask = mask;
+    p_route->handler = handler;
+    p_route->arg = arg;
+    p_route->last_value = 0;
+    p_route->hits = 0;
+    route_count++;
+
+    xTaskResumeAll();
+
+    return 1;
+}
+
+void spinn_route_clear(void)
+{
+    vTaskSuspendAll();
+    memset(route_lut, 0, sizeof(route_lut));
+    route_count = 0;
+    xTaskResumeAll();
+}
+
+uint8_t spinn_route_dispatch(uint32_t key, spinn_handler_t* p_handler)
+{
+    spinn_route_t *p_route;
+
+    /* Held until the packet is applied, so its route cannot be rewritten
+       meanwhile */
+    vTaskSuspendAll();
+    p_route = route_lookup(key);
+    if (p_route != NULL)
+    {
+        route_apply(p_route, key & 0xFFFF);
+        *p_handler = p_route->handler;
+    }
+    xTaskResumeAll();
+
+    return p_route != NULL;
+}
+
+uint8_t spinn_route_get(uint8_t idx, spinn_route_t* p_route)
+{
+    if (idx >= route_count)
+    {
+        return 0;
+    }
+
+    vTaskSuspendAll();
+    *p_route = routes[idx];
+    xTaskResumeAll();
+    return 1;
+}
+
+uint32_t spinn_route_misses(void)
+{
+    return route_misses;
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+
+/**
+ * DESCRIPTION
+ * Configure GPIOA pins which routes may drive as outputs, initially low
+ * 
+ * INPUTS
+ * None
+ *
+ * RETURNS
+ * Nothing
+ */
+static void hal_init(void)
+{
+    GPIO_InitTypeDef port_init;
+
+    RCC_AHBPeriphClockCmd( RCC_AHBPeriph_GPIOA, ENABLE );
+
+    port_init.GPIO_Pin = ROUTE_GPIO_PINS;
+    port_init.GPIO_Mode = GPIO_Mode_OUT;
+    port_init.GPIO_Speed = GPIO_Speed_2MHz;
+    port_init.GPIO_OType = GPIO_OType_PP;
+    port_init.GPIO_PuPd = GPIO_PuPd_NOPULL;
+    GPIO_Init( GPIOA, &port_init );
+
+    GPIOA->BRR = ROUTE_GPIO_PINS;
+}
+
+/**
+ * DESCRIPTION
+ * Finds the first route matching a key. The route bits select the routes
+ * which can match, which are then checked in priority order. Scheduler
+ * must be suspended
+ * 
+ * INPUTS
+ * key (uint32_t) : Key of received packet
+ *
+ * RETURNS
+ * Matching route, or NULL if none matches (spinn_route_t*)
+ */
+static spinn_route_t* route_lookup(uint32_t key)
+{
+    route_set_t set = route_lut[(key >> SPINN_ROUTE_SHIFT) & ROUTE_LUT_MASK];
+    uint8_t idx;
+
+    for (idx = 0; set != 0; idx++, set >>= 1)
+    {
+        if ((set & 1) && (key & routes[idx].mask) == routes[idx].key)
+        {
+            return &routes[idx];
+        }
+    }
+
+    route_misses++;
+    return NULL;
+}
+
+/**
+ * DESCRIPTION
+ * Records a packet against its route and applies its value for PWM, GPIO
+ * and counter routes. Scheduler must be suspended
+ * 
+ * INPUTS
+ * p_route (spinn_route_t*) : Route from route_lookup
+ * value (uint16_t) : Value carried by packet
+ *
+ * RETURNS
+ * Nothing
+ */
+static void route_apply(spinn_route_t* p_route, uint16_t value)
+{
+    p_route->hits++;
+    p_route->last_value = value;
+
+    switch (p_route->handler)
+    {
+        case SPINN_HANDLER_GPIO:
+            if (value)
+            {
+                GPIOA->BSRR = 1 << p_route->arg;
+            }
+            else
+            {
+                GPIOA->BRR = 1 << p_route->arg;
+            }
+            break;
+        case SPINN_HANDLER_PWM:
+            pwm_set(p_route->arg, value);
+            break;
+        case SPINN_HANDLER_PC:
+        case SPINN_HANDLER_COUNTER:
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
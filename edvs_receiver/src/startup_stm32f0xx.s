@@ -111,12 +111,20 @@ __vector_table
 
         EXTERN  __ICFEDIT_region_RAM_start__
         EXTERN  __ICFEDIT_region_RAM_end__
+        SECTION RAMCODE:CODE:NOROOT(2)
+        SECTION RAMCODE_INIT:CONST:NOROOT(2)
         SECTION `.text`:CODE:NOROOT(2)
         DATA
 ??DataTable22:
         DC32     __ICFEDIT_region_RAM_start__
 ??DataTable22_1:
         DC32     __ICFEDIT_region_RAM_end__
+??DataTable22_2:
+        DC32     SFB(RAMCODE_INIT)
+??DataTable22_3:
+        DC32     SFB(RAMCODE)
+??DataTable22_4:
+        DC32     SFE(RAMCODE)
 
         THUMB
 
@@ -135,6 +143,23 @@ Reset_Handler
         CMP      R2,R0
         BCS.N    ??x_0
 
+        ;; Copy RAM_CODE functions from flash into the RAM just cleared
+        LDR   R0,=??DataTable22_2
+        LDR    R0,[R0, #+0]
+        LDR   R1,=??DataTable22_3
+        LDR    R1,[R1, #+0]
+        LDR   R2,=??DataTable22_4
+        LDR    R2,[R2, #+0]
+        B.N      ??x_2
+??x_1:
+        LDRB     R3,[R0]
+        STRB     R3,[R1]
+        ADDS      R0,R0,#0x1
+        ADDS      R1,R1,#0x1
+??x_2:
+        CMP      R1,R2
+        BCC.N    ??x_1
+
         LDR     R0, =SystemInit
         BLX     R0
         LDR     R0, =__iar_program_start
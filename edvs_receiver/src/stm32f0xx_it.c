@@ -8,6 +8,9 @@
  ******************************************************************************/
 #include "stm32f0xx_it.h"
 #include "spinn_channel.h"
+#include "spinn_link.h"
+#include "trace.h"
+#include "ram_code.h"
 
 /*******************************************************************************
  * Local Definitions
@@ -39,58 +42,70 @@ void HardFault_Handler(void)
     while(1);
 }
 
+RAM_CODE
 void EXTI4_15_IRQHandler(void)
 {
-    long lHigherPriorityTaskWoken = pdFALSE;
+    os_base_t lHigherPriorityTaskWoken = OS_FALSE;
+
+    trace_rec(TRACE_ISR_ENTER, EXTI4_15_IRQn, 0);
     if (EXTI_GetITStatus(EXTI_Line7) != RESET)
     {
-        xSemaphoreGiveFromISR( xSpinnTxSemaphore, &lHigherPriorityTaskWoken );
+        spinn_link_tx_ack_isr();
+        spinn_tx_ack_from_isr(&lHigherPriorityTaskWoken);
         EXTI_ClearITPendingBit(EXTI_Line7);
     }
 
     if (EXTI_GetITStatus(EXTI_Line8) != RESET)
     {
-        xSemaphoreGiveFromISR( xSpinnRxSemaphore, &lHigherPriorityTaskWoken );
+        spinn_link_rx_edge_isr();
+        spinn_rx_edge_from_isr(&lHigherPriorityTaskWoken);
         EXTI_ClearITPendingBit(EXTI_Line8);
     }
 
     if (EXTI_GetITStatus(EXTI_Line9) != RESET)
     {
-        xSemaphoreGiveFromISR( xSpinnRxSemaphore, &lHigherPriorityTaskWoken );
+        spinn_link_rx_edge_isr();
+        spinn_rx_edge_from_isr(&lHigherPriorityTaskWoken);
         EXTI_ClearITPendingBit(EXTI_Line9);
     }
 
     if (EXTI_GetITStatus(EXTI_Line10) != RESET)
     {
-        xSemaphoreGiveFromISR( xSpinnRxSemaphore, &lHigherPriorityTaskWoken );
+        spinn_link_rx_edge_isr();
+        spinn_rx_edge_from_isr(&lHigherPriorityTaskWoken);
         EXTI_ClearITPendingBit(EXTI_Line10);
     }
 
     if (EXTI_GetITStatus(EXTI_Line11) != RESET)
     {
-        xSemaphoreGiveFromISR( xSpinnRxSemaphore, &lHigherPriorityTaskWoken );
+        spinn_link_rx_edge_isr();
+        spinn_rx_edge_from_isr(&lHigherPriorityTaskWoken);
         EXTI_ClearITPendingBit(EXTI_Line11);
     }
 
     if (EXTI_GetITStatus(EXTI_Line12) != RESET)
     {
-        xSemaphoreGiveFromISR( xSpinnRxSemaphore, &lHigherPriorityTaskWoken );
+        spinn_link_rx_edge_isr();
+        spinn_rx_edge_from_isr(&lHigherPriorityTaskWoken);
         EXTI_ClearITPendingBit(EXTI_Line12);
     }
 
     if (EXTI_GetITStatus(EXTI_Line13) != RESET)
     {
-        xSemaphoreGiveFromISR( xSpinnRxSemaphore, &lHigherPriorityTaskWoken );
+        spinn_link_rx_edge_isr();
+        spinn_rx_edge_from_isr(&lHigherPriorityTaskWoken);
         EXTI_ClearITPendingBit(EXTI_Line13);
     }
 
     if (EXTI_GetITStatus(EXTI_Line14) != RESET)
     {
-        xSemaphoreGiveFromISR( xSpinnRxSemaphore, &lHigherPriorityTaskWoken );
+        spinn_link_rx_edge_isr();
+        spinn_rx_edge_from_isr(&lHigherPriorityTaskWoken);
         EXTI_ClearITPendingBit(EXTI_Line14);
     }
 
-    portEND_SWITCHING_ISR( lHigherPriorityTaskWoken );
+    trace_rec(TRACE_ISR_EXIT, EXTI4_15_IRQn, 0);
+    os_yield_from_isr(lHigherPriorityTaskWoken);
 }
 
 /*******************************************************************************
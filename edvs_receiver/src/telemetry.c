@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "telemetry.h"
+#include "pc_usart.h"
+#include "dvs_usart.h"
+#include "spinn_channel.h"
+#include "spinn_route.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+void telemetry_get(telemetry_t* p_telem)
+{
+    pc_stats_t pc;
+    dvs_stats_t dvs;
+    spinn_ring_stats_t ring;
+    spinn_link_stats_t link;
+    spinn_rx_stats_t rx;
+
+    pc_get_stats(&pc);
+    dvs_get_stats(&dvs);
+    spinn_get_ring_stats(&ring);
+    spinn_get_link_stats(&link);
+    spinn_get_rx_stats(&rx, false);
+
+    p_telem->uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    p_telem->pc_rx_bytes = pc.rx_bytes;
+    p_telem->pc_rx_dropped = pc.rx_dropped;
+    p_telem->dvs_rx_bytes = dvs.rx_bytes;
+    p_telem->dvs_rx_dropped = dvs.rx_dropped;
+    p_telem->decoded = dvs.decoded;
+    p_telem->filtered = dvs.filtered;
+    p_telem->queued = dvs.sent;
+    p_telem->retry_dropped = dvs.retry_dropped;
+    p_telem->tx_overwritten = ring.overwritten;
+    p_telem->tx_dropped = ring.dropped;
+    p_telem->tx_rejected = ring.rejected;
+    p_telem->tx_packets = link.packets;
+    p_telem->tx_abandoned = link.abandoned;
+    p_telem->link_timeouts = link.timeouts;
+    p_telem->link_stalls = link.stalls;
+    p_telem->rx_packets = rx.packets;
+    p_telem->rx_errors = rx.bad_length + rx.bad_eop + rx.bad_symbol + 
+                         rx.bad_parity + rx.overruns;
+    p_telem->route_misses = spinn_route_misses();
+    p_telem->dvs_rx_high_water = dvs.rx_high_water;
+    p_telem->tx_high_water = ring.high_water;
+    p_telem->link_up = link.up;
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
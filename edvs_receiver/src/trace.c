@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "trace.h"
+#include "cycle_count.h"
+#include "ram_code.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Ring of records, and count of records ever written since the start, which
+   only runs forward and is masked on access */
+static trace_rec_t trace_ring[TRACE_RECORDS];
+static volatile uint32_t trace_head = 0;
+
+/* Types of record being kept; 0 when stopped, so that a record not wanted
+   costs only the test of this mask */
+static volatile uint16_t trace_mask = 0;
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+void trace_start(uint16_t mask)
+{
+    trace_mask = 0;
+    trace_head = 0;
+    trace_mask = mask;
+}
+
+uint16_t trace_stop(uint32_t* p_lost)
+{
+    uint32_t head;
+
+    trace_mask = 0;
+    head = trace_head;
+
+    *p_lost = head > TRACE_RECORDS ? head - TRACE_RECORDS : 0;
+    return head > TRACE_RECORDS ? TRACE_RECORDS : head;
+}
+
+RAM_CODE
+void trace_rec(trace_id_t id, uint8_t tag, uint16_t value)
+{
+    uint32_t primask;
+    trace_rec_t* p_rec;
+
+    if (!(trace_mask & (1u << id)))
+    {
+        return;
+    }
+
+    /* Claim the slot and fill it with interrupts held off, so that a record
+       from an interrupt cannot land in the middle of this one. May be called
+       with them already masked, so only unmask if they were not */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    p_rec = &trace_ring[trace_head & TRACE_MASK];
+    p_rec->cycles = cycle_get();
+    p_rec->id = id;
+    p_rec->tag = tag;
+    p_rec->value = value;
+    trace_head++;
+    if (!primask)
+    {
+        __enable_irq();
+    }
+}
+
+void trace_get(uint16_t idx, trace_rec_t* p_rec)
+{
+    uint32_t head = trace_head;
+    uint32_t first = head > TRACE_RECORDS ? head - TRACE_RECORDS : 0;
+
+    *p_rec = trace_ring[(first + idx) & TRACE_MASK];
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/
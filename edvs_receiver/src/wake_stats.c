@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * Global Includes
+ ******************************************************************************/
+#include "stm32f0xx.h"
+
+/*******************************************************************************
+ * Local Includes
+ ******************************************************************************/
+#include "wake_stats.h"
+#include "cycle_count.h"
+
+/*******************************************************************************
+ * Local Definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Type and Enum definitions
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Local Variable Declarations
+ ******************************************************************************/
+/* Cycle count at the last interrupt to wake each task, and whether the task
+   has yet to be timed */
+static volatile uint32_t wake_stamp[WAKE_NUM];
+static volatile uint8_t wake_armed[WAKE_NUM];
+
+/* Latency histograms, each only written by the task it times */
+static volatile uint32_t wake_hist[WAKE_NUM][WAKE_HIST_BUCKETS];
+
+/*******************************************************************************
+ * Private Function Declarations (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * Public Function Definitions
+ ******************************************************************************/
+void wake_isr_stamp(wake_src_t src, os_base_t woken)
+{
+    if (woken != OS_FALSE)
+    {
+        wake_stamp[src] = cycle_get();
+        wake_armed[src] = 1;
+    }
+}
+
+void wake_task_record(wake_src_t src)
+{
+    uint8_t bucket;
+
+    if (!wake_armed[src])
+    {
+        return;
+    }
+
+    wake_armed[src] = 0;
+    bucket = cycle_log2(cycle_get() - wake_stamp[src]);
+    if (bucket >= WAKE_HIST_BUCKETS)
+    {
+        bucket = WAKE_HIST_BUCKETS - 1;
+    }
+
+    /* Read-modify-write must not interleave with a reset from the PC task */
+    __disable_irq();
+    wake_hist[src][bucket]++;
+    __enable_irq();
+}
+
+void wake_get_hist(wake_src_t src, uint32_t* p_counts, uint8_t reset)
+{
+    uint8_t i;
+
+    __disable_irq();
+    for (i = 0; i < WAKE_HIST_BUCKETS; i++)
+    {
+        p_counts[i] = wake_hist[src][i];
+        if (reset)
+        {
+            wake_hist[src][i] = 0;
+        }
+    }
+    __enable_irq();
+}
+
+/*******************************************************************************
+ * Private Function Definitions (static)
+ ******************************************************************************/
+/* None */
+
+/*******************************************************************************
+ * End of file
+ ******************************************************************************/